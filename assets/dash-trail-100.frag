@@ -3,8 +3,7 @@
 precision mediump float;
 
 varying vec2 fragTexCoord;
-
-uniform float alpha;
+varying vec4 fragColor;
 
 uniform sampler2D texture0;
 uniform vec4 colDiffuse;
@@ -15,6 +14,6 @@ void main() {
   vec4 origColor = texture2D(texture0, fragTexCoord) * colDiffuse;
 
   gl_FragColor =
-    vec4(trailColor.rgb, alpha) *
+    vec4(trailColor.rgb, fragColor.a) *
     float(origColor.a != 0.);
 }
@@ -1,11 +1,10 @@
 #version 330
 
 in vec2 fragTexCoord;
+in vec4 fragColor;
 
 out vec4 finalColor;
 
-uniform float alpha;
-
 uniform sampler2D texture0;
 uniform vec4 colDiffuse;
 
@@ -15,6 +14,6 @@ void main() {
   vec4 origColor = texture(texture0, fragTexCoord) * colDiffuse;
 
   finalColor =
-    vec4(trailColor.rgb, alpha) *
+    vec4(trailColor.rgb, fragColor.a) *
     float(origColor.a != 0.);
 }
@@ -27,7 +27,8 @@ vec2 transformUv(vec2 muv) {
 }
 
 void main() {
-  vec2 uv = fragTexCoord;
+  // the quad's texture coordinates run from 0 to how far the beam reaches, over `resolution.x`
+  vec2 uv = vec2(fragTexCoord.x, 1. - fragTexCoord.y);
 
   vec2 muv = transformUv(uv);
   vec2 fuv = transformUv(vec2(uv.x, 1.-uv.y));
@@ -66,8 +67,12 @@ void main() {
 
   a /= it;
 
-  finalColor =
-    vec4((c * a * 2) +
-         (c0 * float(f2.y >= 0.) * smoothstep(2.5, 0., f2.y) * 6) +
-         (c0 * float(m2.y >= 0.) * smoothstep(2.5, 0., m2.y) * 6), a);
+  vec3 color =
+    clamp((c * a * 2) +
+          (c0 * float(f2.y >= 0.) * smoothstep(2.5, 0., f2.y) * 6) +
+          (c0 * float(m2.y >= 0.) * smoothstep(2.5, 0., m2.y) * 6), 0, 1);
+
+  // squared alpha, the beam looks as if it was blended into a cleared render texture first
+  a = clamp(a, 0, 1);
+  finalColor = vec4(color * a, a * a);
 }
@@ -5,7 +5,6 @@ precision mediump float;
 varying vec2 fragTexCoord;
 
 uniform float time;
-uniform float dom;
 uniform vec2 resolution;
 
 uniform sampler2D texture0;
@@ -28,33 +27,7 @@ float star(vec2 uv, float flare) {
   return m;
 }
 
-vec2 rotateUV(vec2 uv, float rotation)
-{
-    float mid = 0.5;
-    return vec2(
-        cos(rotation) * (uv.x - mid) + sin(rotation) * (uv.y - mid) + mid,
-        cos(rotation) * (uv.y - mid) - sin(rotation) * (uv.x - mid) + mid
-    );
-}
-
 void main() {
-  vec4 noiseColor1 = texture2D(texture0, fragTexCoord) * colDiffuse;
-  vec4 noiseColor2 = texture2D(texture0, rotateUV(fragTexCoord, 1.570796)) * colDiffuse;
-
-  vec3 nebulaBlue = vec3(84. / 255., 104. / 255., 255. / 255.);
-  vec3 nebulaRed = vec3(147. / 255., 38. / 255., 69. / 255.);
-
-  float c = noiseColor1.r;
-  float c2 = noiseColor2.r;
-
-  vec4 nebulaColor =
-    vec4((nebulaBlue * c) +
-         (nebulaRed * c2),
-         .9) *
-    smoothstep(.1, 1.,
-               (c2 * float(dom == 1.)) +
-               (c  * float(dom != 1.)));
-
   vec2 uv = vec2(fragTexCoord.x, 1.-fragTexCoord.y) - .5;
 
   // make uv follow aspect ratio
@@ -86,7 +59,7 @@ void main() {
   // vec4 starColor = vec4(0., .31, .596, .1);
   vec4 starColor = vec4(.235, .314, .569, .1);
 
-  gl_FragColor =
-    nebulaColor +
-    starColor * vec4(clamp(starBrigtness, 0., 10.));
+  // premultiplied, the stars are blended over the nebula in a single pass
+  float b = clamp(starBrigtness, 0., 10.);
+  gl_FragColor = vec4(starColor.rgb * starColor.a * b, starColor.a * b);
 }
@@ -39,6 +39,31 @@
 #include <math.h>
 #include <string.h>
 #include <assert.h>
+#include <time.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stdarg.h>
+
+#if defined(PLATFORM_WEB)
+#define JOBS_SINGLE_THREADED
+#endif
+
+#if !defined(JOBS_SINGLE_THREADED)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+/* NOTE: netplay can talk UDP where there are BSD sockets, the loopback transport works everywhere */
+#if !defined(PLATFORM_WEB) && !defined(_WIN32)
+#define NETPLAY_UDP
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <fcntl.h>
+#endif
 
 #define SUPPORT_LOG_INFO
 #if defined(SUPPORT_LOG_INFO)
@@ -79,7 +104,6 @@ static Vector2 cameraIntroductionTarget = {0};
 static Music mainMenuMusic = {0};
 static Music bossMarineMusic = {0};
 
-static GameState gameState = GAME_MAIN_MENU;
 
 #define SPRITES_SCALE 3.5
 static Texture2D sprites = {0};
@@ -141,7 +165,6 @@ typedef struct {
   float healTimer;
 } Player;
 
-static Perk playerPerks = 0;
 
 typedef struct {
   float time;
@@ -149,7 +172,6 @@ typedef struct {
   int kills;
 } PlayerStats;
 
-static PlayerStats playerStats = {0};
 
 #define MAX_BOUNDING_CIRCLES 3
 
@@ -158,6 +180,28 @@ typedef struct {
   float radius;
 } Circle;
 
+#define COMPOUND_SHAPE_MAX_CIRCLES 16
+
+/* two-level bounding volume: one enclosing circle/AABB and then the actual hit circles */
+typedef struct {
+  /* NOTE: positions are relative to the body origin */
+  Circle circles[COMPOUND_SHAPE_MAX_CIRCLES];
+  int len;
+
+  Circle bounds;
+  Rectangle aabb;
+} CompoundShape;
+
+typedef struct {
+  /* NOTE: world-space versions of the shape's bounds, used for early rejects */
+  Circle bounds;
+  Rectangle aabb;
+
+  /* span of the body's world-space circles inside of `worldCircles` */
+  int first;
+  int len;
+} CompoundCollider;
+
 static Rectangle bossMarineRect = {
   .x = 0,
   .y = 35,
@@ -194,12 +238,16 @@ typedef enum {
 typedef struct {
   Vector2 position;
   int health;
+  /* NOTE: the ominous aura's damage builds up here until it makes a whole point of health */
+  float auraDamage;
 
   /* positions are relative */
   Circle boundingCircles[BOSS_MARINE_BOUNDING_CIRCLES];
 
   float horizontalFlip;
-  Circle processedBoundingCircles[BOSS_MARINE_BOUNDING_CIRCLES];
+  /* NOTE: one shape per facing direction, see `BOSS_MARINE_SHAPE` */
+  CompoundShape shapes[2];
+  CompoundCollider collider;
   Vector2 bulletOrigin;
   float weaponAngle;
   Vector2 weaponOffset;
@@ -212,7 +260,6 @@ typedef struct {
   float fireCooldown;
 } BossMarine;
 
-BossMarine bossMarine = {0};
 
 #define BOSS_BALL_NAME "Rigor Mortis"
 #define BOSS_BALL_MAX_HEALTH (1024 + 512)
@@ -229,7 +276,29 @@ static Sound bossBallLaserChargingSound = {0};
 static Sound bossBallRocketSound = {0};
 static Sound bossBallDeath = {0};
 
+/* NOTE: the ball is drawn at a quarter of the level resolution and upscaled with nearest filtering,
+         so the target only covers the rectangle around it */
+#define BOSS_BALL_PIXEL_SIZE 4
+
 static RenderTexture2D bossBallTarget = {0};
+static Rectangle bossBallTargetRect = {0};
+static float bossBallRadius = 0.0f;
+
+/* NOTE: the ball only rolls around horizontal axes pointing one of eight ways, and rolling the opposite way
+         is the same frames played backwards, so four rows of frames cover every roll */
+#define BOSS_BALL_IMPOSTOR_AXES 4
+#define BOSS_BALL_IMPOSTOR_FRAMES 32
+#define BOSS_BALL_IMPOSTOR_COLUMNS 16
+
+static const int bossBallImpostorAxes[BOSS_BALL_IMPOSTOR_AXES][2] = {
+  {1, 0},
+  {0, 1},
+  {1, 1},
+  {1, -1},
+};
+
+static bool bossBallImpostor = false;
+static RenderTexture2D bossBallImpostorAtlas = {0};
 static RenderTexture2D bossBallTargetScreen = {0};
 
 #define BOSS_BALL_HITBOX_RADIUS 180
@@ -265,8 +334,6 @@ float bossBallWeaponHitboxRadiuses[BOSS_BALL_WEAPON_COUNT] = {
 static Shader laserShader = {0};
 static int laserShaderTime = {0};
 
-static RenderTexture2D laserTexture = {0};
-
 typedef struct {
   BossBallWeaponType type;
 
@@ -292,7 +359,6 @@ typedef struct {
   Vector2 bulletOrigin2;
 
   float laserLength;
-  Music soundEffect;
 
   float attackCooldown;
 
@@ -319,14 +385,14 @@ typedef struct {
   BossBallWeapon weapons[BOSS_BALL_WEAPONS];
 } BossBall;
 
-static BossBall bossBall = {0};
+static Music bossBallLaserSounds[BOSS_BALL_WEAPONS] = {0};
+
 
 typedef enum {
   BOSS_MARINE,
   BOSS_BALL,
 } BossType;
 
-BossType currentBoss = BOSS_MARINE;
 
 #define BACKGROUND_PARALLAX_OFFSET 16
 
@@ -338,10 +404,11 @@ static int arenaBorderTime = 0;
 
 static Shader stars = {0};
 static int starsTime = 0;
-static int starsDom = 0;
+
+static Shader nebula = {0};
+static int nebulaDom = 0;
 
 static Shader dashTrailShader = {0};
-static int dashTrailShaderAlpha = {0};
 static int dashTrailShaderColor = {0};
 
 static Camera2D camera = {0};
@@ -361,8 +428,17 @@ static const Vector2 background = {
 
 static RenderTexture2D target = {0};
 
+/* NOTE: when set, the world is drawn straight into the backbuffer under the camera instead of into `target` */
+static bool directRendering = false;
+
+/* NOTE: the part of the level that ends up on screen, anything outside of it may be skipped */
+static Rectangle worldView = {0, 0, LEVEL_WIDTH, LEVEL_HEIGHT};
+
 static Texture2D nebulaNoise = {0};
-static RenderTexture2D backgroundTexture = {0};
+
+/* NOTE: the nebula never moves, it's drawn once per boss, only the stars on top of it twinkle */
+static RenderTexture2D nebulaTexture = {0};
+static RenderTexture2D starsTexture = {0};
 
 #define BIG_ASS_ASTEROID_SCALE 15
 
@@ -499,18 +575,21 @@ typedef struct {
   Vector2 position;
   Vector2 delta;
 
-  Circle processedBoundingCircles[MAX_BOUNDING_CIRCLES];
+  /* NOTE: rotated and scaled, but still relative to the asteroid position */
+  CompoundShape shape;
+  CompoundCollider collider;
   bool launchedByPlayer;
   bool isDestroyed;
 } Asteroid;
 
 #define MIN_ASTEROIDS 4
 #define MAX_ASTEROIDS 10
-static Asteroid asteroids[MAX_ASTEROIDS] = {0};
-static int asteroidsLen = 0;
 
-static Vector2 mouseCursor = {0};
-static Player player = {0};
+/* world-space circles of every compound collider, refreshed only when a body moves or turns */
+#define WORLD_CIRCLES_ASTEROIDS 0
+#define WORLD_CIRCLES_BOSS_MARINE (MAX_ASTEROIDS * MAX_BOUNDING_CIRCLES)
+#define WORLD_CIRCLES_MAX (WORLD_CIRCLES_BOSS_MARINE + BOSS_MARINE_BOUNDING_CIRCLES)
+
 
 static Sound playerDeathSound = {0};
 static Sound playerHealSound = {0};
@@ -526,7 +605,126 @@ static Sound bossMarineShotgunSound = {0};
 static Sound bossMarineGunshotSound = {0};
 
 typedef enum {
-  PROJECTILE_NONE,
+  COLLISION_LAYER_NONE        = 0,
+  COLLISION_LAYER_PLAYER      = 1 << 0,
+  COLLISION_LAYER_BOSS        = 1 << 1,
+  COLLISION_LAYER_BOSS_WEAPON = 1 << 2,
+  COLLISION_LAYER_ASTEROID    = 1 << 3,
+  COLLISION_LAYER_LASER       = 1 << 4,
+  COLLISION_LAYER_ROCKET      = 1 << 5,
+  COLLISION_LAYER_WINGMAN     = 1 << 6,
+} CollisionLayer;
+
+#define COLLISION_LAYER_SHIPS (COLLISION_LAYER_PLAYER | COLLISION_LAYER_WINGMAN)
+
+#define PLAYER_PROJECTILE_HURTS (COLLISION_LAYER_BOSS | COLLISION_LAYER_BOSS_WEAPON | COLLISION_LAYER_ROCKET)
+#define BOSS_PROJECTILE_HURTS COLLISION_LAYER_SHIPS
+
+/* NOTE: entities of one kind are packed at the front of their arrays, so systems only ever walk the alive ones */
+typedef struct {
+  uint16_t slot;
+  uint16_t generation;
+} EntityHandle;
+
+/* NOTE: a handle's slot points at wherever its entity was moved to, the generation tells a reused slot apart */
+typedef struct {
+  /* NOTE: the next free slot plus one while the slot is unused */
+  uint16_t dense;
+  uint16_t generation;
+} EntitySlot;
+
+/* NOTE: a zeroed pool is an empty one, so worlds are still reset with memset */
+typedef struct {
+  int len;
+  int slotsUsed;
+  /* plus one, 0 when no slot was given back yet */
+  int freeSlot;
+} EntityPool;
+
+/* NOTE: entities marked dead stay in place until the store is compacted, so that indexes hold for a whole tick */
+#define ENTITY_STORE(type, max) \
+  struct {                      \
+    EntityPool pool;            \
+    type items[max];            \
+    EntityHandle handles[max];  \
+    EntitySlot slots[max];      \
+    bool dead[max];             \
+  }
+
+#define ENTITY_STORE_MAX(store) ((int)(sizeof((store)->items) / sizeof((store)->items[0])))
+
+#define spawnEntity(store, capacity) \
+  entityPoolSpawn(&(store)->pool, (store)->handles, (store)->slots, (store)->dead, MIN((capacity), ENTITY_STORE_MAX(store)))
+#define killEntity(store, i) ((store)->dead[(i)] = true)
+#define compactEntities(store) \
+  entityPoolCompact(&(store)->pool, (store)->items, sizeof((store)->items[0]), (store)->handles, (store)->slots, (store)->dead)
+#define entityHandle(store, i) ((store)->handles[(i)])
+#define findEntity(store, handle) entityPoolFind(&(store)->pool, (store)->slots, (store)->dead, (handle))
+
+/* returns the index of the new entity, or -1 when `capacity` of them are alive already */
+int entityPoolSpawn(EntityPool *pool, EntityHandle *handles, EntitySlot *slots, bool *dead, int capacity) {
+  if (pool->len >= capacity) {
+    return -1;
+  }
+
+  int slot = pool->slotsUsed;
+
+  if (pool->freeSlot > 0) {
+    slot = pool->freeSlot - 1;
+    pool->freeSlot = slots[slot].dense;
+  } else {
+    pool->slotsUsed += 1;
+  }
+
+  int i = pool->len++;
+
+  slots[slot].dense = i;
+  handles[i] = (EntityHandle) {
+    .slot = slot,
+    .generation = slots[slot].generation,
+  };
+  dead[i] = false;
+
+  return i;
+}
+
+/* NOTE: the last entity moves into every hole, walking backwards means it was already looked at */
+void entityPoolCompact(EntityPool *pool, void *items, size_t size, EntityHandle *handles, EntitySlot *slots, bool *dead) {
+  uint8_t *bytes = items;
+
+  for (int i = pool->len - 1; i >= 0; i--) {
+    if (!dead[i]) {
+      continue;
+    }
+
+    EntityHandle gone = handles[i];
+    slots[gone.slot].generation += 1;
+    slots[gone.slot].dense = pool->freeSlot;
+    pool->freeSlot = gone.slot + 1;
+
+    int last = --pool->len;
+
+    if (i != last) {
+      memcpy(bytes + (i * size), bytes + (last * size), size);
+      handles[i] = handles[last];
+      dead[i] = false;
+      slots[handles[i].slot].dense = i;
+    }
+  }
+}
+
+/* returns the index of the entity, or -1 once it died */
+int entityPoolFind(const EntityPool *pool, const EntitySlot *slots, const bool *dead, EntityHandle handle) {
+  if (handle.slot >= pool->slotsUsed ||
+      slots[handle.slot].generation != handle.generation) {
+    return -1;
+  }
+
+  int i = slots[handle.slot].dense;
+  return dead[i] ? -1 : i;
+}
+
+typedef enum {
   PROJECTILE_REGULAR,
   PROJECTILE_SQUARED,
 } ProjectileType;
@@ -546,8 +744,8 @@ typedef struct {
   bool willBeDestroyed;
   float destructionTimer;
 
-  bool isHurtfulForPlayer;
-  bool isHurtfulForBoss;
+  /* NOTE: layers of the bodies that take damage from the projectile */
+  CollisionLayer hurts;
 
   int damage;
 
@@ -561,8 +759,9 @@ typedef struct {
 } Projectile;
 
 #define PROJECTILES_MAX 1024
+/* NOTE: how many can be alive at once, lowered from the command line, the arrays stay PROJECTILES_MAX long */
+static int projectilesCapacity = PROJECTILES_MAX;
 
-static Projectile projectiles[PROJECTILES_MAX] = {0};
 
 typedef struct {
   Color color;
@@ -573,4998 +772,8942 @@ typedef struct {
 } Particle;
 
 #define PARTICLES_MAX 2048
-static Particle particles[PARTICLES_MAX] = {0};
+static int particlesCapacity = PARTICLES_MAX;
 
-#define MAX_PLAYER_HEALTH maxPlayerHealth()
-int maxPlayerHealth(void) {
-  int base = 8;
+typedef struct {
+  float tick;
+  double time;
+  int scale;
+} SimulationClock;
 
-  if (playerPerks & PERK_GLASS_CANON) {
-    base /= 4;
+/* NOTE: scratch memory that lives until the end of the frame, every thread bumps its own */
+#define FRAME_ARENA_SIZE (256 * 1024)
+#define FRAME_ARENA_ALIGNMENT 16
+
+typedef struct {
+  uint8_t *memory;
+  size_t capacity;
+  size_t used;
+
+  /* allocations that didn't fit, they got NULL */
+  int overflows;
+} FrameArena;
+
+static _Thread_local FrameArena frameArena = {0};
+
+/* NOTE: the most any thread's arena held at once, so that FRAME_ARENA_SIZE can be picked from real runs */
+static atomic_size_t frameArenaHighWater = 0;
+
+void *frameAlloc(size_t size) {
+  if (frameArena.memory == NULL) {
+    frameArena.memory = malloc(FRAME_ARENA_SIZE);
+    frameArena.capacity = frameArena.memory != NULL ? FRAME_ARENA_SIZE : 0;
   }
 
-  if (playerPerks & PERK_DOUBLE_HP) {
-    base *= 2;
+  size_t start = (frameArena.used + FRAME_ARENA_ALIGNMENT - 1) & ~(size_t)(FRAME_ARENA_ALIGNMENT - 1);
+
+  if (start + size > frameArena.capacity) {
+    frameArena.overflows += 1;
+    return NULL;
   }
 
-  return base;
-}
+  frameArena.used = start + size;
 
-#define MOUSE_SENSITIVITY 0.7f
+  size_t highWater = atomic_load(&frameArenaHighWater);
+  while (highWater < frameArena.used &&
+         !atomic_compare_exchange_weak(&frameArenaHighWater, &highWater, frameArena.used)) {
+  }
 
-void bossBallUpdateShader(void) {
-  SetShaderValue(bossBallLightingShader,
-                 bossBallLightingShader.locs[SHADER_LOC_VECTOR_VIEW],
-                 &bossBallCamera.position,
-                 SHADER_UNIFORM_VEC3);
+  return frameArena.memory + start;
+}
 
-  UpdateLightValues(bossBallLightingShader, bossBallLight);
+/* NOTE: a scratch scope gives back everything allocated inside it, for code that runs many times per frame */
+size_t scratchBegin(void) {
+  return frameArena.used;
 }
 
-float mod(float v, float max) {
-  if (v > max) {
-    return fmodf(v, max);
-  }
+void scratchEnd(size_t mark) {
+  frameArena.used = mark;
+}
 
-  if (v < 0) {
-    return max - fmodf(v, max);
-  }
+void resetFrameArena(void) {
+  frameArena.used = 0;
+  frameArena.overflows = 0;
+}
 
-  return v;
+void freeFrameArena(void) {
+  free(frameArena.memory);
+  memset(&frameArena, 0, sizeof(frameArena));
 }
 
-float angleBetweenPoints(Vector2 p1, Vector2 p2) {
-  Vector2 d = Vector2Subtract(p1, p2);
-  float dist = sqrt((d.x * d.x) + (d.y * d.y));
+/* like TextFormat, but the text stays valid until the end of the frame instead of for the next few calls */
+const char *frameFormat(const char *format, ...) {
+  va_list args;
 
-  float alpha = asin(d.x / dist) * RAD2DEG;
+  va_start(args, format);
+  int len = vsnprintf(NULL, 0, format, args);
+  va_end(args);
 
-  if (d.y > 0) {
-    alpha = copysignf(180 - fabsf(alpha), alpha);
+  char *text = frameAlloc(len + 1);
+
+  if (text == NULL) {
+    return "";
   }
 
-  alpha += 180;
+  va_start(args, format);
+  vsnprintf(text, len + 1, format, args);
+  va_end(args);
 
-  return alpha;
+  return text;
 }
 
-void checkForCollisionsBetweenAsteroids(int i, int k) {
-  for (int bi = 0; bi < asteroids[i].sprite->boundingCirclesLen; bi++) {
-    Vector2 ipos = Vector2Add(asteroids[i].position,
-                              asteroids[i].processedBoundingCircles[bi].position);
+/* every body that can touch something else, rebuilt from the game state at the start of a collision pass */
+typedef enum {
+  COLLISION_SHAPE_CIRCLE,
+  COLLISION_SHAPE_COMPOUND,
+  COLLISION_SHAPE_BOX,
+  COLLISION_SHAPE_CAPSULE,
+} CollisionShapeType;
 
-    for (int bk = 0; bk < asteroids[k].sprite->boundingCirclesLen; bk++) {
-      Vector2 kpos = Vector2Add(asteroids[k].position,
-                                asteroids[k].processedBoundingCircles[bk].position);
+typedef struct {
+  CollisionShapeType type;
 
-      float distance = Vector2Distance(kpos, ipos);
-      float radiusSum =
-        (asteroids[k].processedBoundingCircles[bk].radius +
-         asteroids[i].processedBoundingCircles[bi].radius);
+  union {
+    Circle circle;
 
-      if (distance < radiusSum) {
-        float angle = angleBetweenPoints(kpos, ipos) *
-          DEG2RAD;
+    /* NOTE: compound colliders are kept in sync by their owners, so they are referenced instead of copied */
+    const CompoundCollider *compound;
 
-        float offsetDistance = distance - radiusSum;
-        Vector2 offset = Vector2Rotate((Vector2) {0, offsetDistance}, angle);
-        asteroids[i].position = Vector2Add(asteroids[i].position, offset);
+    /* NOTE: `rect.x` and `rect.y` are the center of the box */
+    struct {
+      Rectangle rect;
+      float angle;
+    } box;
 
-        asteroids[i].delta = Vector2Add(asteroids[i].delta, offset);
-        asteroids[k].delta = Vector2Subtract(asteroids[k].delta, offset);
+    struct {
+      Vector2 start;
+      Vector2 end;
+      float radius;
+    } capsule;
+  };
+} CollisionShape;
 
-        asteroids[i].launchedByPlayer = false;
-        asteroids[k].launchedByPlayer = true;
-        return;
-      }
-    }
-  }
-}
+typedef enum {
+  COLLIDER_PLAYER,
+  COLLIDER_ASTEROID,
+  COLLIDER_BOSS_MARINE,
+  COLLIDER_BOSS_BALL,
+  COLLIDER_BOSS_BALL_WEAPON,
+  COLLIDER_PROJECTILE,
+} ColliderOwner;
 
-void checkForCollisionsBetweenAsteroidsAndBorders(void) {
-  Vector2 normalDown = {0, 1};
-  Vector2 normalUp = {0, -1};
-  Vector2 normalRight = {1, 0};
-  Vector2 normalLeft = {-1, 0};
+typedef struct {
+  ColliderOwner owner;
+  int index;
 
-  for (int i = 0; i < asteroidsLen; i++) {
-    for (int j = 0; j < asteroids[i].sprite->boundingCirclesLen; j++) {
-      Vector2 pos = Vector2Add(asteroids[i].position,
-                               asteroids[i].processedBoundingCircles[j].position);
+  CollisionLayer layer;
+  CollisionShape shape;
 
-      float r = asteroids[i].processedBoundingCircles[j].radius;
+  Circle bounds;
+} Collider;
 
-      if ((pos.y - r) <= 0) {
-        asteroids[i].delta = Vector2Reflect(asteroids[i].delta, normalDown);
-        asteroids[i].launchedByPlayer = false;
-        break;
-      }
+typedef struct {
+  int query;
+  int collider;
 
-      if ((pos.x - r) <= 0) {
-        asteroids[i].delta = Vector2Reflect(asteroids[i].delta, normalRight);
-        asteroids[i].launchedByPlayer = false;
-        break;
-      }
+  int queryPart;
+  int colliderPart;
 
-      if ((pos.y + r) >= LEVEL_HEIGHT - 1) {
-        asteroids[i].delta = Vector2Reflect(asteroids[i].delta, normalUp);
-        asteroids[i].launchedByPlayer = false;
-        break;
-      }
+  Vector2 push;
+} Contact;
 
-      if ((pos.x + r) >= LEVEL_WIDTH - 1) {
-        asteroids[i].delta = Vector2Reflect(asteroids[i].delta, normalLeft);
-        asteroids[i].launchedByPlayer = false;
-        break;
-      }
-    }
-  }
-}
+/* NOTE: owned by whoever queries, so that queries never write into the world */
+typedef struct {
+  Contact *items;
+  int len;
+  int capacity;
+} ContactList;
 
-void updateAsteroids(void) {
-  for (int i = 0; i < asteroidsLen; i++) {
-    for (int k = 0; k < asteroidsLen; k++) {
-      if (k == i) {
-        continue;
-      }
+/* NOTE: both ships, every asteroid, the boss, each weapon as a body and a laser, and every projectile as a rocket */
+#define COLLISION_WORLD_MAX (2 + MAX_ASTEROIDS + 1 + (BOSS_BALL_WEAPONS * 2) + PROJECTILES_MAX)
+#define CONTACTS_MAX 512
 
-      checkForCollisionsBetweenAsteroids(i, k);
-    }
+typedef struct {
+  Collider colliders[COLLISION_WORLD_MAX];
+  int len;
+} CollisionWorld;
+
+typedef enum {
+  COLLISION_EVENT_PROJECTILE_BLOCKED,
+  COLLISION_EVENT_PLAYER_HIT,
+  COLLISION_EVENT_BOSS_HIT,
+  COLLISION_EVENT_ROCKET_SHOT_DOWN,
+  COLLISION_EVENT_WEAPON_HIT,
+} CollisionEventType;
 
-    asteroids[i].position = Vector2Add(asteroids[i].position, asteroids[i].delta);
+typedef struct {
+  CollisionEventType type;
+  int projectile;
+  /* NOTE: the rocket, the weapon, the ship or the `ColliderOwner` of the boss that got hit */
+  int other;
+} CollisionEvent;
 
-    float properAngle = asteroids[i].angle + 180;
-    asteroids[i].angle = mod(properAngle + asteroids[i].angleDelta, 360) - 180;
+#define COLLISION_EVENTS_MAX (PROJECTILES_MAX * 2)
 
-    for (int j = 0; j < asteroids[i].sprite->boundingCirclesLen; j++) {
-      asteroids[i].processedBoundingCircles[j].position =
-        Vector2Rotate(asteroids[i].sprite->boundingCircles[j].position,
-                      asteroids[i].angle * DEG2RAD);
+typedef struct {
+  CollisionEvent items[COLLISION_EVENTS_MAX];
+  int len;
+} CollisionEvents;
 
-      asteroids[i].processedBoundingCircles[j].position =
-        Vector2Scale(asteroids[i].processedBoundingCircles[j].position, SPRITES_SCALE);
+typedef struct {
+  Direction movement;
+  Vector2 aim;
+  bool fire;
+  bool dash;
+} PlayerInput;
 
-      asteroids[i].processedBoundingCircles[j].radius =
-        asteroids[i].sprite->boundingCircles[j].radius * SPRITES_SCALE;
-    }
-  }
+typedef struct {
+  Vector2 position;
+  float angle;
+  float alpha;
+} PlayerDashTrail;
 
-  checkForCollisionsBetweenAsteroidsAndBorders();
-}
+#define PLAYER_DASH_TRAILS_MAX 64
+static int dashTrailsCapacity = PLAYER_DASH_TRAILS_MAX;
 
-Projectile *push_projectile(void) {
-  for (int i = 0; i < PROJECTILES_MAX; i++) {
-    if (projectiles[i].type == PROJECTILE_NONE) {
-      return &projectiles[i];
-    }
+#define PARTICLE_JOB_CHUNKS 8
+#define PROJECTILE_JOB_CHUNKS 8
+
+/* NOTE: everything a fight is made of, so that many of them can be simulated side by side */
+typedef struct {
+  GameState gameState;
+  BossType currentBoss;
+  SimulationClock simulationClock;
+  uint64_t randomState;
+
+  bool headless;
+
+  /* NOTE: resimulated ticks and the other peer's world already made their noise once */
+  bool silent;
+
+  bool coop;
+
+  Perk playerPerks;
+  Perk firstNewPerk;
+  Perk secondNewPerk;
+  PlayerStats playerStats;
+  PlayerInput playerInput;
+  Vector2 mouseCursor;
+  Vector2 lookingDirection;
+  Player player;
+  ENTITY_STORE(PlayerDashTrail, PLAYER_DASH_TRAILS_MAX) dashTrails;
+
+  Player wingman;
+  PlayerInput wingmanInput;
+  Vector2 wingmanLookingDirection;
+
+  BossMarine bossMarine;
+  BossMarineAttack bossMarineLastAttack;
+  BossBall bossBall;
+  float deadBallTimer;
+  float deadPlayerTime;
+
+  Asteroid asteroids[MAX_ASTEROIDS];
+  int asteroidsLen;
+  Circle worldCircles[WORLD_CIRCLES_MAX];
+  ENTITY_STORE(Projectile, PROJECTILES_MAX) projectiles;
+  ENTITY_STORE(Particle, PARTICLES_MAX) particles;
+
+  CollisionWorld collisionWorld;
+  CollisionEvents collisionEvents;
+  CollisionEvents projectileChunkEvents[PROJECTILE_JOB_CHUNKS];
+} World;
+
+/* NOTE: lowers how many entities of a kind can be alive at once, from 0 up to the size of their arrays */
+void setEntityCapacity(const char *kind, int count) {
+  if (strcmp(kind, "projectiles") == 0) {
+    projectilesCapacity = Clamp(count, 0, PROJECTILES_MAX);
+  } else if (strcmp(kind, "particles") == 0) {
+    particlesCapacity = Clamp(count, 0, PARTICLES_MAX);
+  } else if (strcmp(kind, "dash-trails") == 0) {
+    dashTrailsCapacity = Clamp(count, 0, PLAYER_DASH_TRAILS_MAX);
+  } else {
+    LOG("CAPACITY: unknown entity kind '%s'\n", kind);
   }
+}
 
-  return NULL;
+static World gameWorld = {
+  .gameState = GAME_MAIN_MENU,
+  .currentBoss = BOSS_MARINE,
+  .simulationClock = {
+    .scale = 1,
+  },
+  .deadPlayerTime = 2.0f,
+};
+
+/* NOTE: the world the calling thread simulates, jobs inherit it from whoever added them */
+static _Thread_local World *world = NULL;
+
+void seedRandom(uint64_t seed) {
+  /* NOTE: splitmix64, so that neighbouring seeds still start far apart */
+  uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  z ^= z >> 31;
+
+  world->randomState = z != 0 ? z : 1;
 }
 
-static Vector2 lookingDirection = {0};
+/* xorshift64*, every world has its own, so a seed always replays the same fight */
+uint32_t nextRandom(void) {
+  uint64_t x = world->randomState;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  world->randomState = x;
 
-static Vector2 screenMouseLocation = {0};
+  return (uint32_t)((x * 0x2545F4914F6CDD1Dull) >> 32);
+}
 
-float playerLookingAngle(void) {
-  static const Vector2 up = {
-    .x = 0,
-    .y = -1,
-  };
+/* same contract as `GetRandomValue`, both ends are inclusive */
+int randomValue(int min, int max) {
+  if (min > max) {
+    int t = min;
+    min = max;
+    max = t;
+  }
 
-  float angle = Vector2Angle(up, lookingDirection) * RAD2DEG;
+  return min + (int)(nextRandom() % (uint32_t)(max - min + 1));
+}
 
-  return angle;
+float randomFloat(void) {
+  return (float)nextRandom() / (float)UINT32_MAX;
 }
 
-void bossStealHealth(int bossHealth, int bossMaxHealth) {
-  if ((playerPerks & PERK_VAMPIRISM) == 0) {
-    return;
+/* NOTE: headless worlds run on worker threads without an audio device */
+bool isAudible(void) {
+  return !world->silent && !world->headless;
+}
+
+void playSound(Sound sound) {
+  if (isAudible()) {
+    PlaySound(sound);
   }
+}
 
-  int maxHealthToSteal = (MAX_PLAYER_HEALTH / 2);
-  int bossHealthChunk = bossMaxHealth / maxHealthToSteal;
-  int currentAmountOfChunks = bossHealth / bossHealthChunk;
+void playMusic(Music music) {
+  if (isAudible()) {
+    PlayMusicStream(music);
+  }
+}
 
-  if ((currentAmountOfChunks + player.healthStolen) < maxHealthToSteal) {
-    player.health = (int)Clamp(player.health + 1, 0, MAX_PLAYER_HEALTH);
-    player.healthStolen += 1;
-    player.healTimer = 1.0f;
-    PlaySound(playerHealSound);
+void pauseMusic(Music music) {
+  if (isAudible()) {
+    PauseMusicStream(music);
   }
 }
 
-void bossMarineStealHealth(void) {
-  bossStealHealth(bossMarine.health, BOSS_MARINE_MAX_HEALTH);
+void stopMusic(Music music) {
+  if (isAudible()) {
+    StopMusicStream(music);
+  }
 }
 
-void bossBallStealHealth(void) {
-  bossStealHealth(bossBall.health, BOSS_BALL_MAX_HEALTH);
+void updateMusic(Music music) {
+  if (isAudible()) {
+    UpdateMusicStream(music);
+  }
 }
 
-void bossMarineCheckCollisions(bool sendAsteroidsFlying) {
-  for (int i = 0; i < BOSS_MARINE_BOUNDING_CIRCLES; i++) {
-    Vector2 bcPos = Vector2Add(bossMarine.processedBoundingCircles[i].position,
-                               bossMarine.position);
-    float r = bossMarine.processedBoundingCircles[i].radius;
-
-    for (int ai = 0; ai < asteroidsLen; ai++) {
-      for (int abi = 0; abi < asteroids[ai].sprite->boundingCirclesLen; abi++) {
-        Vector2 pos =
-          Vector2Add(asteroids[ai].processedBoundingCircles[abi].position,
-                     asteroids[ai].position);
-
-        float distance = Vector2Distance(pos, bcPos);
-        float radiusSum =
-          (asteroids[ai].processedBoundingCircles[abi].radius + r);
-
-        if (distance < radiusSum) {
-          if (asteroids[ai].launchedByPlayer) {
-#define ASTEROID_BASE_DAMAGE 4
-            float damageMultiplier = Vector2Length(asteroids[ai].delta);
-            bossMarine.health = (int)Clamp(bossMarine.health - (damageMultiplier * ASTEROID_BASE_DAMAGE),
-                                           0.0f,
-                                           BOSS_MARINE_MAX_HEALTH);
-            bossMarineStealHealth();
-            asteroids[ai].launchedByPlayer = false;
-          }
+bool isMusicPlaying(Music music) {
+  return isAudible() && IsMusicStreamPlaying(music);
+}
 
-          float angle = angleBetweenPoints(bcPos, asteroids[ai].position) * DEG2RAD;
+#define MAX_PLAYER_HEALTH maxPlayerHealth()
+int maxPlayerHealth(void) {
+  int base = 8;
 
-          float offsetDistance = distance - radiusSum;
-          Vector2 asteroidOffset = Vector2Rotate((Vector2) {0, offsetDistance}, angle);
+  if (world->playerPerks & PERK_GLASS_CANON) {
+    base /= 4;
+  }
 
-          asteroids[ai].position = Vector2Add(asteroids[ai].position, asteroidOffset);
-          if (sendAsteroidsFlying) {
-            asteroids[ai].delta = Vector2Add(asteroids[ai].delta, Vector2Scale(asteroidOffset, 0.5));
-          }
-        }
-      }
-    }
+  if (world->playerPerks & PERK_DOUBLE_HP) {
+    base *= 2;
   }
 
-  for (int i = 0; i < BOSS_MARINE_BOUNDING_CIRCLES; i++) {
-    Vector2 bcPos = Vector2Add(bossMarine.processedBoundingCircles[i].position,
-                               bossMarine.position);
-    float r = bossMarine.processedBoundingCircles[i].radius;
+  return base;
+}
 
-    float distance = Vector2Distance(player.position, bcPos);
-    float radiusSum = PLAYER_HITBOX_RADIUS + r;
+#define MOUSE_SENSITIVITY 0.7f
 
-    if (distance < radiusSum) {
-      float angle = angleBetweenPoints(bcPos, player.position);
-      float offsetDistance = distance - radiusSum;
-      Vector2 offset = Vector2Rotate((Vector2){0, offsetDistance}, angle);
-      player.position = Vector2Add(player.position, offset);
+void bossBallUpdateShader(void) {
+  SetShaderValue(bossBallLightingShader,
+                 bossBallLightingShader.locs[SHADER_LOC_VECTOR_VIEW],
+                 &bossBallCamera.position,
+                 SHADER_UNIFORM_VEC3);
 
-      if (playerPerks & PERK_OMINOUS_AURA &&
-          player.isInvincible) {
-        bossMarine.health -= 1;
-      }
-    }
-  }
+  UpdateLightValues(bossBallLightingShader, bossBallLight);
 }
 
-void bossMarineUpdateWeapon(void) {
-  Vector2 weaponOffset = (Vector2) {
-    .x = bossMarine.horizontalFlip * bossMarine.weaponOffset.x,
-    .y = bossMarine.weaponOffset.y,
-  };
+float mod(float v, float max) {
+  if (v > max) {
+    return fmodf(v, max);
+  }
 
-  bossMarine.weaponAngle =
-    angleBetweenPoints(Vector2Add(bossMarine.position,
-                                  weaponOffset),
-                       player.position) - 90;
-  if (bossMarine.horizontalFlip == -1) {
-    bossMarine.weaponAngle += 180;
+  if (v < 0) {
+    return max - fmodf(v, max);
   }
 
-  bossMarine.weaponAngle += bossMarine.weaponAngleOffset;
+  return v;
+}
+
+/* NOTE: speeds and smoothing rates below were tuned per frame at this rate */
+#define REFERENCE_FRAME_RATE 60.0f
+/* NOTE: a long hitch is slowed down instead of letting things tunnel through walls */
+#define MAX_FRAME_STEPS 4.0f
 
-  Vector2 bulletOrigin = Vector2Rotate((Vector2) {
-      .x = bossMarine.horizontalFlip * ((bossMarineWeaponRect.width / 2) * SPRITES_SCALE),
-      .y = -6 * SPRITES_SCALE,
-    }, bossMarine.weaponAngle * DEG2RAD);
-  bossMarine.bulletOrigin = Vector2Add(weaponOffset, bulletOrigin);
+#define TIME_SCALE_MAX 1000
+
+
+/* NOTE: fast-forwarded ticks have a fixed length, the rendered frames take too long to time them */
+void advanceSimulationClock(void) {
+  world->simulationClock.tick = world->simulationClock.scale > 1 ? (1.0f / REFERENCE_FRAME_RATE) : GetFrameTime();
+  world->simulationClock.time += world->simulationClock.tick;
 }
 
-void bossMarineWalk(void) {
-  float playerBossAngle = angleBetweenPoints(player.position,
-                                             bossMarine.position);
-#define BOSS_MARINE_SPEED 4
-#define BOSS_MARINE_MIN_PLAYER_DISTANCE 200
-#define BOSS_MARINE_MAX_PLAYER_DISTANCE 400
+float simulationFrameTime(void) {
+  return world->simulationClock.tick;
+}
 
-  float playerBossDistance = Vector2Distance(player.position,
-                                             bossMarine.position);
+double simulationTime(void) {
+  return world->simulationClock.time;
+}
 
-  Vector2 delta = Vector2Rotate((Vector2) {0, -BOSS_MARINE_SPEED},
-                                playerBossAngle * DEG2RAD);
+void setTimeScale(int scale) {
+  world->simulationClock.scale = Clamp(scale, 1, TIME_SCALE_MAX);
+}
 
-  if (playerBossDistance < BOSS_MARINE_MIN_PLAYER_DISTANCE) {
-    bossMarine.position = Vector2Add(bossMarine.position, Vector2Scale(delta, 2));
-  } else if (playerBossDistance > BOSS_MARINE_MAX_PLAYER_DISTANCE && bossMarine.isWalking) {
-    bossMarine.position = Vector2Add(bossMarine.position, Vector2Scale(delta, -1));
-  } else if (bossMarine.isWalking) {
-    float angle = bossMarine.walkingDirection * BOSS_MARINE_SPEED;
-    Vector2 diff = Vector2Subtract(bossMarine.position, player.position);
-    diff = Vector2Rotate(diff, angle * DEG2RAD);
-    bossMarine.position = Vector2Lerp(bossMarine.position, Vector2Add(diff, player.position), 0.1f);
-  }
+/* how many reference frames the last tick lasted */
+float frameSteps(void) {
+  return MIN(simulationFrameTime() * REFERENCE_FRAME_RATE, MAX_FRAME_STEPS);
 }
 
-#define BOSS_MARINE_BASE_DAMAGE 1
-#define BOSS_MARINE_PROJECTILE_RADIUS 13
-#define BOSS_MARINE_PROJECTILE_SPEED 25.0f
+/* `Lerp(from, to, rate)` once per reference frame, as exponential decay over the last frame */
+float damp(float from, float to, float rate) {
+  return Lerp(from, to, 1.0f - powf(1.0f - rate, frameSteps()));
+}
 
-void bossMarineShoot(float speedMultiplier,
-                     float cooldown,
-                     float spread,
-                     Sound *sound,
-                     float lifetime,
-                     bool willBounce,
-                     Color inside,
-                     Color outside) {
-  if (bossMarine.fireCooldown > 0.0f) {
-    return;
+Vector2 dampVector2(Vector2 from, Vector2 to, float rate) {
+  return Vector2Lerp(from, to, 1.0f - powf(1.0f - rate, frameSteps()));
+}
+
+/* moves `position` by a per reference frame `delta` */
+Vector2 stepVector2(Vector2 position, Vector2 delta) {
+  return Vector2Add(position, Vector2Scale(delta, frameSteps()));
+}
+
+float angleBetweenPoints(Vector2 p1, Vector2 p2) {
+  Vector2 d = Vector2Subtract(p1, p2);
+  float dist = sqrt((d.x * d.x) + (d.y * d.y));
+
+  float alpha = asin(d.x / dist) * RAD2DEG;
+
+  if (d.y > 0) {
+    alpha = copysignf(180 - fabsf(alpha), alpha);
   }
 
-  Projectile *new_projectile = push_projectile();
+  alpha += 180;
 
-  if (new_projectile == NULL) {
-    return;
+  return alpha;
+}
+
+/* if the circles overlap, stores into `push` the smallest offset that moves `b` out of `a` */
+bool circleContact(Vector2 a, float ra, Vector2 b, float rb, Vector2 *push) {
+  Vector2 d = Vector2Subtract(b, a);
+  float radiusSum = ra + rb;
+  float distanceSqr = (d.x * d.x) + (d.y * d.y);
+
+  if (distanceSqr >= (radiusSum * radiusSum)) {
+    return false;
   }
 
-  *new_projectile = (Projectile) {
-    .type = PROJECTILE_REGULAR,
-    .isHurtfulForBoss = false,
-    .isHurtfulForPlayer = true,
-    .damage = BOSS_MARINE_BASE_DAMAGE,
-    .origin = Vector2Add(bossMarine.position, bossMarine.bulletOrigin),
-    .radius = BOSS_MARINE_PROJECTILE_RADIUS,
-    .delta = Vector2Rotate(Vector2Scale((Vector2) {bossMarine.horizontalFlip, 0}, BOSS_MARINE_PROJECTILE_SPEED * speedMultiplier),
-                           (bossMarine.weaponAngle + spread) * DEG2RAD),
-    .angle = 0,
-    .inside = inside,
-    .outside = outside,
-    .lifetime = lifetime,
-    .canBounce = willBounce,
-  };
-  bossMarine.fireCooldown = cooldown;
+  float distance = sqrtf(distanceSqr);
 
-  if (sound) {
-    PlaySound(*sound);
+  if (distance <= 0.0f) {
+    *push = (Vector2) {0, -radiusSum};
+    return true;
   }
+
+  *push = Vector2Scale(d, (radiusSum - distance) / distance);
+  return true;
 }
 
-static BossMarineAttack bossMarineLastAttack = 0;
+float segmentPointDistanceSqr(Vector2 start, Vector2 end, Vector2 p) {
+  Vector2 segment = Vector2Subtract(end, start);
+  Vector2 toPoint = Vector2Subtract(p, start);
 
-void bossMarineAttack(void) {
-  bossMarine.attackTimer -= GetFrameTime();
-  bossMarine.fireCooldown -= GetFrameTime();
+  float lengthSqr = Vector2DotProduct(segment, segment);
+  float t = 0.0f;
 
-  if (bossMarine.attackTimer <= 0.0f) {
-    bossMarine.isWalking = (bool)GetRandomValue(0, 1);
+  if (lengthSqr > 0.0f) {
+    t = Clamp(Vector2DotProduct(toPoint, segment) / lengthSqr, 0.0f, 1.0f);
+  }
 
-    if (bossMarine.currentAttack == BOSS_MARINE_NOT_SHOOTING) {
-      BossMarineAttack a = 0;
-      do {
-        a = GetRandomValue(BOSS_MARINE_SINUS_SHOOTING,
-                           BOSS_MARINE_BOUNCING_WAVES);
-      } while (a == bossMarineLastAttack);
-      bossMarineLastAttack = a;
-      bossMarine.currentAttack = a;
+  Vector2 closest = Vector2Add(start, Vector2Scale(segment, t));
+  return Vector2DistanceSqr(closest, p);
+}
 
-      bossMarine.attackTimer = (float)GetRandomValue(3, 7);
-    } else {
-      bossMarine.currentAttack = BOSS_MARINE_NOT_SHOOTING;
-      bossMarine.attackTimer = (float)GetRandomValue(1, 10) / 10.0f;
-    }
+/* distance along the ray to where it enters the circle, or -1 if it misses it within `length` */
+float rayCircleEntry(Vector2 start, Vector2 direction, float length, Vector2 center, float radius) {
+  Vector2 m = Vector2Subtract(start, center);
 
-    bossMarine.weaponAngleOffset = 0;
+  float b = Vector2DotProduct(m, direction);
+  float c = Vector2DotProduct(m, m) - (radius * radius);
+
+  if (c > 0.0f && b > 0.0f) {
+    return -1;
   }
 
-  switch (bossMarine.currentAttack) {
-  case BOSS_MARINE_SINUS_SHOOTING: {
-    bossMarine.weaponAngleOffset = sin(GetTime() * 4) * 30 * bossMarine.horizontalFlip;
-    bossMarineUpdateWeapon();
+  float discriminant = (b * b) - c;
 
-    bossMarineShoot(0.3f, 0.04f, 0, &bossMarineGunshotSound, 10, false, MAROON, GOLD);
-  } break;
-  case BOSS_MARINE_NOT_SHOOTING: {
-    bossMarineUpdateWeapon();
-  } break;
-  case BOSS_MARINE_SHOOTING: {
-    bossMarineUpdateWeapon();
-    bossMarineShoot(0.5f, 0.06f, (float)GetRandomValue(-30, 30), &bossMarineGunshotSound, 10, false, MAROON, GOLD);
-  } break;
-  case BOSS_MARINE_SHOTGUNNING: {
-    bossMarineUpdateWeapon();
+  if (discriminant < 0.0f) {
+    return -1;
+  }
 
-    if (bossMarine.fireCooldown > 0.0f) {
-      break;
-    }
+  float t = MAX(0.0f, -b - sqrtf(discriminant));
 
-    for (int i = 0; i < 30; i++) {
-      (void) i;
+  return t <= length ? t : -1;
+}
 
-      float spread = (float)GetRandomValue(-30, 30);
-      float speed = (float)GetRandomValue(5, 10) / 10.0f * 0.8f;
+typedef struct {
+  union {
+    struct {
+      Vector2 topLeft;
+      Vector2 topRight;
+      Vector2 bottomRight;
+      Vector2 bottomLeft;
+    };
+    Vector2 points[4];
+  };
+} RectanglePoints;
 
-      Projectile *new_projectile = push_projectile();
+RectanglePoints translateIntoPoints(const Rectangle rect,
+                                    const float angle) {
+  const Vector2 halfSize = {rect.width * 0.5f, rect.height * 0.5f};
 
-      if (new_projectile == NULL) {
-        return;
-      }
+  const Vector2 topLeft = {-halfSize.x, -halfSize.y};
+  const Vector2 topRight = {+halfSize.x, -halfSize.y};
+  const Vector2 bottomRight = {+halfSize.x, +halfSize.y};
+  const Vector2 bottomLeft = {-halfSize.x, +halfSize.y};
 
-      *new_projectile = (Projectile) {
-        .type = PROJECTILE_SQUARED,
-        .isHurtfulForBoss = false,
-        .isHurtfulForPlayer = true,
-        .damage = BOSS_MARINE_BASE_DAMAGE,
-        .origin = Vector2Add(bossMarine.position, bossMarine.bulletOrigin),
-        .size = (Vector2) {
-          .x = BOSS_MARINE_PROJECTILE_RADIUS * 2,
-          .y = BOSS_MARINE_PROJECTILE_RADIUS * 4,
-        },
-        .delta = Vector2Rotate(Vector2Scale((Vector2) {bossMarine.horizontalFlip, 0},
-                                            BOSS_MARINE_PROJECTILE_SPEED * speed),
-                               (bossMarine.weaponAngle + spread) * DEG2RAD),
-        .angle = (bossMarine.weaponAngle + spread + 90),
-        .inside = MAROON,
-        .outside = GOLD,
-        .lifetime = 5.0f,
-        .canBounce = false,
-      };
-    }
+  const Vector2 pos = {rect.x, rect.y};
+  const float a = angle * DEG2RAD;
 
-    PlaySound(bossMarineShotgunSound);
-    bossMarine.fireCooldown = (float)GetRandomValue(5, 10) / 10.0f;
+  return (RectanglePoints) {
+    .topLeft = Vector2Add(pos, Vector2Rotate(topLeft, a)),
+    .topRight = Vector2Add(pos, Vector2Rotate(topRight, a)),
+    .bottomRight = Vector2Add(pos, Vector2Rotate(bottomRight, a)),
+    .bottomLeft = Vector2Add(pos, Vector2Rotate(bottomLeft, a)),
+  };
+}
 
-  } break;
-  case BOSS_MARINE_BOUNCING_WAVES: {
-    bossMarineUpdateWeapon();
+bool circleLineCollision(Vector2 start, Vector2 end,
+                         Vector2 circle, float radius) {
+  if (CheckCollisionPointCircle(start, circle, radius) ||
+      CheckCollisionPointCircle(end, circle, radius)) {
+    return true;
+  }
 
-    if (bossMarine.fireCooldown > 0.0f) {
-      break;
-    }
+  float lineDistance = Vector2Distance(start, end);
+  float dot =
+    (((circle.x - start.x) * (end.x - start.x)) +
+     ((circle.y - start.y) * (end.y - start.y))) /
+    (lineDistance * lineDistance);
 
-    for (int i = -40; i < 40; i += 2) {
-      float spread = (float)i;
+  Vector2 closest = {
+    .x = start.x + (dot * (end.x - start.x)),
+    .y = start.y + (dot * (end.y - start.y)),
+  };
 
-      bossMarineShoot(0.7f,
-                      0,
-                      spread,
-                      NULL,
-                      4.0f,
-                      true,
-                      GOLD,
-                      MAROON);
-    }
+  if (!CheckCollisionPointLine(closest,
+                               start, end,
+                               2)) {
+    return false;
+  }
 
-    PlaySound(bossMarineShotgunSound);
-    bossMarine.fireCooldown = (float)GetRandomValue(7, 10) / 10.0f;
-  } break;
-  };
+  return Vector2Distance(closest, circle) <= radius;
 }
 
-void updateBossMarine(void) {
-  if (bossMarine.health <= 0) {
-    PauseMusicStream(bossMarineMusic);
-    playerStats.kills += 1;
-    gameState = GAME_BOSS_DEAD;
+bool doesRectangleCollideWithACircle(Rectangle a, float angle,
+                                     Vector2 b, float r) {
+  RectanglePoints points = translateIntoPoints(a, angle);
 
-    for (int i = 0; i < PROJECTILES_MAX; i++) {
-      if (projectiles[i].type != PROJECTILE_NONE) {
-        projectiles[i].willBeDestroyed = true;
-        projectiles[i].destructionTimer = 0.02f;
+  return
+    circleLineCollision(points.topLeft, points.topRight, b, r) ||
+    circleLineCollision(points.topRight, points.bottomRight, b, r) ||
+    circleLineCollision(points.bottomRight, points.bottomLeft, b, r) ||
+    circleLineCollision(points.bottomLeft, points.topLeft, b, r);
+}
+
+bool checkRectangleCollision1(const Vector2 centerA, const RectanglePoints a,
+                              const RectanglePoints b) {
+  for (int i = 0; i < 4; i++) {
+    Vector2 start = centerA;
+    Vector2 end = a.points[i];
+
+    for (int k = 0; k < 4; k++) {
+      int kn = (k + 1) % 4;
+
+      if (CheckCollisionLines(start, end,
+                              b.points[k], b.points[kn],
+                              NULL)) {
+        return true;
       }
     }
-    return;
   }
 
-  bossMarine.horizontalFlip =
-    (player.position.x < bossMarine.position.x)
-    ? -1
-    : 1;
+  return false;
+}
 
-  for (int i = 0; i < BOSS_MARINE_BOUNDING_CIRCLES; i++) {
-    bossMarine.processedBoundingCircles[i] = bossMarine.boundingCircles[i];
-    bossMarine.processedBoundingCircles[i].position.x *= bossMarine.horizontalFlip;
-  }
+bool checkRectangleCollision(const Vector2 centerA, const RectanglePoints a,
+                             const Vector2 centerB, const RectanglePoints b) {
+  return
+    checkRectangleCollision1(centerA, a, b) ||
+    checkRectangleCollision1(centerB, b, a);
+}
 
-  bossMarineCheckCollisions(true);
-  bossMarineWalk();
+void initCompoundShape(CompoundShape *shape, const Circle *circles, int len, float scale, float angle, float horizontalFlip) {
+  assert(len <= COMPOUND_SHAPE_MAX_CIRCLES);
 
-  bossMarineAttack();
+  shape->len = len;
 
-  Vector2 minPos = Vector2Scale((Vector2){bossMarineRect.width / 2, bossMarineRect.width / 2},
-                                SPRITES_SCALE);
-  Vector2 maxPos = Vector2Subtract((Vector2) {LEVEL_WIDTH, LEVEL_HEIGHT},
-                                   minPos);
-  bossMarine.position = Vector2Clamp(bossMarine.position, minPos, maxPos);
-}
+  Vector2 min = {FLOAT_MAX, FLOAT_MAX};
+  Vector2 max = {-FLOAT_MAX, -FLOAT_MAX};
 
-void updateMouse(void) {
-  if (IsCursorHidden()) {
-    Vector2 delta =
-      Vector2Multiply(GetMouseDelta(),
-                      (Vector2) {
-                        .x = MOUSE_SENSITIVITY,
-                        .y = MOUSE_SENSITIVITY,
-                      });
-    screenMouseLocation = Vector2Add(screenMouseLocation, delta);
+  for (int i = 0; i < len; i++) {
+    Vector2 pos = circles[i].position;
+    pos.x *= horizontalFlip;
 
-    screenMouseLocation.x = Clamp(screenMouseLocation.x,
-                                  0.0f,
-                                  GetScreenWidth());
+    if (angle != 0.0f) {
+      pos = Vector2Rotate(pos, angle * DEG2RAD);
+    }
 
-    screenMouseLocation.y = Clamp(screenMouseLocation.y,
-                                  0.0f,
-                                  GetScreenHeight());
+    shape->circles[i] = (Circle) {
+      .position = Vector2Scale(pos, scale),
+      .radius = circles[i].radius * scale,
+    };
+
+    min.x = MIN(min.x, shape->circles[i].position.x - shape->circles[i].radius);
+    min.y = MIN(min.y, shape->circles[i].position.y - shape->circles[i].radius);
+    max.x = MAX(max.x, shape->circles[i].position.x + shape->circles[i].radius);
+    max.y = MAX(max.y, shape->circles[i].position.y + shape->circles[i].radius);
   }
 
-  mouseCursor = GetScreenToWorld2D(screenMouseLocation, camera);
+  shape->aabb = (Rectangle) {
+    .x = min.x,
+    .y = min.y,
+    .width = max.x - min.x,
+    .height = max.y - min.y,
+  };
 
-  if (!IsCursorHidden()) {
-    isGamePaused = true;
-    DisableCursor();
+  Vector2 center = Vector2Scale(Vector2Add(min, max), 0.5f);
+  float radius = 0;
+
+  for (int i = 0; i < len; i++) {
+    radius = MAX(radius, Vector2Distance(center, shape->circles[i].position) + shape->circles[i].radius);
   }
 
-#ifdef PLATFORM_DESKTOP
+  shape->bounds = (Circle) {
+    .position = center,
+    .radius = radius,
+  };
+}
 
-  if (!IsWindowFocused() || IsWindowHidden()) {
-    isGamePaused = true;
+Circle *colliderCircles(const CompoundCollider *c) {
+  return &world->worldCircles[c->first];
+}
+
+void syncCompoundCollider(CompoundCollider *c, Vector2 position, const CompoundShape *shape) {
+  Circle *circles = colliderCircles(c);
+
+  c->len = shape->len;
+
+  for (int i = 0; i < c->len; i++) {
+    circles[i] = (Circle) {
+      .position = Vector2Add(position, shape->circles[i].position),
+      .radius = shape->circles[i].radius,
+    };
   }
 
-#endif
+  c->bounds = (Circle) {
+    .position = Vector2Add(position, shape->bounds.position),
+    .radius = shape->bounds.radius,
+  };
 
-  lookingDirection = Vector2Normalize(Vector2Subtract(mouseCursor, player.position));
+  c->aabb = shape->aabb;
+  c->aabb.x += position.x;
+  c->aabb.y += position.y;
 }
 
-#define PLAYER_DASH_DISTANCE 20
+void translateCompoundCollider(CompoundCollider *c, Vector2 offset) {
+  Circle *circles = colliderCircles(c);
 
-void tryDashing(void) {
-  if (!IsMouseButtonPressed(MOUSE_BUTTON_RIGHT) ||
-      player.dashCooldown > 0.0f) {
-    return;
+  for (int i = 0; i < c->len; i++) {
+    circles[i].position = Vector2Add(circles[i].position, offset);
   }
 
-  Vector2 direction = Vector2Normalize(player.movementDelta);
+  c->bounds.position = Vector2Add(c->bounds.position, offset);
+  c->aabb.x += offset.x;
+  c->aabb.y += offset.y;
+}
 
-  if (direction.x == 0.0f && direction.y == 0.0f) {
-    return;
+/* first level of the hierarchy, cheap enough to run against everything */
+bool compoundColliderMayOverlap(const CompoundCollider *c, Vector2 position, float radius) {
+  if (position.x + radius < c->aabb.x ||
+      position.y + radius < c->aabb.y ||
+      position.x - radius > c->aabb.x + c->aabb.width ||
+      position.y - radius > c->aabb.y + c->aabb.height) {
+    return false;
   }
 
-  static const Vector2 up = {
-    .x = 0,
-    .y = -1,
-  };
-
-  float dashAngle = Vector2Angle(up, direction);
+  float radiusSum = c->bounds.radius + radius;
+  return Vector2DistanceSqr(c->bounds.position, position) < (radiusSum * radiusSum);
+}
 
-  float distance = PLAYER_DASH_DISTANCE;
-  if (playerPerks & PERK_STRONG_DASH) {
-    distance *= 1.5;
+/* returns the index of the first circle of the collider touching the given circle, or -1 */
+int compoundColliderFirstOverlap(const CompoundCollider *c, Vector2 position, float radius) {
+  if (!compoundColliderMayOverlap(c, position, radius)) {
+    return -1;
   }
 
-  Vector2 dashDistance = Vector2Scale(up, distance);
+  Circle *circles = colliderCircles(c);
 
-  player.dashCooldown = PLAYER_DASH_COOLDOWN;
-  player.dashDelta = Vector2Rotate(dashDistance, dashAngle);
-  player.isInvincible = true;
+  for (int i = 0; i < c->len; i++) {
+    if (CheckCollisionCircles(position, radius, circles[i].position, circles[i].radius)) {
+      return i;
+    }
+  }
 
-  PlaySound(dashSoundEffect);
+  return -1;
 }
 
-#define PLAYER_FIRE_COOLDOWN 0.15f
-#define PLAYER_PROJECTILE_RADIUS 9
-#define PLAYER_PROJECTILE_SPEED 30.0f
-#define PLAYER_PROJECTILE_BASE_DAMAGE 4
+void asteroidUpdateBoundingCircles(int i) {
+  initCompoundShape(&world->asteroids[i].shape,
+                    world->asteroids[i].sprite->boundingCircles,
+                    world->asteroids[i].sprite->boundingCirclesLen,
+                    SPRITES_SCALE,
+                    world->asteroids[i].angle,
+                    1.0f);
 
-void tryFiringAShot(void) {
-  if (!IsMouseButtonDown(MOUSE_BUTTON_LEFT) ||
-      player.fireCooldown > 0.0f ||
-      player.dashCooldown > 0.0f) {
-    return;
-  }
+  world->asteroids[i].collider.first = WORLD_CIRCLES_ASTEROIDS + (i * MAX_BOUNDING_CIRCLES);
 
-  #define PLAYER_BASE_BULLET_SPREAD 2
-  int spread = 2;
-  if (playerPerks & PERK_MORE_SPREAD) {
-    spread = 20;
-  }
+  syncCompoundCollider(&world->asteroids[i].collider,
+                       world->asteroids[i].position,
+                       &world->asteroids[i].shape);
+}
 
-  int halfSpread = spread / 2;
-  int a = GetRandomValue(-halfSpread, halfSpread);
+void moveAsteroid(int i, Vector2 offset) {
+  world->asteroids[i].position = Vector2Add(world->asteroids[i].position, offset);
+  translateCompoundCollider(&world->asteroids[i].collider, offset);
+}
 
-  int damage = PLAYER_PROJECTILE_BASE_DAMAGE;
-  float multX = 1.5f;
-  float multY = 3.0f;
-  if (playerPerks & PERK_RANDOM_SIZED_BULLETS) {
-    multX = (float)GetRandomValue(10, 20) / 5.0f;
-    multY = (float)GetRandomValue(20, 30) / 5.0f;
 
-    float area = multX * multY;
-    damage = ceilf(area / 5.0f);
-  }
+Circle collisionShapeBounds(const CollisionShape *shape) {
+  switch (shape->type) {
+  case COLLISION_SHAPE_CIRCLE: return shape->circle;
+  case COLLISION_SHAPE_COMPOUND: return shape->compound->bounds;
+  case COLLISION_SHAPE_BOX: {
+    Vector2 halfSize = {shape->box.rect.width / 2, shape->box.rect.height / 2};
 
-  if (playerPerks & PERK_LESS_HP_MORE_DAMAGE) {
-    float mult = 1.0f - ((float)player.health / MAX_PLAYER_HEALTH);
-    multX += mult;
-    multY += mult;
+    return (Circle) {
+      .position = {shape->box.rect.x, shape->box.rect.y},
+      .radius = Vector2Length(halfSize),
+    };
   }
-
-  if (playerPerks & PERK_DOUBLE_DAMAGE) {
-    damage *= 2;
+  case COLLISION_SHAPE_CAPSULE: {
+    return (Circle) {
+      .position = Vector2Scale(Vector2Add(shape->capsule.start, shape->capsule.end), 0.5f),
+      .radius = (Vector2Distance(shape->capsule.start, shape->capsule.end) / 2) + shape->capsule.radius,
+    };
   }
-
-  if (playerPerks & PERK_LESS_HP_MORE_DAMAGE) {
-    float hp = player.health / MAX_PLAYER_HEALTH;
-    hp = 1.0 - hp;
-    damage += damage * hp;
   }
 
-  float speed = PLAYER_PROJECTILE_SPEED;
-  if (playerPerks & PERK_SLOW_BUT_STEADY) {
-    damage *= 2;
-    speed /= 2;
-  }
+  return (Circle) {0};
+}
 
-  if (playerPerks & PERK_FAST_BULLETS) {
-    speed *= 2;
-  }
+Collider makeCollider(ColliderOwner owner, int index, CollisionLayer layer, CollisionShape shape) {
+  return (Collider) {
+    .owner = owner,
+    .index = index,
+    .layer = layer,
+    .shape = shape,
+    .bounds = collisionShapeBounds(&shape),
+  };
+}
 
-  if (playerPerks & PERK_GLASS_CANON) {
-    damage *= 5;
-  }
+Collider circleCollider(ColliderOwner owner, int index, CollisionLayer layer, Vector2 position, float radius) {
+  return makeCollider(owner, index, layer, (CollisionShape) {
+      .type = COLLISION_SHAPE_CIRCLE,
+      .circle = {position, radius},
+    });
+}
 
-  Color inside = (Color) {82, 85, 156, 255};
-  Color outside = (Color) {57, 60, 115, 255};
+Collider compoundCollider(ColliderOwner owner, int index, CollisionLayer layer, const CompoundCollider *compound) {
+  return makeCollider(owner, index, layer, (CollisionShape) {
+      .type = COLLISION_SHAPE_COMPOUND,
+      .compound = compound,
+    });
+}
 
-  if (playerPerks & PERK_HOMING) {
-    outside = inside;
-    inside = BLACK;
-  }
+Collider boxCollider(ColliderOwner owner, int index, CollisionLayer layer, Rectangle rect, float angle) {
+  return makeCollider(owner, index, layer, (CollisionShape) {
+      .type = COLLISION_SHAPE_BOX,
+      .box = {rect, angle},
+    });
+}
 
-  Vector2 size = {
-    .x = PLAYER_PROJECTILE_RADIUS * multX,
-    .y = PLAYER_PROJECTILE_RADIUS * multY,
-  };
+Collider capsuleCollider(ColliderOwner owner, int index, CollisionLayer layer, Vector2 start, Vector2 end, float radius) {
+  return makeCollider(owner, index, layer, (CollisionShape) {
+      .type = COLLISION_SHAPE_CAPSULE,
+      .capsule = {start, end, radius},
+    });
+}
 
-  float angle = playerLookingAngle() + (float)a;
-  Vector2 delta = Vector2Rotate(Vector2Scale(lookingDirection, speed),
-                                a * DEG2RAD);
+void collisionWorldAdd(Collider collider) {
+  assert(world->collisionWorld.len < COLLISION_WORLD_MAX);
 
-  if (playerPerks & PERK_MORE_BULLETS) {
-    Projectile *newProjectile1 = push_projectile();
+  if (world->collisionWorld.len >= COLLISION_WORLD_MAX) {
+    return;
+  }
 
-    if (newProjectile1 == NULL) {
-      return;
-    }
+  world->collisionWorld.colliders[world->collisionWorld.len++] = collider;
+}
 
-    // Vector2 originCenter = Vector2Add(player.position, Vector2Scale(lookingDirection, 35));
-    Vector2 lookingLeft = Vector2Rotate(lookingDirection, -15 * DEG2RAD);
-    Vector2 lookingRight = Vector2Rotate(lookingDirection, 15 * DEG2RAD);
+/* keeps a registered body in sync after a contact moved it */
+void collisionWorldMove(int c, Vector2 offset) {
+  Collider *collider = &world->collisionWorld.colliders[c];
 
-    Vector2 origLeft = Vector2Scale(lookingLeft, 55);
-    Vector2 origRight = Vector2Scale(lookingRight, 55);
+  switch (collider->shape.type) {
+  case COLLISION_SHAPE_CIRCLE: {
+    collider->shape.circle.position = Vector2Add(collider->shape.circle.position, offset);
+  } break;
+  case COLLISION_SHAPE_COMPOUND: break;
+  case COLLISION_SHAPE_BOX: {
+    collider->shape.box.rect.x += offset.x;
+    collider->shape.box.rect.y += offset.y;
+  } break;
+  case COLLISION_SHAPE_CAPSULE: {
+    collider->shape.capsule.start = Vector2Add(collider->shape.capsule.start, offset);
+    collider->shape.capsule.end = Vector2Add(collider->shape.capsule.end, offset);
+  } break;
+  }
 
-    Vector2 origin1 = Vector2Add(player.position, origLeft);
-    Vector2 origin2 = Vector2Add(player.position, origRight);
+  collider->bounds = collisionShapeBounds(&collider->shape);
+}
 
-    Projectile proj = {
-      .type = PROJECTILE_SQUARED,
+float bossBallWeaponAimAngle(int i) {
+  if (world->bossBall.weapons[i].isDisconnected) {
+    return world->bossBall.weapons[i].angle;
+  }
 
-      .isHurtfulForPlayer = false,
-      .isHurtfulForBoss = true,
+  return world->bossBall.weapons[i].angle + world->bossBall.weapons[i].angleOffset + world->bossBall.weaponAngleOffset;
+}
 
-      .damage = damage,
-      .size = size,
-      .delta = delta,
-      .angle = angle,
+Vector2 laserOrigin(int i) {
+  return Vector2Add(world->bossBall.weapons[i].bulletOrigin, world->bossBall.weapons[i].position);
+}
 
-      .inside = inside,
-      .outside = outside,
-      .lifetime = 10,
-      .canBounce = false,
-    };
+Vector2 laserDirection(int i) {
+  return Vector2Rotate((Vector2) {0, -1}, bossBallWeaponAimAngle(i) * DEG2RAD);
+}
 
-    *newProjectile1 = proj;
-    newProjectile1->origin = origin1;
+void collisionWorldBuild(CollisionLayer layers) {
+  world->collisionWorld.len = 0;
 
-    Projectile *newProjectile2 = push_projectile();
+  if (layers & COLLISION_LAYER_PLAYER) {
+    collisionWorldAdd(circleCollider(COLLIDER_PLAYER, 0, COLLISION_LAYER_PLAYER,
+                                     world->player.position, PLAYER_HITBOX_RADIUS));
+  }
 
-    if (newProjectile2 == NULL) {
-      return;
-    }
+  if ((layers & COLLISION_LAYER_WINGMAN) && world->coop) {
+    collisionWorldAdd(circleCollider(COLLIDER_PLAYER, 1, COLLISION_LAYER_WINGMAN,
+                                     world->wingman.position, PLAYER_HITBOX_RADIUS));
+  }
 
-    *newProjectile2 = proj;
-    newProjectile2->origin = origin2;
-  } else {
-    Projectile *new_projectile = push_projectile();
+  if (layers & COLLISION_LAYER_ASTEROID) {
+    for (int i = 0; i < world->asteroidsLen; i++) {
+      if (world->asteroids[i].isDestroyed) {
+        continue;
+      }
 
-    if (new_projectile == NULL) {
-      return;
+      collisionWorldAdd(compoundCollider(COLLIDER_ASTEROID, i, COLLISION_LAYER_ASTEROID,
+                                         &world->asteroids[i].collider));
     }
+  }
 
-    *new_projectile = (Projectile) {
-      .type = PROJECTILE_SQUARED,
+  if ((layers & COLLISION_LAYER_BOSS) && world->currentBoss == BOSS_MARINE) {
+    collisionWorldAdd(compoundCollider(COLLIDER_BOSS_MARINE, 0, COLLISION_LAYER_BOSS,
+                                       &world->bossMarine.collider));
+  }
 
-      .isHurtfulForPlayer = false,
-      .isHurtfulForBoss = true,
+  if ((layers & COLLISION_LAYER_BOSS) && world->currentBoss == BOSS_BALL) {
+    collisionWorldAdd(circleCollider(COLLIDER_BOSS_BALL, 0, COLLISION_LAYER_BOSS,
+                                     world->bossBall.position, BOSS_BALL_HITBOX_RADIUS));
+  }
 
-      .damage = damage,
+  for (int i = 0; i < BOSS_BALL_WEAPONS && world->currentBoss == BOSS_BALL; i++) {
+    if ((layers & COLLISION_LAYER_BOSS_WEAPON) &&
+        world->bossBall.weapons[i].isDisconnected) {
+      collisionWorldAdd(circleCollider(COLLIDER_BOSS_BALL_WEAPON, i, COLLISION_LAYER_BOSS_WEAPON,
+                                       world->bossBall.weapons[i].position,
+                                       bossBallWeaponHitboxRadiuses[world->bossBall.weapons[i].type]));
+    }
 
-      .origin = Vector2Add(player.position, Vector2Scale(lookingDirection, 35)),
-      .size = size,
-      .delta = delta,
-      .angle = angle,
+    if ((layers & COLLISION_LAYER_LASER) &&
+        world->bossBall.weapons[i].type == BOSS_BALL_WEAPON_LASER &&
+        world->bossBall.weapons[i].chargeLevel >= 1.0f) {
+      Vector2 start = laserOrigin(i);
+      Vector2 end = Vector2Add(start, Vector2Scale(laserDirection(i), world->bossBall.weapons[i].laserLength));
 
-      .inside = inside,
-      .outside = outside,
-      .lifetime = 10,
-      .canBounce = false,
-    };
+      collisionWorldAdd(capsuleCollider(COLLIDER_BOSS_BALL_WEAPON, i, COLLISION_LAYER_LASER,
+                                        start, end, LASER_HEIGHT / 2.0f));
+    }
   }
 
-  float cooldown = PLAYER_FIRE_COOLDOWN;
-  if (playerPerks & PERK_FAST_BULLETS) {
-    cooldown /= 2;
+  if (layers & COLLISION_LAYER_ROCKET) {
+    for (int i = 0; i < world->projectiles.pool.len; i++) {
+      if (world->projectiles.items[i].type != PROJECTILE_SQUARED ||
+          !world->projectiles.items[i].homesOntoPlayer ||
+          (world->projectiles.items[i].hurts & COLLISION_LAYER_PLAYER) == 0 ||
+          world->projectiles.items[i].willBeDestroyed) {
+        continue;
+      }
+
+      collisionWorldAdd(boxCollider(COLLIDER_PROJECTILE, i, COLLISION_LAYER_ROCKET,
+                                    (Rectangle) {world->projectiles.items[i].origin.x, world->projectiles.items[i].origin.y,
+                                                 world->projectiles.items[i].size.x, world->projectiles.items[i].size.y},
+                                    world->projectiles.items[i].angle));
+    }
   }
+}
 
-  player.fireCooldown = cooldown;
+/* NOTE: room for every contact a pass can find, taken from the frame arena of the thread asking */
+ContactList worldContacts(void) {
+  Contact *items = frameAlloc(CONTACTS_MAX * sizeof(Contact));
 
-  PlaySound(playerShot);
+  return (ContactList) {
+    .items = items,
+    .len = 0,
+    .capacity = items != NULL ? CONTACTS_MAX : 0,
+  };
 }
 
-typedef enum {
-  KEY_MOVE_UP,
-  KEY_MOVE_LEFT,
-  KEY_MOVE_DOWN,
-  KEY_MOVE_RIGHT,
-  KEY_MOVE_COUNT,
-} MovementKeys;
-
-static KeyboardKey esdfKeys[KEY_MOVE_COUNT] = {
-  [KEY_MOVE_UP] = KEY_E,
-  [KEY_MOVE_LEFT] = KEY_S,
-  [KEY_MOVE_DOWN] = KEY_D,
-  [KEY_MOVE_RIGHT] = KEY_F,
-};
+/* returns false once the contact list is full */
+bool pushContact(ContactList *contacts, int query, int collider, int queryPart, int colliderPart, Vector2 push) {
+  if (contacts->len >= contacts->capacity) {
+    return false;
+  }
 
-static KeyboardKey wasdKeys[KEY_MOVE_COUNT] = {
-  [KEY_MOVE_UP] = KEY_W,
-  [KEY_MOVE_LEFT] = KEY_A,
-  [KEY_MOVE_DOWN] = KEY_S,
-  [KEY_MOVE_RIGHT] = KEY_D,
-};
+  contacts->items[contacts->len++] = (Contact) {
+    .query = query,
+    .collider = collider,
+    .queryPart = queryPart,
+    .colliderPart = colliderPart,
+    .push = push,
+  };
 
-void movePlayerWithAKeyboard(void) {
-  KeyboardKey *keys = wasdKeys;
+  return true;
+}
 
-  if (esdf) {
-    keys = esdfKeys;
+/* circles and compound shapes are both just lists of circles for the narrowphase */
+int collisionShapeCircles(const CollisionShape *shape, const Circle **circles) {
+  switch (shape->type) {
+  case COLLISION_SHAPE_CIRCLE: {
+    *circles = &shape->circle;
+    return 1;
   }
-
-  if (IsKeyDown(keys[KEY_MOVE_UP])) {
-    player.movementDirection |= DIRECTION_UP;
-    player.movementDelta.y -= PLAYER_MOVEMENT_SPEED;
+  case COLLISION_SHAPE_COMPOUND: {
+    *circles = colliderCircles(shape->compound);
+    return shape->compound->len;
   }
-
-  if (IsKeyDown(keys[KEY_MOVE_LEFT])) {
-    player.movementDirection |= DIRECTION_LEFT;
-    player.movementDelta.x -= PLAYER_MOVEMENT_SPEED;
+  case COLLISION_SHAPE_BOX: break;
+  case COLLISION_SHAPE_CAPSULE: break;
   }
 
-  if (IsKeyDown(keys[KEY_MOVE_DOWN])) {
-    player.movementDirection |= DIRECTION_DOWN;
-    player.movementDelta.y += PLAYER_MOVEMENT_SPEED;
+  *circles = NULL;
+  return 0;
+}
+
+bool collideCircles(ContactList *contacts, int query, const Circle *a, int aLen,
+                    int collider, const Circle *b, int bLen) {
+  for (int i = 0; i < aLen; i++) {
+    for (int k = 0; k < bLen; k++) {
+      Vector2 push = {0};
+
+      if (circleContact(a[i].position, a[i].radius, b[k].position, b[k].radius, &push) &&
+          !pushContact(contacts, query, collider, i, k, push)) {
+        return false;
+      }
+    }
   }
 
-  if (IsKeyDown(keys[KEY_MOVE_RIGHT])) {
-    player.movementDirection |= DIRECTION_RIGHT;
-    player.movementDelta.x += PLAYER_MOVEMENT_SPEED;
+  return true;
+}
+
+bool collideBoxWithCircles(ContactList *contacts, int query, const CollisionShape *box,
+                           int collider, const Circle *circles, int len,
+                           bool swapped) {
+  for (int i = 0; i < len; i++) {
+    if (!doesRectangleCollideWithACircle(box->box.rect, box->box.angle, circles[i].position, circles[i].radius)) {
+      continue;
+    }
+
+    if (!pushContact(contacts, query, collider, swapped ? i : 0, swapped ? 0 : i, Vector2Zero())) {
+      return false;
+    }
   }
 
-  player.position = Vector2Add(player.position, player.movementDelta);
+  return true;
 }
 
-typedef struct {
-  Vector2 position;
-  float angle;
-  float alpha;
-} PlayerDashTrail;
+bool collideCapsuleWithCircles(ContactList *contacts, int query, const CollisionShape *capsule,
+                            int collider, const Circle *circles, int len,
+                            bool swapped) {
+  for (int i = 0; i < len; i++) {
+    float radiusSum = capsule->capsule.radius + circles[i].radius;
 
-#define PLAYER_DASH_TRAILS_MAX 64
-static PlayerDashTrail dashTrails[PLAYER_DASH_TRAILS_MAX] = {0};
+    if (segmentPointDistanceSqr(capsule->capsule.start, capsule->capsule.end, circles[i].position) > (radiusSum * radiusSum)) {
+      continue;
+    }
 
-PlayerDashTrail *pushDashTrail(void) {
-  for (int i = 0; i < PLAYER_DASH_TRAILS_MAX; i++) {
-    if (dashTrails[i].alpha <= 0.0f) {
-      return &dashTrails[i];
+    if (!pushContact(contacts, query, collider, swapped ? i : 0, swapped ? 0 : i, Vector2Zero())) {
+      return false;
     }
   }
 
-  return NULL;
+  return true;
 }
 
-void movePlayerWithADash(void) {
-#define DASH_DELTA_LERP_RATE 0.12f
-  player.dashDelta = Vector2Lerp(player.dashDelta,
-                                 Vector2Zero(),
-                                 DASH_DELTA_LERP_RATE);
+bool collideBoxes(ContactList *contacts, int query, const CollisionShape *a, int collider, const CollisionShape *b) {
+  RectanglePoints pa = translateIntoPoints(a->box.rect, a->box.angle);
+  RectanglePoints pb = translateIntoPoints(b->box.rect, b->box.angle);
+
+  if (!checkRectangleCollision((Vector2) {a->box.rect.x, a->box.rect.y}, pa,
+                               (Vector2) {b->box.rect.x, b->box.rect.y}, pb)) {
+    return true;
+  }
 
-  player.isInvincible = (roundf(player.dashDelta.x) != 0.0f ||
-                         roundf(player.dashDelta.y) != 0.0f);
+  return pushContact(contacts, query, collider, 0, 0, Vector2Zero());
+}
 
-  player.position =
-    Vector2Add(player.position,
-               player.dashDelta);
+/* NOTE: only the pairs that the game actually tests are supported, the rest never touch */
+bool collideShapes(ContactList *contacts, int query, const CollisionShape *a, int collider, const CollisionShape *b) {
+  const Circle *ac = NULL;
+  const Circle *bc = NULL;
+  int aLen = collisionShapeCircles(a, &ac);
+  int bLen = collisionShapeCircles(b, &bc);
 
-  if (!player.isInvincible) {
-    return;
+  if (ac && bc) {
+    return collideCircles(contacts, query, ac, aLen, collider, bc, bLen);
   }
 
-  PlayerDashTrail *new_trail = pushDashTrail();
-  if (!new_trail) {
-    return;
+  if (a->type == COLLISION_SHAPE_BOX && bc) {
+    return collideBoxWithCircles(contacts, query, a, collider, bc, bLen, false);
   }
 
-  *new_trail = (PlayerDashTrail) {
-    .position = player.position,
-    .angle = playerLookingAngle(),
-    .alpha = 1.0f,
-  };
-}
+  if (ac && b->type == COLLISION_SHAPE_BOX) {
+    return collideBoxWithCircles(contacts, query, b, collider, ac, aLen, true);
+  }
 
-void updatePlayerDashTrails(void) {
-  for (int i = 0; i < PLAYER_DASH_TRAILS_MAX; i++) {
-    dashTrails[i].alpha = Clamp(dashTrails[i].alpha - (GetFrameTime() * 3),
-                                0.0f,
-                                1.0f);
+  if (a->type == COLLISION_SHAPE_BOX && b->type == COLLISION_SHAPE_BOX) {
+    return collideBoxes(contacts, query, a, collider, b);
   }
-}
 
-float randomFloat(void) {
-  return (float)rand() / (float)RAND_MAX;
+  if (a->type == COLLISION_SHAPE_CAPSULE && bc) {
+    return collideCapsuleWithCircles(contacts, query, a, collider, bc, bLen, false);
+  }
+
+  if (ac && b->type == COLLISION_SHAPE_CAPSULE) {
+    return collideCapsuleWithCircles(contacts, query, b, collider, ac, aLen, true);
+  }
+
+  return true;
 }
 
-Particle *pushParticle() {
-  for (int i = 0; i < PARTICLES_MAX; i++) {
-    if (particles[i].lifetime <= 0.0f) {
-      return &particles[i];
-    }
+bool collidersMayOverlap(const Collider *a, const Collider *b) {
+  if (b->shape.type == COLLISION_SHAPE_COMPOUND) {
+    return compoundColliderMayOverlap(b->shape.compound, a->bounds.position, a->bounds.radius);
   }
 
-  return NULL;
+  if (a->shape.type == COLLISION_SHAPE_COMPOUND) {
+    return compoundColliderMayOverlap(a->shape.compound, b->bounds.position, b->bounds.radius);
+  }
+
+  float radiusSum = a->bounds.radius + b->bounds.radius;
+  return Vector2DistanceSqr(a->bounds.position, b->bounds.position) <= (radiusSum * radiusSum);
 }
 
-void spawnAsteroidParticles(int i) {
-  float particleAmount = 1.0f * (asteroids[i].sprite->textureRect.width *
-                                 asteroids[i].sprite->textureRect.height);
-  float particlesPerCircle = particleAmount / asteroids[i].sprite->boundingCirclesLen;
+bool collideWithCollider(ContactList *contacts, int q, const Collider *query, int c) {
+  const Collider *other = &world->collisionWorld.colliders[c];
 
-  for (int j = 0; j < asteroids[i].sprite->boundingCirclesLen; j++) {
-    for (int p = 0; p < particlesPerCircle; p++) {
-      Particle *newParticle = pushParticle();
+  if (other->owner == query->owner && other->index == query->index) {
+    return true;
+  }
 
-      if (newParticle == NULL) {
-        return;
-      }
+  if (!collidersMayOverlap(query, other)) {
+    return true;
+  }
 
-      Vector2 direction = (Vector2) {randomFloat() * 2.0f - 1.0f, randomFloat() * 2.0f - 1.0f};
-      float r = asteroids[i].processedBoundingCircles[j].radius;
-      float mag = r * randomFloat();
-      Vector2 pos = Vector2Scale(direction, mag);
-      Vector2 actualPos = Vector2Add(asteroids[i].position,
-                                     Vector2Add(asteroids[i].processedBoundingCircles[j].position, pos));
+  return collideShapes(contacts, q, &query->shape, c, &other->shape);
+}
 
-      float speed = randomFloat() * 2;
+/* fills `contacts` with everything in `mask` touching the query, never writes to the world */
+int collisionWorldQuery(const Collider *query, CollisionLayer mask, ContactList *contacts) {
+  contacts->len = 0;
 
-      *newParticle = (Particle) {
-        .color = asteroids[i].sprite->palette[GetRandomValue(0, asteroids[i].sprite->paletteLen - 1)],
-        .angle = asteroids[i].angle,
-        .lifetime = 2.0f,
-        .position = actualPos,
-        .delta = Vector2Scale(direction, speed),
-      };
+  for (int c = 0; c < world->collisionWorld.len; c++) {
+    if ((world->collisionWorld.colliders[c].layer & mask) == 0) {
+      continue;
+    }
+
+    if (!collideWithCollider(contacts, -1, query, c)) {
+      break;
     }
   }
-}
 
-void processCollisions(void) {
-  for (int i = 0; i < asteroidsLen; i++) {
-    for (int j = 0; j < asteroids[i].sprite->boundingCirclesLen; j++) {
-      Vector2 pos =
-        Vector2Add(asteroids[i].processedBoundingCircles[j].position,
-                   asteroids[i].position);
+  return contacts->len;
+}
 
-      float distance = Vector2Distance(pos, player.position);
-      float radiusSum =
-        (asteroids[i].processedBoundingCircles[j].radius + PLAYER_HITBOX_RADIUS);
+/* batched `collisionWorldQuery` for every registered collider in `layer` */
+int collisionWorldOverlaps(CollisionLayer layer, CollisionLayer mask, ContactList *contacts) {
+  contacts->len = 0;
 
-      if (distance < radiusSum) {
-        float angle = angleBetweenPoints(pos, player.position);
+  for (int q = 0; q < world->collisionWorld.len; q++) {
+    const Collider *query = &world->collisionWorld.colliders[q];
 
-        if (player.isInvincible) {
-          angle += 180;
-        }
+    if ((query->layer & layer) == 0) {
+      continue;
+    }
 
-        float offsetDistance = distance - radiusSum;
-        Vector2 offset = Vector2Rotate((Vector2) {0, offsetDistance}, angle * DEG2RAD);
+    for (int c = 0; c < world->collisionWorld.len; c++) {
+      CollisionLayer otherLayer = world->collisionWorld.colliders[c].layer;
 
-        if (player.isInvincible) {
-          if (playerPerks & PERK_OMINOUS_AURA) {
+      if ((otherLayer & mask) == 0) {
+        continue;
+      }
 
-            spawnAsteroidParticles(i);
+      /* NOTE: pairs that show up from both sides are only reported once */
+      if (c <= q && (otherLayer & layer) && (query->layer & mask)) {
+        continue;
+      }
 
-            asteroids[i].isDestroyed = true;
-            asteroids[i].position = (Vector2) {-200, -200};
-            PlaySound(asteroidDestructionSound);
-          } else {
-            asteroids[i].position = Vector2Add(asteroids[i].position, offset);
-            asteroids[i].delta = Vector2Add(asteroids[i].delta, Vector2Scale(offset, 0.2f));
-            asteroids[i].launchedByPlayer = true;
-          }
-        } else {
-          player.position = Vector2Add(player.position, offset);
-        }
+      if (!collideWithCollider(contacts, q, query, c)) {
+        return contacts->len;
       }
     }
   }
 
-  if (currentBoss != BOSS_BALL) {
-    return;
-  }
+  return contacts->len;
+}
 
-  if (player.isInvincible || player.iframeTimer > 0.0f) {
-    return;
-  }
+/* distance to the first circle of a collider in `mask` hit by the ray, `length` if nothing is hit */
+float collisionWorldRaycast(Vector2 start, Vector2 direction, float length, CollisionLayer mask) {
+  float nearest = length;
 
-  for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
-    if (bossBall.weapons[i].type != BOSS_BALL_WEAPON_LASER) {
-      continue;
-    }
+  for (int c = 0; c < world->collisionWorld.len; c++) {
+    const Collider *collider = &world->collisionWorld.colliders[c];
 
-    if (bossBall.weapons[i].chargeLevel < 1.0f) {
+    if ((collider->layer & mask) == 0) {
       continue;
     }
 
-    float angle = 0;
-    if (bossBall.weapons[i].isDisconnected) {
-      angle = bossBall.weapons[i].angle;
-    } else {
-      angle = bossBall.weapons[i].angle + bossBall.weapons[i].angleOffset + bossBall.weaponAngleOffset;
+    if (rayCircleEntry(start, direction, nearest, collider->bounds.position, collider->bounds.radius) < 0) {
+      continue;
     }
 
-    Vector2 relativePlayerPosition =
-      Vector2Subtract(player.position, Vector2Add(bossBall.weapons[i].bulletOrigin,
-                                                  bossBall.weapons[i].position));
-    Vector2 rotatedRelativePlayerPosition =
-      Vector2Rotate(relativePlayerPosition, (angle) * DEG2RAD * -1);
+    const Circle *circles = NULL;
+    int len = collisionShapeCircles(&collider->shape, &circles);
 
-    float hh = LASER_HEIGHT / 2;
+    for (int i = 0; i < len; i++) {
+      float t = rayCircleEntry(start, direction, nearest, circles[i].position, circles[i].radius);
 
-    Rectangle laser = {
-      -hh,
-      -bossBall.weapons[i].laserLength,
-      LASER_HEIGHT,
-      LASER_WIDTH,
-    };
-
-    if (CheckCollisionCircleRec(rotatedRelativePlayerPosition, PLAYER_HITBOX_RADIUS, laser) &&
-        player.iframeTimer <= 0.0f) {
-      PlaySound(hit);
-      player.health -= 1 * (playerPerks & PERK_MORE_BULLETS ? 2 : 1);
-      player.iframeTimer = 0.4f;
+      if (t >= 0) {
+        nearest = t;
+      }
     }
   }
+
+  return nearest;
 }
 
-void updatePlayerPosition(void) {
-  player.movementDirection = 0;
-  player.movementDelta = Vector2Zero();
+const Contact *findContact(const ContactList *contacts, CollisionLayer layer) {
+  for (int i = 0; i < contacts->len; i++) {
+    const Contact *contact = &contacts->items[i];
 
-  movePlayerWithAKeyboard();
-  movePlayerWithADash();
+    if (world->collisionWorld.colliders[contact->collider].layer & layer) {
+      return contact;
+    }
+  }
 
-  processCollisions();
+  return NULL;
+}
 
-  player.position =
-    Vector2Clamp(player.position,
-                 (Vector2) {
-                   .x = PLAYER_HITBOX_RADIUS,
-                   .y = PLAYER_HITBOX_RADIUS,
-                 },
-                 (Vector2) {
-                   .x = level.x - PLAYER_HITBOX_RADIUS,
-                   .y = level.y - PLAYER_HITBOX_RADIUS,
-                 });
+const Collider *contactCollider(const Contact *contact) {
+  return &world->collisionWorld.colliders[contact->collider];
 }
 
-void preRenderBackground(bool dom) {
-  float domv = dom ? 1.0f : 0.0f;
+CollisionLayer invincibleShips(void) {
+  CollisionLayer layers = COLLISION_LAYER_NONE;
 
-  float t = GetTime();
+  if (world->player.isInvincible) {
+    layers |= COLLISION_LAYER_PLAYER;
+  }
 
-  SetShaderValue(stars, starsDom, &domv, SHADER_UNIFORM_FLOAT);
-  SetShaderValue(stars, starsTime, &t, SHADER_UNIFORM_FLOAT);
+  if (world->wingman.isInvincible) {
+    layers |= COLLISION_LAYER_WINGMAN;
+  }
 
-  BeginTextureMode(backgroundTexture); {
-    BeginBlendMode(BLEND_ALPHA); {
-      ClearBackground((Color) {41, 1, 53, 69});
-      BeginShaderMode(stars); {
-        DrawTexture(nebulaNoise, 0, 0, WHITE);
-      }; EndShaderMode();
-    }; EndBlendMode();
-  }; EndTextureMode();
+  return layers;
 }
 
-void renderBackground() {
-  Vector2 pos = player.position;
+void checkForCollisionsBetweenAsteroids(void) {
+  collisionWorldBuild(COLLISION_LAYER_ASTEROID);
 
-  if (gameState == GAME_MAIN_MENU) {
-    pos = mouseCursor;
-  }
+  size_t scratch = scratchBegin();
+  ContactList contacts = worldContacts();
+  collisionWorldOverlaps(COLLISION_LAYER_ASTEROID, COLLISION_LAYER_ASTEROID, &contacts);
 
-  float background_x = Lerp(0, BACKGROUND_PARALLAX_OFFSET,
-                            pos.x / LEVEL_WIDTH);
+  for (int c = 0; c < contacts.len; c++) {
+    const Contact *contact = &contacts.items[c];
 
-  float background_y = Lerp(0, BACKGROUND_PARALLAX_OFFSET,
-                            pos.y / LEVEL_HEIGHT);
+    /* NOTE: only the first touching pair of circles pushes two asteroids apart */
+    if (c > 0 &&
+        contact->query == contact[-1].query &&
+        contact->collider == contact[-1].collider) {
+      continue;
+    }
 
-  DrawTexture(backgroundTexture.texture,
-              background_x, background_y,
-              WHITE);
-}
+    int i = world->collisionWorld.colliders[contact->query].index;
+    int k = contactCollider(contact)->index;
+    Vector2 offset = Vector2Negate(contact->push);
 
-static RenderTexture2D playerTexture = {0};
-static RenderTexture2D playerTexture1 = {0};
-static RenderTexture2D playerTexture2 = {0};
-static RenderTexture2D playerAuraTexture = {0};
+    moveAsteroid(i, offset);
 
-#define THRUSTERS_BOTTOM 0b0001
-#define THRUSTERS_TOP    0b0010
-#define THRUSTERS_RIGHT  0b0100
-#define THRUSTERS_LEFT   0b1000
+    world->asteroids[i].delta = Vector2Add(world->asteroids[i].delta, offset);
+    world->asteroids[k].delta = Vector2Subtract(world->asteroids[k].delta, offset);
 
-static Rectangle thrustersRects[] = {
-  [THRUSTERS_BOTTOM] = {
-    .x = 17,
-    .y = 30,
-    .width = 17,
-    .height = 4,
-  },
+    world->asteroids[i].launchedByPlayer = false;
+    world->asteroids[k].launchedByPlayer = true;
+  }
 
-  [THRUSTERS_TOP] = {
-    .x = 17,
-    .y = 16,
-    .width = 17,
-    .height = 4,
-  },
+  scratchEnd(scratch);
+}
 
-  [THRUSTERS_LEFT] = {
-    .x = 17,
-    .y = 16,
-    .width = 3,
-    .height = 18,
-  },
+void checkForCollisionsBetweenAsteroidsAndBorders(void) {
+  Vector2 normalDown = {0, 1};
+  Vector2 normalUp = {0, -1};
+  Vector2 normalRight = {1, 0};
+  Vector2 normalLeft = {-1, 0};
 
-  [THRUSTERS_RIGHT] = {
-    .x = 31,
-    .y = 16,
-    .width = 3,
-    .height = 18,
-  },
-};
+  for (int i = 0; i < world->asteroidsLen; i++) {
+    Circle *circles = colliderCircles(&world->asteroids[i].collider);
 
-int whichThrustersToUse(void) {
-  float angle = playerLookingAngle();
+    for (int j = 0; j < world->asteroids[i].collider.len; j++) {
+      Vector2 pos = circles[j].position;
 
-  /* angle from playerLookingAngle() function is inside of the (-180; 180) range */
+      float r = circles[j].radius;
 
-  if (angle < 0.0f) {
-    angle = 360.0f + angle;
-  }
+      if ((pos.y - r) <= 0) {
+        world->asteroids[i].delta = Vector2Reflect(world->asteroids[i].delta, normalDown);
+        world->asteroids[i].launchedByPlayer = false;
+        break;
+      }
 
-  angle = Clamp(angle, 0.0f, 360.0f);
+      if ((pos.x - r) <= 0) {
+        world->asteroids[i].delta = Vector2Reflect(world->asteroids[i].delta, normalRight);
+        world->asteroids[i].launchedByPlayer = false;
+        break;
+      }
 
-  angle += 45.0f;
+      if ((pos.y + r) >= LEVEL_HEIGHT - 1) {
+        world->asteroids[i].delta = Vector2Reflect(world->asteroids[i].delta, normalUp);
+        world->asteroids[i].launchedByPlayer = false;
+        break;
+      }
 
-  if (angle >= 360.0f) {
-    angle = angle - 360.0f;
+      if ((pos.x + r) >= LEVEL_WIDTH - 1) {
+        world->asteroids[i].delta = Vector2Reflect(world->asteroids[i].delta, normalLeft);
+        world->asteroids[i].launchedByPlayer = false;
+        break;
+      }
+    }
   }
+}
 
-  Direction facing = 0;
+void updateAsteroids(void) {
+  checkForCollisionsBetweenAsteroids();
 
-  if (angle >= 0.0f && angle <= 90.0f) {
-    facing = DIRECTION_UP;
-  } else if (angle >= 90.0f && angle <= 180.0f) {
-    facing = DIRECTION_RIGHT;
-  } else if (angle >= 180.0f && angle <= 270.0f) {
-    facing = DIRECTION_DOWN;
-  } else {
-    facing = DIRECTION_LEFT;
-  }
+  for (int i = 0; i < world->asteroidsLen; i++) {
+    if (world->asteroids[i].angleDelta != 0.0f) {
+      world->asteroids[i].position = stepVector2(world->asteroids[i].position, world->asteroids[i].delta);
 
-  int thrusters = 0;
+      float properAngle = world->asteroids[i].angle + 180;
+      world->asteroids[i].angle = mod(properAngle + (world->asteroids[i].angleDelta * frameSteps()), 360) - 180;
 
-#define THRUST_RULES                            \
-  do {                                          \
-    X(UP, UP, BOTTOM);                          \
-    X(UP, LEFT, RIGHT);                         \
-    X(UP, DOWN, TOP);                           \
-    X(UP, RIGHT, LEFT);                         \
-                                                \
-    X(LEFT, UP, LEFT);                          \
-    X(LEFT, LEFT, BOTTOM);                      \
-    X(LEFT, DOWN, RIGHT);                       \
-    X(LEFT, RIGHT, TOP);                        \
-                                                \
-    X(DOWN, UP, TOP);                           \
-    X(DOWN, LEFT, LEFT);                        \
-    X(DOWN, DOWN, BOTTOM);                      \
-    X(DOWN, RIGHT, RIGHT);                      \
-                                                \
-    X(RIGHT, UP, RIGHT);                        \
-    X(RIGHT, LEFT, TOP);                        \
-    X(RIGHT, DOWN, LEFT);                       \
-    X(RIGHT, RIGHT, BOTTOM);                    \
-  } while (0)
+      asteroidUpdateBoundingCircles(i);
+    } else {
+      moveAsteroid(i, Vector2Scale(world->asteroids[i].delta, frameSteps()));
+    }
+  }
 
-#define X(f, m, t) if (facing == DIRECTION_##f && player.movementDirection & DIRECTION_##m) thrusters |= THRUSTERS_##t
+  checkForCollisionsBetweenAsteroidsAndBorders();
+}
 
-  THRUST_RULES;
+Projectile *push_projectile(void) {
+  int i = spawnEntity(&world->projectiles, projectilesCapacity);
 
-#undef X
-#undef THRUST_RULES
+  if (i < 0) {
+    return NULL;
+  }
 
-  return thrusters;
+  return &world->projectiles.items[i];
 }
 
-void renderThrusters(int thrusters) {
-  Color a = Fade(WHITE, 0.85f);
 
-  if (thrusters & THRUSTERS_BOTTOM) {
-    DrawTexturePro(sprites,
-                   thrustersRects[THRUSTERS_BOTTOM],
-                   (Rectangle) {
-                     .x = 0,
-                     .y = 14,
-                     .width = thrustersRects[THRUSTERS_BOTTOM].width,
-                     .height = thrustersRects[THRUSTERS_BOTTOM].height,
-                   },
-                   Vector2Zero(),
-                   0,
-                   a);
-  }
+static Vector2 screenMouseLocation = {0};
 
-  if (thrusters & THRUSTERS_TOP) {
-    DrawTexturePro(sprites,
-                   thrustersRects[THRUSTERS_TOP],
-                   (Rectangle) {
-                     .x = 0,
-                     .y = 0,
-                     .width = thrustersRects[THRUSTERS_TOP].width,
-                     .height = thrustersRects[THRUSTERS_TOP].height,
-                   },
-                   Vector2Zero(),
-                   0,
-                   a);
-  }
+float playerLookingAngle(void) {
+  static const Vector2 up = {
+    .x = 0,
+    .y = -1,
+  };
 
+  float angle = Vector2Angle(up, world->lookingDirection) * RAD2DEG;
 
-  if (thrusters & THRUSTERS_LEFT) {
-    DrawTexturePro(sprites,
-                   thrustersRects[THRUSTERS_LEFT],
-                   (Rectangle) {
-                     .x = 0,
-                     .y = 0,
-                     .width = thrustersRects[THRUSTERS_LEFT].width,
-                     .height = thrustersRects[THRUSTERS_LEFT].height,
-                   },
-                   Vector2Zero(),
-                   0,
-                   a);
+  return angle;
+}
+
+void bossStealHealth(int bossHealth, int bossMaxHealth) {
+  if ((world->playerPerks & PERK_VAMPIRISM) == 0) {
+    return;
   }
 
-  if (thrusters & THRUSTERS_RIGHT) {
-    DrawTexturePro(sprites,
-                   thrustersRects[THRUSTERS_RIGHT],
-                   (Rectangle) {
-                     .x = 14,
-                     .y = 0,
-                     .width = thrustersRects[THRUSTERS_RIGHT].width,
-                     .height = thrustersRects[THRUSTERS_RIGHT].height,
-                   },
-                   Vector2Zero(),
-                   0,
-                   a);
+  int maxHealthToSteal = (MAX_PLAYER_HEALTH / 2);
+  int bossHealthChunk = bossMaxHealth / maxHealthToSteal;
+  int currentAmountOfChunks = bossHealth / bossHealthChunk;
+
+  if ((currentAmountOfChunks + world->player.healthStolen) < maxHealthToSteal) {
+    world->player.health = (int)Clamp(world->player.health + 1, 0, MAX_PLAYER_HEALTH);
+    world->player.healthStolen += 1;
+    world->player.healTimer = 1.0f;
+    playSound(playerHealSound);
   }
 }
 
-typedef struct {
-  RenderTexture2D texture;
-  float alpha;
-  Vector2 origin;
-  float angle;
-} ThrusterTrail;
+void bossMarineStealHealth(void) {
+  bossStealHealth(world->bossMarine.health, BOSS_MARINE_MAX_HEALTH);
+}
 
-#define THRUSTER_TRAILS_MAX 10
-static ThrusterTrail thrusterTrail[THRUSTER_TRAILS_MAX] = {0};
+void bossBallStealHealth(void) {
+  bossStealHealth(world->bossBall.health, BOSS_BALL_MAX_HEALTH);
+}
 
-ThrusterTrail *pushThrusterTrail() {
-  for (int i = 0; i < THRUSTER_TRAILS_MAX; i++) {
-    if (thrusterTrail[i].alpha <= 0.0f) {
-      return &thrusterTrail[i];
-    }
-  }
+void bossMarineCheckCollisions(bool sendAsteroidsFlying) {
+  collisionWorldBuild(COLLISION_LAYER_ASTEROID | COLLISION_LAYER_PLAYER);
 
-  return NULL;
-}
+  Collider marine = compoundCollider(COLLIDER_BOSS_MARINE, 0, COLLISION_LAYER_BOSS, &world->bossMarine.collider);
+  size_t scratch = scratchBegin();
+  ContactList contacts = worldContacts();
+  collisionWorldQuery(&marine, COLLISION_LAYER_ASTEROID | COLLISION_LAYER_PLAYER, &contacts);
 
-static Shader dashResetShader = {0};
-static int dashResetShaderAlpha = 0;
-static int dashResetShaderColor = 0;
+  bool auraTouching = false;
 
-void renderPlayerTexture(void) {
-  int thrusters = whichThrustersToUse();
+  for (int c = 0; c < contacts.len; c++) {
+    const Contact *contact = &contacts.items[c];
+    const Collider *other = contactCollider(contact);
 
-  {
-    float t = GetTime();
+    switch (other->owner) {
+    case COLLIDER_ASTEROID: {
+      int ai = other->index;
 
-    BeginTextureMode(playerAuraTexture); {
-      ClearBackground(BLANK);
+      if (world->asteroids[ai].launchedByPlayer) {
+#define ASTEROID_BASE_DAMAGE 4
+        float damageMultiplier = Vector2Length(world->asteroids[ai].delta);
+        world->bossMarine.health = (int)Clamp(world->bossMarine.health - (damageMultiplier * ASTEROID_BASE_DAMAGE),
+                                              0.0f,
+                                              BOSS_MARINE_MAX_HEALTH);
+        bossMarineStealHealth();
+        world->asteroids[ai].launchedByPlayer = false;
+      }
 
-      SetShaderValue(playerAuraShader,
-                     playerAuraTime,
-                     &t,
-                     SHADER_UNIFORM_FLOAT);
+      moveAsteroid(ai, contact->push);
+      if (sendAsteroidsFlying) {
+        world->asteroids[ai].delta = Vector2Add(world->asteroids[ai].delta, Vector2Scale(contact->push, 0.5));
+      }
+    } break;
+    case COLLIDER_PLAYER: {
+      world->player.position = Vector2Add(world->player.position, contact->push);
+      collisionWorldMove(contact->collider, contact->push);
 
-      BeginShaderMode(playerAuraShader); {
-        DrawTexturePro(sprites,
-                       playerAuraRect,
-                       (Rectangle) {0, 0, PLAYER_AURA_WIDTH, PLAYER_AURA_HEIGHT},
-                       Vector2Zero(),
-                       0,
-                       WHITE);
-      }; EndShaderMode();
-    }; EndTextureMode();
+      if (world->playerPerks & PERK_OMINOUS_AURA &&
+          world->player.isInvincible) {
+        auraTouching = true;
+      }
+    } break;
+    default: break;
+    }
   }
 
-  float health = (float)player.health / (float)MAX_PLAYER_HEALTH;
+  /* NOTE: a point of health per reference frame of contact, however many ticks that is */
+  if (auraTouching) {
+    world->bossMarine.auraDamage += frameSteps();
 
-  BeginTextureMode(playerTexture1); {
-    ClearBackground(BLANK);
+    int damage = (int)world->bossMarine.auraDamage;
+    world->bossMarine.health -= damage;
+    world->bossMarine.auraDamage -= damage;
+  }
 
-    DrawTexturePro(sprites,
-                   playerRect,
-                   (Rectangle) {
-                     .x = 0,
-                     .y = 0,
-                     .width = playerRect.width,
-                     .height = playerRect.height,
-                   },
-                   Vector2Zero(),
-                   0,
-                   WHITE);
+  scratchEnd(scratch);
+}
 
-    SetShaderValue(playerHealthOverlayShader,
-                   playerHealthOverlayHealth,
-                   &health,
-                   SHADER_UNIFORM_FLOAT);
+void bossMarineUpdateWeapon(void) {
+  Vector2 weaponOffset = (Vector2) {
+    .x = world->bossMarine.horizontalFlip * world->bossMarine.weaponOffset.x,
+    .y = world->bossMarine.weaponOffset.y,
+  };
 
-    BeginShaderMode(playerHealthOverlayShader); {
-      DrawTexture(playerHealthMaskTexture,
-                  1, 1,
-                  WHITE);
-    } EndShaderMode();
-  } EndTextureMode();
-
-  BeginTextureMode(playerTexture2); {
-    ClearBackground(BLANK);
+  world->bossMarine.weaponAngle =
+    angleBetweenPoints(Vector2Add(world->bossMarine.position,
+                                  weaponOffset),
+                       world->player.position) - 90;
+  if (world->bossMarine.horizontalFlip == -1) {
+    world->bossMarine.weaponAngle += 180;
+  }
 
-    SetShaderValue(playerHealthBarShader,
-                   playerHealthBarHealth,
-                   &health,
-                   SHADER_UNIFORM_FLOAT);
+  world->bossMarine.weaponAngle += world->bossMarine.weaponAngleOffset;
 
-    SetShaderValue(playerHealthBarShader,
-                   playerHealthBarHealTimer,
-                   &player.healTimer,
-                   SHADER_UNIFORM_FLOAT);
+  Vector2 bulletOrigin = Vector2Rotate((Vector2) {
+      .x = world->bossMarine.horizontalFlip * ((bossMarineWeaponRect.width / 2) * SPRITES_SCALE),
+      .y = -6 * SPRITES_SCALE,
+    }, world->bossMarine.weaponAngle * DEG2RAD);
+  world->bossMarine.bulletOrigin = Vector2Add(weaponOffset, bulletOrigin);
+}
 
-    BeginShaderMode(playerHealthBarShader); {
-      DrawTexture(playerTexture1.texture,
-                  0, 0,
-                  WHITE);
-    }; EndShaderMode();
-  }; EndTextureMode();
+void bossMarineWalk(void) {
+  float playerBossAngle = angleBetweenPoints(world->player.position,
+                                             world->bossMarine.position);
+#define BOSS_MARINE_SPEED 4
+#define BOSS_MARINE_MIN_PLAYER_DISTANCE 200
+#define BOSS_MARINE_MAX_PLAYER_DISTANCE 400
 
-  BeginTextureMode(playerTexture); {
-    ClearBackground(BLANK);
+  float playerBossDistance = Vector2Distance(world->player.position,
+                                             world->bossMarine.position);
 
-    SetShaderValue(dashResetShader,
-                   dashResetShaderAlpha,
-                   &player.dashReactivationEffectAlpha,
-                   SHADER_UNIFORM_FLOAT);
+  Vector2 delta = Vector2Rotate((Vector2) {0, -BOSS_MARINE_SPEED},
+                                playerBossAngle * DEG2RAD);
 
-    BeginShaderMode(dashResetShader); {
-      DrawTexture(playerTexture1.texture,
-                  0, 0,
-                  WHITE);
-    } EndShaderMode();
+  if (playerBossDistance < BOSS_MARINE_MIN_PLAYER_DISTANCE) {
+    world->bossMarine.position = stepVector2(world->bossMarine.position, Vector2Scale(delta, 2));
+  } else if (playerBossDistance > BOSS_MARINE_MAX_PLAYER_DISTANCE && world->bossMarine.isWalking) {
+    world->bossMarine.position = stepVector2(world->bossMarine.position, Vector2Scale(delta, -1));
+  } else if (world->bossMarine.isWalking) {
+    float angle = world->bossMarine.walkingDirection * BOSS_MARINE_SPEED * frameSteps();
+    Vector2 diff = Vector2Subtract(world->bossMarine.position, world->player.position);
+    diff = Vector2Rotate(diff, angle * DEG2RAD);
+    world->bossMarine.position = dampVector2(world->bossMarine.position, Vector2Add(diff, world->player.position), 0.1f);
+  }
+}
 
-    renderThrusters(thrusters);
-  } EndTextureMode();
+#define BOSS_MARINE_BASE_DAMAGE 1
+#define BOSS_MARINE_PROJECTILE_RADIUS 13
+#define BOSS_MARINE_PROJECTILE_SPEED 25.0f
 
-  if (thrusters == 0) {
+void bossMarineShoot(float speedMultiplier,
+                     float cooldown,
+                     float spread,
+                     Sound *sound,
+                     float lifetime,
+                     bool willBounce,
+                     Color inside,
+                     Color outside) {
+  if (world->bossMarine.fireCooldown > 0.0f) {
     return;
   }
 
-  ThrusterTrail *t = pushThrusterTrail();
+  Projectile *new_projectile = push_projectile();
 
-  if (t == NULL) {
+  if (new_projectile == NULL) {
     return;
   }
 
-  BeginTextureMode(t->texture); {
-    ClearBackground(BLANK);
-
-    renderThrusters(thrusters);
-  } EndTextureMode();
+  *new_projectile = (Projectile) {
+    .type = PROJECTILE_REGULAR,
+    .hurts = BOSS_PROJECTILE_HURTS,
+    .damage = BOSS_MARINE_BASE_DAMAGE,
+    .origin = Vector2Add(world->bossMarine.position, world->bossMarine.bulletOrigin),
+    .radius = BOSS_MARINE_PROJECTILE_RADIUS,
+    .delta = Vector2Rotate(Vector2Scale((Vector2) {world->bossMarine.horizontalFlip, 0}, BOSS_MARINE_PROJECTILE_SPEED * speedMultiplier),
+                           (world->bossMarine.weaponAngle + spread) * DEG2RAD),
+    .angle = 0,
+    .inside = inside,
+    .outside = outside,
+    .lifetime = lifetime,
+    .canBounce = willBounce,
+  };
+  world->bossMarine.fireCooldown = cooldown;
 
-  t->angle = playerLookingAngle();
-  t->alpha = 1.0f;
-  t->origin = player.position;
+  if (sound) {
+    playSound(*sound);
+  }
 }
 
-void renderPlayer(void) {
-  float alpha = 1.0;
 
-  if (player.iframeTimer > 0.0f) {
-    float a = sinf(GetTime() * 40) * .5 + 1.;
-    alpha = Remap(a, 0, 1, 0.7, 1.0);
-  }
+void bossMarineAttack(void) {
+  world->bossMarine.attackTimer -= simulationFrameTime();
+  world->bossMarine.fireCooldown -= simulationFrameTime();
 
-  if (playerPerks & PERK_OMINOUS_AURA) {
-    DrawTexturePro(playerAuraTexture.texture,
-                   (Rectangle) {
-                     .x = 0,
-                     .y = 0,
-                     .width  = playerAuraTexture.texture.width,
-                     .height = -playerAuraTexture.texture.height,
-                   },
-                   (Rectangle) {
-                     .x = player.position.x,
-                     .y = player.position.y,
-                     .width  = playerAuraTexture.texture.width,
-                     .height = playerAuraTexture.texture.height,
-                   },
-                   (Vector2) {
-                     .x = 0.5f * playerAuraTexture.texture.width,
-                     .y = 0.5f * playerAuraTexture.texture.height,
-                   },
-                   playerLookingAngle(),
-                   WHITE);
-  }
+  if (world->bossMarine.attackTimer <= 0.0f) {
+    world->bossMarine.isWalking = (bool)randomValue(0, 1);
 
-  DrawTexturePro(playerTexture.texture,
-                 (Rectangle) {
-                   .x = 0,
-                   .y = 0,
-                   .width = playerTexture.texture.width,
-                   .height = playerTexture.texture.height,
-                 },
-                 (Rectangle) {
-                   .x = player.position.x,
-                   .y = player.position.y,
-                   .width = playerTexture.texture.width * SPRITES_SCALE,
-                   .height = playerTexture.texture.height * SPRITES_SCALE,
-                 },
-                 (Vector2) {
-                   .x = (playerRect.width * SPRITES_SCALE) / 2,
-                   .y = (playerRect.height * SPRITES_SCALE) / 2,
-                 },
-                 playerLookingAngle(),
-                 ColorAlpha(WHITE, alpha));
-}
+    if (world->bossMarine.currentAttack == BOSS_MARINE_NOT_SHOOTING) {
+      BossMarineAttack a = 0;
+      do {
+        a = randomValue(BOSS_MARINE_SINUS_SHOOTING,
+                           BOSS_MARINE_BOUNCING_WAVES);
+      } while (a == world->bossMarineLastAttack);
+      world->bossMarineLastAttack = a;
+      world->bossMarine.currentAttack = a;
 
-void renderDashTrails(void) {
-  Vector4 color = ColorNormalize(SKYBLUE);
+      world->bossMarine.attackTimer = (float)randomValue(3, 7);
+    } else {
+      world->bossMarine.currentAttack = BOSS_MARINE_NOT_SHOOTING;
+      world->bossMarine.attackTimer = (float)randomValue(1, 10) / 10.0f;
+    }
 
-  if (playerPerks & PERK_STRONG_DASH) {
-    color = ColorNormalize(RED);
+    world->bossMarine.weaponAngleOffset = 0;
   }
 
-  SetShaderValue(dashTrailShader,
-                 dashTrailShaderColor,
-                 &color,
-                 SHADER_UNIFORM_VEC4);
+  switch (world->bossMarine.currentAttack) {
+  case BOSS_MARINE_SINUS_SHOOTING: {
+    world->bossMarine.weaponAngleOffset = sin(simulationTime() * 4) * 30 * world->bossMarine.horizontalFlip;
+    bossMarineUpdateWeapon();
 
-  for (int i = 0; i < PLAYER_DASH_TRAILS_MAX; i++) {
-    if (dashTrails[i].alpha <= 0) {
-      continue;
+    bossMarineShoot(0.3f, 0.04f, 0, &bossMarineGunshotSound, 10, false, MAROON, GOLD);
+  } break;
+  case BOSS_MARINE_NOT_SHOOTING: {
+    bossMarineUpdateWeapon();
+  } break;
+  case BOSS_MARINE_SHOOTING: {
+    bossMarineUpdateWeapon();
+    bossMarineShoot(0.5f, 0.06f, (float)randomValue(-30, 30), &bossMarineGunshotSound, 10, false, MAROON, GOLD);
+  } break;
+  case BOSS_MARINE_SHOTGUNNING: {
+    bossMarineUpdateWeapon();
+
+    if (world->bossMarine.fireCooldown > 0.0f) {
+      break;
     }
 
-    float w = playerRect.width * SPRITES_SCALE;
-    float h = playerRect.height * SPRITES_SCALE;
+    for (int i = 0; i < 30; i++) {
+      (void) i;
 
-    SetShaderValue(dashTrailShader,
-                   dashTrailShaderAlpha,
-                   &dashTrails[i].alpha,
-                   SHADER_UNIFORM_FLOAT);
+      float spread = (float)randomValue(-30, 30);
+      float speed = (float)randomValue(5, 10) / 10.0f * 0.8f;
 
-    BeginShaderMode(dashTrailShader); {
-      DrawTexturePro(sprites,
-                     playerRect,
-                     (Rectangle) {
-                       .x = dashTrails[i].position.x,
-                       .y = dashTrails[i].position.y,
-                       .width = w,
-                       .height = h,
-                     },
-                     (Vector2) {w / 2, h / 2},
-                     dashTrails[i].angle,
-                     WHITE);
-    }; EndShaderMode();
-  }
-}
+      Projectile *new_projectile = push_projectile();
 
-void renderThrusterTrails(void) {
-  for (int i = 0; i < THRUSTER_TRAILS_MAX; i++) {
-    if (thrusterTrail[i].alpha <= 0.0f) {
-      continue;
+      if (new_projectile == NULL) {
+        return;
+      }
+
+      *new_projectile = (Projectile) {
+        .type = PROJECTILE_SQUARED,
+        .hurts = BOSS_PROJECTILE_HURTS,
+        .damage = BOSS_MARINE_BASE_DAMAGE,
+        .origin = Vector2Add(world->bossMarine.position, world->bossMarine.bulletOrigin),
+        .size = (Vector2) {
+          .x = BOSS_MARINE_PROJECTILE_RADIUS * 2,
+          .y = BOSS_MARINE_PROJECTILE_RADIUS * 4,
+        },
+        .delta = Vector2Rotate(Vector2Scale((Vector2) {world->bossMarine.horizontalFlip, 0},
+                                            BOSS_MARINE_PROJECTILE_SPEED * speed),
+                               (world->bossMarine.weaponAngle + spread) * DEG2RAD),
+        .angle = (world->bossMarine.weaponAngle + spread + 90),
+        .inside = MAROON,
+        .outside = GOLD,
+        .lifetime = 5.0f,
+        .canBounce = false,
+      };
     }
 
-    DrawTexturePro(thrusterTrail[i].texture.texture,
-                   (Rectangle) {
-                     .x = 0,
-                     .y = 0,
-                     .width = thrusterTrail[i].texture.texture.width,
-                     .height = -thrusterTrail[i].texture.texture.height,
-                   },
-                   (Rectangle) {
-                     .x = thrusterTrail[i].origin.x,
-                     .y = thrusterTrail[i].origin.y,
-                     .width = thrusterTrail[i].texture.texture.width * SPRITES_SCALE,
-                     .height = thrusterTrail[i].texture.texture.height * SPRITES_SCALE,
-                   },
-                   (Vector2) {
-                     .x = (playerRect.width * SPRITES_SCALE) / 2,
-                     .y = (playerRect.height * SPRITES_SCALE) / 2,
-                   },
-                   thrusterTrail[i].angle,
-                   Fade(WHITE, thrusterTrail[i].alpha));
-  }
-}
+    playSound(bossMarineShotgunSound);
+    world->bossMarine.fireCooldown = (float)randomValue(5, 10) / 10.0f;
 
-void updateThrusterTrails(void) {
-  for (int i = 0; i < THRUSTER_TRAILS_MAX; i++) {
-    if (thrusterTrail[i].alpha <= 0.0f) {
-      continue;
+  } break;
+  case BOSS_MARINE_BOUNCING_WAVES: {
+    bossMarineUpdateWeapon();
+
+    if (world->bossMarine.fireCooldown > 0.0f) {
+      break;
     }
 
-    thrusterTrail[i].alpha = Clamp(thrusterTrail[i].alpha - 0.2f, 0.0f, 1.0f);
-  }
-}
+    for (int i = -40; i < 40; i += 2) {
+      float spread = (float)i;
 
-#define MOUSE_CURSOR_SCALE (SPRITES_SCALE)
-void renderMouseCursor(void) {
-  DrawTexturePro(sprites,
-                 mouseCursorRect,
-                 (Rectangle) {
-                   .x = screenMouseLocation.x,
-                   .y = screenMouseLocation.y,
-                   .width = mouseCursorRect.width * MOUSE_CURSOR_SCALE,
-                   .height = mouseCursorRect.height * MOUSE_CURSOR_SCALE,
-                 },
-                 (Vector2) {
-                   .x = (mouseCursorRect.width * MOUSE_CURSOR_SCALE) / 2,
-                   .y = (mouseCursorRect.height * MOUSE_CURSOR_SCALE) / 2,
-                 }, 0, WHITE);
+      bossMarineShoot(0.7f,
+                      0,
+                      spread,
+                      NULL,
+                      4.0f,
+                      true,
+                      GOLD,
+                      MAROON);
+    }
+
+    playSound(bossMarineShotgunSound);
+    world->bossMarine.fireCooldown = (float)randomValue(7, 10) / 10.0f;
+  } break;
+  };
 }
 
-#define PROJECTILE_BORDER 3
+#define BOSS_MARINE_SHAPE(flip) ((flip) < 0 ? 0 : 1)
 
-void renderProjectiles(void) {
-  for (int i = 0; i < PROJECTILES_MAX; i++) {
-    float radiusScale = projectiles[i].willBeDestroyed ? 1.5f : 1.0f;
+void bossMarineUpdateBoundingCircles(void) {
+  world->bossMarine.collider.first = WORLD_CIRCLES_BOSS_MARINE;
 
-    switch (projectiles[i].type) {
-    case PROJECTILE_NONE: break;
-    case PROJECTILE_REGULAR: {
-      DrawCircleV(projectiles[i].origin,
-                  projectiles[i].radius * radiusScale,
-                  projectiles[i].outside);
+  syncCompoundCollider(&world->bossMarine.collider,
+                       world->bossMarine.position,
+                       &world->bossMarine.shapes[BOSS_MARINE_SHAPE(world->bossMarine.horizontalFlip)]);
+}
 
-      if (projectiles[i].willBeDestroyed) {
-        break;
-      }
+void updateBossMarine(void) {
+  if (world->bossMarine.health <= 0) {
+    pauseMusic(bossMarineMusic);
+    world->playerStats.kills += 1;
+    world->gameState = GAME_BOSS_DEAD;
+
+    for (int i = 0; i < world->projectiles.pool.len; i++) {
+      world->projectiles.items[i].willBeDestroyed = true;
+      world->projectiles.items[i].destructionTimer = 0.02f;
+    }
+    return;
+  }
 
-      DrawCircleV(projectiles[i].origin,
-                  projectiles[i].radius - PROJECTILE_BORDER,
-                  projectiles[i].inside);
-    } break;
-    case PROJECTILE_SQUARED: {
-      Rectangle shape = (Rectangle) {
-        .x = projectiles[i].origin.x,
-        .y = projectiles[i].origin.y,
-        .width = projectiles[i].size.x * radiusScale,
-        .height = projectiles[i].size.y * radiusScale,
-      };
+  world->bossMarine.horizontalFlip =
+    (world->player.position.x < world->bossMarine.position.x)
+    ? -1
+    : 1;
 
-      DrawRectanglePro(shape,
-                       (Vector2) {
-                         .x = shape.width / 2,
-                         .y = shape.height / 2,
-                       },
-                       projectiles[i].angle,
-                       projectiles[i].outside);
+  bossMarineUpdateBoundingCircles();
 
-      if (projectiles[i].willBeDestroyed) {
-        break;
-      }
+  bossMarineCheckCollisions(true);
+  bossMarineWalk();
 
-      shape.width -= PROJECTILE_BORDER * 2;
-      shape.height -= PROJECTILE_BORDER * 2;
+  bossMarineAttack();
 
-      DrawRectanglePro(shape,
-                       (Vector2) {
-                         .x = shape.width / 2,
-                         .y = shape.height / 2,
-                       },
-                       projectiles[i].angle,
-                       projectiles[i].inside);
-    } break;
-    }
-  }
+  Vector2 minPos = Vector2Scale((Vector2){bossMarineRect.width / 2, bossMarineRect.width / 2},
+                                SPRITES_SCALE);
+  Vector2 maxPos = Vector2Subtract((Vector2) {LEVEL_WIDTH, LEVEL_HEIGHT},
+                                   minPos);
+  world->bossMarine.position = Vector2Clamp(world->bossMarine.position, minPos, maxPos);
+
+  syncCompoundCollider(&world->bossMarine.collider,
+                       world->bossMarine.position,
+                       &world->bossMarine.shapes[BOSS_MARINE_SHAPE(world->bossMarine.horizontalFlip)]);
 }
 
-Vector2 arenaTopLeft = {0};
-Vector2 arenaBottomRight = {0};
 
-void renderArenaBorder(void) {
-  float t = GetTime();
+static bool autopilot = false;
 
-  SetShaderValue(arenaBorderShader,
-                 arenaBorderTime,
-                 &t,
-                 SHADER_UNIFORM_FLOAT);
+static int localShip = 0;
 
-  Vector2 arenaSize = Vector2Subtract(arenaBottomRight, arenaTopLeft);
-  BeginShaderMode(arenaBorderShader); {
-    DrawRectangleV(arenaTopLeft,
-                   arenaSize,
-                   BLUE);
-  } EndShaderMode();
-}
+void updateMouse(void) {
+  if (autopilot) {
+    world->mouseCursor = world->playerInput.aim;
+    screenMouseLocation = GetWorldToScreen2D(world->mouseCursor, camera);
 
-void renderAsteroids(void) {
-  for (int i = 0; i < asteroidsLen; i++) {
-    Vector2 center = {
-      .x = (asteroids[i].sprite->textureRect.width * SPRITES_SCALE) / 2,
-      .y = (asteroids[i].sprite->textureRect.height * SPRITES_SCALE) / 2,
-    };
-
-    DrawTexturePro(sprites,
-                   asteroids[i].sprite->textureRect,
-                   (Rectangle) {
-                     .x = asteroids[i].position.x,
-                     .y = asteroids[i].position.y,
-                     .width = asteroids[i].sprite->textureRect.width * SPRITES_SCALE,
-                     .height = asteroids[i].sprite->textureRect.height * SPRITES_SCALE,
-                   },
-                   center,
-                   asteroids[i].angle,
-                   WHITE);
+    if (!world->coop) {
+      world->lookingDirection = Vector2Normalize(Vector2Subtract(world->mouseCursor, world->player.position));
+    }
+    return;
   }
-}
-
-void renderBackgroundAsteroid(void) {
-  Vector2 center = {
-    .x = (bigAssAsteroidRect.width * BIG_ASS_ASTEROID_SCALE) / 2,
-    .y = (bigAssAsteroidRect.height * BIG_ASS_ASTEROID_SCALE) / 2,
-  };
-
-  DrawTexturePro(sprites,
-                 bigAssAsteroidRect,
-                 (Rectangle) {
-                   .x = bigAssAsteroidPosition.x,
-                   .y = bigAssAsteroidPosition.y,
-                   .width = bigAssAsteroidRect.width * BIG_ASS_ASTEROID_SCALE,
-                   .height = bigAssAsteroidRect.height * BIG_ASS_ASTEROID_SCALE,
-                 },
-                 center,
-                 bigAssAsteroidAngle,
-                 GRAY);
-}
-
-/* code stolen from the `GetMouseRay` function, because it assumes window size */
-Ray traceRay(Vector2 pos, Camera camera) {
-  Ray ray = { 0 };
-
-  float x = (2.0f*pos.x)/(float)LEVEL_WIDTH - 1.0f;
-  float y = 1.0f - (2.0f*pos.y)/(float)LEVEL_HEIGHT;
-  float z = 1.0f;
-
-  Vector3 deviceCoords = { x, y, z };
-
-  Matrix matView = MatrixLookAt(camera.position, camera.target, camera.up);
-  Matrix matProj = MatrixIdentity();
 
-  matProj = MatrixPerspective(camera.fovy*DEG2RAD, ((double)LEVEL_WIDTH/(double)LEVEL_HEIGHT), RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
-
-  Vector3 nearPoint = Vector3Unproject((Vector3){ deviceCoords.x, deviceCoords.y, 0.0f }, matProj, matView);
-  Vector3 farPoint = Vector3Unproject((Vector3){ deviceCoords.x, deviceCoords.y, 1.0f }, matProj, matView);
-
-  Vector3 direction = Vector3Normalize(Vector3Subtract(farPoint, nearPoint));
-
-  ray.position = camera.position;
-  ray.direction = direction;
-
-  return ray;
-}
-
-void renderBossBall(void) {
-  const float pixelSize = 4.0;
-
-  SetShaderValue(pixelationShader,
-                 pixelationShaderPixelSize,
-                 &pixelSize,
-                 SHADER_UNIFORM_FLOAT);
-
-  BeginShaderMode(pixelationShader); {
-    DrawTextureRec(bossBallTarget.texture,
-                   (Rectangle) {
-                     0, 0,
-                     bossBallTarget.texture.width, -bossBallTarget.texture.height
-                   },
-                   Vector2Zero(),
-                   WHITE);
-  } EndShaderMode();
-}
+  if (IsCursorHidden()) {
+    Vector2 delta =
+      Vector2Multiply(GetMouseDelta(),
+                      (Vector2) {
+                        .x = MOUSE_SENSITIVITY,
+                        .y = MOUSE_SENSITIVITY,
+                      });
+    screenMouseLocation = Vector2Add(screenMouseLocation, delta);
 
-void renderBossBallWeapon(int i, float angle) {
-  Rectangle r = bossBallWeaponRects[bossBall.weapons[i].type];
+    screenMouseLocation.x = Clamp(screenMouseLocation.x,
+                                  0.0f,
+                                  GetScreenWidth());
 
-  Color color = ColorFromHSV(0, 0, bossBall.weapons[i].deactivationDark);
+    screenMouseLocation.y = Clamp(screenMouseLocation.y,
+                                  0.0f,
+                                  GetScreenHeight());
+  }
 
-  DrawTexturePro(sprites,
-                 r,
-                 (Rectangle) {
-                   .x = bossBall.weapons[i].position.x,
-                   .y = bossBall.weapons[i].position.y,
-                   .width = r.width * SPRITES_SCALE,
-                   .height = r.height * SPRITES_SCALE,
-                 },
-                 (Vector2) {
-                   .x = (r.width * SPRITES_SCALE) * 0.5f,
-                   .y = (r.height * SPRITES_SCALE) * 0.5f,
-                 },
-                 angle,
-                 color);
+  world->mouseCursor = GetScreenToWorld2D(screenMouseLocation, camera);
 
-  if (bossBall.weapons[i].type == BOSS_BALL_WEAPON_LASER) {
-    DrawTexturePro(sprites,
-                   bossBallChargedLaserRect,
-                   (Rectangle) {
-                     .x = bossBall.weapons[i].position.x,
-                     .y = bossBall.weapons[i].position.y,
-                     .width = r.width * SPRITES_SCALE,
-                     .height = r.height * SPRITES_SCALE,
-                   },
-                   (Vector2) {
-                     .x = (r.width * SPRITES_SCALE) * 0.5f,
-                     .y = (r.height * SPRITES_SCALE) * 0.5f,
-                   },
-                   angle,
-                   ColorAlpha(color, bossBall.weapons[i].chargeLevel));
+  if (!IsCursorHidden()) {
+    isGamePaused = true;
+    DisableCursor();
   }
-}
 
-void renderBossBallDisconnectedWeapons(void) {
-  for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
-    if (!bossBall.weapons[i].isDisconnected) {
-      continue;
-    }
+#ifdef PLATFORM_DESKTOP
 
-    renderBossBallWeapon(i, bossBall.weapons[i].angle);
+  if (!IsWindowFocused() || IsWindowHidden()) {
+    isGamePaused = true;
   }
-}
 
-void renderBossBallConnectedWeapons(void) {
-  for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
-    if (bossBall.weapons[i].isDisconnected) {
-      continue;
-    }
+#endif
 
-    renderBossBallWeapon(i, bossBall.weapons[i].angle +
-                         bossBall.weapons[i].angleOffset +
-                         bossBall.weaponAngleOffset);
+  /* NOTE: in co-op the ships only turn inside the simulation, towards the aim of their input */
+  if (!world->coop) {
+    world->lookingDirection = Vector2Normalize(Vector2Subtract(world->mouseCursor, world->player.position));
   }
 }
 
-void prerenderBossBall(void) {
-  bossBallUpdateShader();
-
-  Vector3 groundTopLeft = {-50, 0, -50};
-  Vector3 groundBottomLeft = {-50, 0, 50};
-  Vector3 groundBottomRight = {50, 0, 50};
-  Vector3 groundTopRight = {50, 0, -50};
-
-  Ray r = traceRay(bossBall.position, bossBallCamera);
-  RayCollision c = GetRayCollisionQuad(r, groundTopLeft, groundBottomLeft, groundBottomRight, groundTopRight);
+#define PLAYER_DASH_DISTANCE 20
 
-  if (!c.hit || c.distance >= FLOAT_MAX) {
+void tryDashing(void) {
+  if (!world->playerInput.dash ||
+      world->player.dashCooldown > 0.0f) {
     return;
   }
 
-  BeginTextureMode(bossBallTarget); {
-    ClearBackground(BLANK);
+  Vector2 direction = Vector2Normalize(world->player.movementDelta);
 
-    BeginMode3D(bossBallCamera); {
-      DrawModelEx(bossBallModel, c.point, bossBall.rotationAxis, bossBall.angle, Vector3Scale(Vector3One(), 2), WHITE);
-    } EndMode3D();
-  } EndTextureMode();
-}
+  if (direction.x == 0.0f && direction.y == 0.0f) {
+    return;
+  }
 
-void renderBossMarine(void) {
-  Vector2 center = {
-    .x = (bossMarineRect.width * SPRITES_SCALE) / 2,
-    .y = (bossMarineRect.height * SPRITES_SCALE) / 2,
+  static const Vector2 up = {
+    .x = 0,
+    .y = -1,
   };
 
-  Rectangle bossRect = bossMarineRect;
-  bossRect.width *= bossMarine.horizontalFlip;
-  Rectangle weaponRect = bossMarineWeaponRect;
-  weaponRect.width *= bossMarine.horizontalFlip;
+  float dashAngle = Vector2Angle(up, direction);
 
-  DrawTexturePro(sprites,
-                 bossRect,
-                 (Rectangle) {
-                   .x = bossMarine.position.x,
-                   .y = bossMarine.position.y,
-                   .width = bossMarineRect.width * SPRITES_SCALE,
-                   .height = bossMarineRect.height * SPRITES_SCALE,
-                 },
-                 center,
-                 0,
-                 WHITE);
+  float distance = PLAYER_DASH_DISTANCE;
+  if (world->playerPerks & PERK_STRONG_DASH) {
+    distance *= 1.5;
+  }
 
-  Vector2 weaponCenter = {
-    .x = (bossMarineWeaponRect.width * SPRITES_SCALE) / 2,
-    .y = (bossMarineWeaponRect.height * SPRITES_SCALE) / 2,
-  };
+  Vector2 dashDistance = Vector2Scale(up, distance);
 
-  DrawTexturePro(sprites,
-                 weaponRect,
-                 (Rectangle) {
-                   .x = bossMarine.position.x + (bossMarine.weaponOffset.x * bossMarine.horizontalFlip),
-                   .y = bossMarine.position.y + bossMarine.weaponOffset.y,
-                   .width = bossMarineWeaponRect.width * SPRITES_SCALE,
-                   .height = bossMarineWeaponRect.height * SPRITES_SCALE,
-                 },
-                 weaponCenter,
-                 bossMarine.weaponAngle,
-                 WHITE);
-}
+  world->player.dashCooldown = PLAYER_DASH_COOLDOWN;
+  world->player.dashDelta = Vector2Rotate(dashDistance, dashAngle);
+  world->player.isInvincible = true;
 
-void renderBoss(void) {
-  switch (currentBoss) {
-  case BOSS_MARINE: renderBossMarine(); break;
-  case BOSS_BALL: renderBossBall(); break;
-  }
+  playSound(dashSoundEffect);
 }
 
-void renderLaserIntoTexture(void) {
-  float t = GetTime() * 69.0f * 0.5f;
+#define PLAYER_FIRE_COOLDOWN 0.15f
+#define PLAYER_PROJECTILE_RADIUS 9
+#define PLAYER_PROJECTILE_SPEED 30.0f
+#define PLAYER_PROJECTILE_BASE_DAMAGE 4
 
-  SetShaderValue(laserShader,
-                 laserShaderTime,
-                 &t,
-                 SHADER_UNIFORM_FLOAT);
+void tryFiringAShot(void) {
+  if (!world->playerInput.fire ||
+      world->player.fireCooldown > 0.0f ||
+      world->player.dashCooldown > 0.0f) {
+    return;
+  }
 
-  BeginTextureMode(laserTexture); {
-    ClearBackground(BLANK);
+  #define PLAYER_BASE_BULLET_SPREAD 2
+  int spread = 2;
+  if (world->playerPerks & PERK_MORE_SPREAD) {
+    spread = 20;
+  }
 
-    BeginShaderMode(laserShader); {
-      DrawRectangle(0, 0, LASER_WIDTH, LASER_HEIGHT, WHITE);
-    }; EndShaderMode();
-  }; EndTextureMode();
-}
+  int halfSpread = spread / 2;
+  int a = randomValue(-halfSpread, halfSpread);
 
-static float blackBackgroundAlpha = 0;
+  int damage = PLAYER_PROJECTILE_BASE_DAMAGE;
+  float multX = 1.5f;
+  float multY = 3.0f;
+  if (world->playerPerks & PERK_RANDOM_SIZED_BULLETS) {
+    multX = (float)randomValue(10, 20) / 5.0f;
+    multY = (float)randomValue(20, 30) / 5.0f;
 
-void renderLasers(void) {
-  for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
-    if (bossBall.weapons[i].type != BOSS_BALL_WEAPON_LASER) {
-      continue;
-    }
+    float area = multX * multY;
+    damage = ceilf(area / 5.0f);
+  }
 
-    Vector2 pos = Vector2Add(bossBall.weapons[i].position,
-                             bossBall.weapons[i].bulletOrigin);
+  if (world->playerPerks & PERK_LESS_HP_MORE_DAMAGE) {
+    float mult = 1.0f - ((float)world->player.health / MAX_PLAYER_HEALTH);
+    multX += mult;
+    multY += mult;
+  }
 
-    float angle = 0;
-    if (bossBall.weapons[i].isDisconnected) {
-      angle = bossBall.weapons[i].angle;
-    } else {
-      angle = bossBall.weapons[i].angle + bossBall.weapons[i].angleOffset + bossBall.weaponAngleOffset;
-    }
+  if (world->playerPerks & PERK_DOUBLE_DAMAGE) {
+    damage *= 2;
+  }
 
-    angle -= 90;
+  if (world->playerPerks & PERK_LESS_HP_MORE_DAMAGE) {
+    float hp = world->player.health / MAX_PLAYER_HEALTH;
+    hp = 1.0 - hp;
+    damage += damage * hp;
+  }
 
-#define LASER_POINTER_HEIGHT 3.6f
+  float speed = PLAYER_PROJECTILE_SPEED;
+  if (world->playerPerks & PERK_SLOW_BUT_STEADY) {
+    damage *= 2;
+    speed /= 2;
+  }
 
-    if (bossBall.weapons[i].chargeLevel > 0.0f && bossBall.weapons[i].chargeLevel <= 1.0f) {
-      DrawRectanglePro((Rectangle) {pos.x, pos.y, LASER_WIDTH, LASER_POINTER_HEIGHT},
-                       (Vector2) {0, LASER_POINTER_HEIGHT / 2.0f},
-                       angle,
-                       ColorAlpha(RED, bossBall.weapons[i].chargeLevel));
-    } else {
-      DrawTexturePro(laserTexture.texture,
-                     (Rectangle) {0, 0, bossBall.weapons[i].laserLength, LASER_HEIGHT},
-                     (Rectangle) {pos.x, pos.y, bossBall.weapons[i].laserLength, LASER_HEIGHT},
-                     (Vector2) {0, LASER_HEIGHT / 2.0f},
-                     angle,
-                     WHITE);
-    }
+  if (world->playerPerks & PERK_FAST_BULLETS) {
+    speed *= 2;
+  }
 
+  if (world->playerPerks & PERK_GLASS_CANON) {
+    damage *= 5;
   }
-}
 
-void renderParticles(void) {
-  for (int i = 0; i < PARTICLES_MAX; i++) {
-    if (particles[i].lifetime <= 0.0f) {
-      continue;
-    }
+  Color inside = (Color) {82, 85, 156, 255};
+  Color outside = (Color) {57, 60, 115, 255};
 
-    DrawRectanglePro((Rectangle) {particles[i].position.x, particles[i].position.y, SPRITES_SCALE, SPRITES_SCALE},
-                     (Vector2) {SPRITES_SCALE * 0.5f, SPRITES_SCALE * 0.5f},
-                     particles[i].angle,
-                     ColorAlpha(particles[i].color, particles[i].lifetime));
+  if (world->playerPerks & PERK_HOMING) {
+    outside = inside;
+    inside = BLACK;
   }
-}
 
-void renderPhase1(void) {
-  renderPlayerTexture();
+  Vector2 size = {
+    .x = PLAYER_PROJECTILE_RADIUS * multX,
+    .y = PLAYER_PROJECTILE_RADIUS * multY,
+  };
 
-  renderLaserIntoTexture();
+  float angle = playerLookingAngle() + (float)a;
+  Vector2 delta = Vector2Rotate(Vector2Scale(world->lookingDirection, speed),
+                                a * DEG2RAD);
 
-  if (currentBoss == BOSS_BALL) {
-    prerenderBossBall();
-  }
+  if (world->playerPerks & PERK_MORE_BULLETS) {
+    Projectile *newProjectile1 = push_projectile();
+
+    if (newProjectile1 == NULL) {
+      return;
+    }
 
-  preRenderBackground(currentBoss != BOSS_BALL);
+    // Vector2 originCenter = Vector2Add(player.position, Vector2Scale(lookingDirection, 35));
+    Vector2 lookingLeft = Vector2Rotate(world->lookingDirection, -15 * DEG2RAD);
+    Vector2 lookingRight = Vector2Rotate(world->lookingDirection, 15 * DEG2RAD);
 
-  BeginTextureMode(target); {
-    ClearBackground(BLACK);
+    Vector2 origLeft = Vector2Scale(lookingLeft, 55);
+    Vector2 origRight = Vector2Scale(lookingRight, 55);
 
-    renderBackground();
+    Vector2 origin1 = Vector2Add(world->player.position, origLeft);
+    Vector2 origin2 = Vector2Add(world->player.position, origRight);
 
-    if (currentBoss == BOSS_MARINE) {
-      renderBackgroundAsteroid();
-    }
+    Projectile proj = {
+      .type = PROJECTILE_SQUARED,
 
-    if (gameState == GAME_BOSS ||
-        (gameState == GAME_BOSS_INTRODUCTION &&
-         introductionStage != BOSS_INTRODUCTION_BEGINNING)) {
-      renderArenaBorder();
-    }
+      .hurts = PLAYER_PROJECTILE_HURTS,
 
-    renderParticles();
+      .damage = damage,
+      .size = size,
+      .delta = delta,
+      .angle = angle,
 
-    renderAsteroids();
+      .inside = inside,
+      .outside = outside,
+      .lifetime = 10,
+      .canBounce = false,
+    };
 
-    if (gameState == GAME_BOSS_DEAD || gameState == GAME_PLAYER_DEAD) {
-      DrawRectangleV(Vector2Zero(),
-                     level,
-                     ColorAlpha(BLACK, blackBackgroundAlpha));
-    }
+    *newProjectile1 = proj;
+    newProjectile1->origin = origin1;
 
-    renderBoss();
+    Projectile *newProjectile2 = push_projectile();
 
-    if (currentBoss == BOSS_BALL) {
-      renderBossBallDisconnectedWeapons();
+    if (newProjectile2 == NULL) {
+      return;
     }
 
-    renderThrusterTrails();
-    renderDashTrails();
-    renderPlayer();
+    *newProjectile2 = proj;
+    newProjectile2->origin = origin2;
+  } else {
+    Projectile *new_projectile = push_projectile();
 
-    if (currentBoss == BOSS_BALL) {
-      renderBossBallConnectedWeapons();
+    if (new_projectile == NULL) {
+      return;
     }
 
-    renderProjectiles();
+    *new_projectile = (Projectile) {
+      .type = PROJECTILE_SQUARED,
 
-    renderLasers();
+      .hurts = PLAYER_PROJECTILE_HURTS,
 
-  } EndTextureMode();
+      .damage = damage,
+
+      .origin = Vector2Add(world->player.position, Vector2Scale(world->lookingDirection, 35)),
+      .size = size,
+      .delta = delta,
+      .angle = angle,
+
+      .inside = inside,
+      .outside = outside,
+      .lifetime = 10,
+      .canBounce = false,
+    };
+  }
+
+  float cooldown = PLAYER_FIRE_COOLDOWN;
+  if (world->playerPerks & PERK_FAST_BULLETS) {
+    cooldown /= 2;
+  }
+
+  world->player.fireCooldown = cooldown;
+
+  playSound(playerShot);
 }
 
-#define HEALTH_BAR_HEIGHT 5
+typedef enum {
+  KEY_MOVE_UP,
+  KEY_MOVE_LEFT,
+  KEY_MOVE_DOWN,
+  KEY_MOVE_RIGHT,
+  KEY_MOVE_COUNT,
+} MovementKeys;
 
-static Rectangle bossMarineHeadRect = {
-  .x = 76,
-  .y = 30,
-  .width = 23,
-  .height = 21,
+static KeyboardKey esdfKeys[KEY_MOVE_COUNT] = {
+  [KEY_MOVE_UP] = KEY_E,
+  [KEY_MOVE_LEFT] = KEY_S,
+  [KEY_MOVE_DOWN] = KEY_D,
+  [KEY_MOVE_RIGHT] = KEY_F,
 };
 
-void renderPlayerHealthBar(void) {
-  float w = playerRect.width * camera.zoom * SPRITES_SCALE;
-  float h = playerRect.height * camera.zoom * SPRITES_SCALE;
+static KeyboardKey wasdKeys[KEY_MOVE_COUNT] = {
+  [KEY_MOVE_UP] = KEY_W,
+  [KEY_MOVE_LEFT] = KEY_A,
+  [KEY_MOVE_DOWN] = KEY_S,
+  [KEY_MOVE_RIGHT] = KEY_D,
+};
 
-  Rectangle rect = {
-    .x = w / 2 + 20,
-    .y = h / 2 + 20,
-    .width = w,
-    .height = h,
-  };
+PlayerInput readPlayerInput(void) {
+  PlayerInput input = {0};
+  KeyboardKey *keys = wasdKeys;
 
-  DrawTexturePro(playerTexture2.texture,
-                 (Rectangle) {
-                   0, 0, playerTexture2.texture.width, playerTexture2.texture.height
-                 },
-                 rect,
-                 (Vector2) {w*0.5f, h*0.5f},
-                 sin(GetTime() * 10) * 50 * player.iframeTimer,
-                 WHITE);
-}
+  if (esdf) {
+    keys = esdfKeys;
+  }
 
-void renderBossHealthBar(void) {
-  const float screenFill = 0.7;
+  if (IsKeyDown(keys[KEY_MOVE_UP])) input.movement |= DIRECTION_UP;
+  if (IsKeyDown(keys[KEY_MOVE_LEFT])) input.movement |= DIRECTION_LEFT;
+  if (IsKeyDown(keys[KEY_MOVE_DOWN])) input.movement |= DIRECTION_DOWN;
+  if (IsKeyDown(keys[KEY_MOVE_RIGHT])) input.movement |= DIRECTION_RIGHT;
 
-  const float width = (float)GetScreenWidth() * screenFill;
-  const float height = HEALTH_BAR_HEIGHT * SPRITES_SCALE * camera.zoom;
+  input.aim = world->mouseCursor;
+  input.fire = IsMouseButtonDown(MOUSE_BUTTON_LEFT);
+  input.dash = IsMouseButtonPressed(MOUSE_BUTTON_RIGHT);
 
-  Rectangle rect = {
-    .x = (float)GetScreenWidth() / 2,
-    .y = height * 1.5,
-    .width = width,
-    .height = height,
-  };
+  return input;
+}
 
-  Rectangle wRect = rect;
-  wRect.width += SPRITES_SCALE * camera.zoom * 2;
+void movePlayerWithInput(void) {
+  if (world->playerInput.movement & DIRECTION_UP) {
+    world->player.movementDirection |= DIRECTION_UP;
+    world->player.movementDelta.y -= PLAYER_MOVEMENT_SPEED;
+  }
 
-  Rectangle hRect = rect;
-  hRect.height += SPRITES_SCALE * camera.zoom * 2;
+  if (world->playerInput.movement & DIRECTION_LEFT) {
+    world->player.movementDirection |= DIRECTION_LEFT;
+    world->player.movementDelta.x -= PLAYER_MOVEMENT_SPEED;
+  }
 
-  DrawRectanglePro(wRect, (Vector2) {wRect.width / 2, wRect.height / 2}, 0, BLACK);
-  DrawRectanglePro(hRect, (Vector2) {hRect.width / 2, hRect.height / 2}, 0, BLACK);
+  if (world->playerInput.movement & DIRECTION_DOWN) {
+    world->player.movementDirection |= DIRECTION_DOWN;
+    world->player.movementDelta.y += PLAYER_MOVEMENT_SPEED;
+  }
 
-  float health = 0;
+  if (world->playerInput.movement & DIRECTION_RIGHT) {
+    world->player.movementDirection |= DIRECTION_RIGHT;
+    world->player.movementDelta.x += PLAYER_MOVEMENT_SPEED;
+  }
 
-  char *bossName = NULL;
+  world->player.position = stepVector2(world->player.position, world->player.movementDelta);
+}
 
-  switch (currentBoss) {
-  case BOSS_MARINE: {
-    health = (float)bossMarine.health / BOSS_MARINE_MAX_HEALTH;
-    bossName = BOSS_MARINE_NAME;
-  } break;
-  case BOSS_BALL: {
-    health = (float)bossBall.health / BOSS_BALL_MAX_HEALTH;
-    bossName = BOSS_BALL_NAME;
-  } break;
-  };
 
-  rect.x -= rect.width / 2;
+PlayerDashTrail *pushDashTrail(void) {
+  int i = spawnEntity(&world->dashTrails, dashTrailsCapacity);
 
-  Vector2 head = {
-    .x = rect.x + rect.width * health,
-    .y = rect.y,
-  };
+  if (i < 0) {
+    return NULL;
+  }
 
-  rect.y -= rect.height / 2;
+  return &world->dashTrails.items[i];
+}
 
-  rect.width *= health;
+void movePlayerWithADash(void) {
+#define DASH_DELTA_LERP_RATE 0.12f
+  world->player.dashDelta = dampVector2(world->player.dashDelta,
+                                        Vector2Zero(),
+                                        DASH_DELTA_LERP_RATE);
 
-  DrawRectanglePro(rect, Vector2Zero(), 0, RED);
+  world->player.isInvincible = (roundf(world->player.dashDelta.x) != 0.0f ||
+                                roundf(world->player.dashDelta.y) != 0.0f);
 
-  float mul = SPRITES_SCALE * camera.zoom * 0.6;
+  world->player.position =
+    stepVector2(world->player.position,
+                world->player.dashDelta);
 
-  Font f = GetFontDefault();
-  float fontSize = 11 * mul;
-  float spacing = 1 * mul;
-  Vector2 size = MeasureTextEx(f, bossName, fontSize, spacing);
+  if (!world->player.isInvincible) {
+    return;
+  }
 
-  Vector2 pos = {
-      .x = (float)GetScreenWidth() / 2,
-      .y = height * 2,
+  PlayerDashTrail *new_trail = pushDashTrail();
+  if (!new_trail) {
+    return;
+  }
+
+  *new_trail = (PlayerDashTrail) {
+    .position = world->player.position,
+    .angle = playerLookingAngle(),
+    .alpha = 1.0f,
   };
+}
 
-  DrawTextPro(f, bossName, pos, Vector2Scale(size, 0.5f), 0, fontSize, spacing, BLACK);
-  DrawTextPro(f, bossName, Vector2SubtractValue(pos, spacing), Vector2Scale(size, 0.5f), 0, fontSize, spacing, WHITE);
+void updatePlayerDashTrails(void) {
+  for (int i = 0; i < world->dashTrails.pool.len; i++) {
+    world->dashTrails.items[i].alpha = Clamp(world->dashTrails.items[i].alpha - (simulationFrameTime() * 3),
+                                             0.0f,
+                                             1.0f);
 
-  switch (currentBoss) {
-  case BOSS_MARINE: {
-    DrawTexturePro(sprites,
-                   bossMarineHeadRect,
-                   (Rectangle) {
-                     .x = head.x,
-                     .y = head.y,
-                     .width = bossMarineHeadRect.width * mul,
-                     .height = bossMarineHeadRect.height * mul,
-                   },
-                   (Vector2) {
-                     .x = (bossMarineHeadRect.width * mul) / 2,
-                     .y = (bossMarineHeadRect.height * mul) / 2,
-                   },
-                   sin(GetTime() * 2) * 15,
-                   WHITE);
-  } break;
-  case BOSS_BALL: {
+    if (world->dashTrails.items[i].alpha <= 0.0f) {
+      killEntity(&world->dashTrails, i);
+    }
+  }
+}
 
-    Vector3 groundTopLeft = {-50, 0, -50};
-    Vector3 groundBottomLeft = {-50, 0, 50};
-    Vector3 groundBottomRight = {50, 0, 50};
-    Vector3 groundTopRight = {50, 0, -50};
+Particle *pushParticle() {
+  if (world->headless || world->silent) {
+    return NULL;
+  }
 
-    Vector3 lightPos = bossBallLight.position;
+  int i = spawnEntity(&world->particles, particlesCapacity);
 
-    Ray lightRay = GetMouseRay(screenMouseLocation, bossBallCamera);
-    RayCollision lc = GetRayCollisionQuad(lightRay, groundTopLeft, groundBottomLeft, groundBottomRight, groundTopRight);
+  if (i < 0) {
+    return NULL;
+  }
 
-    if (lc.hit && lc.distance < FLOAT_MAX) {
-      bossBallLight.position = (Vector3) {
-        lc.point.x, lightPos.y, lc.point.z
-      };
-    }
+  return &world->particles.items[i];
+}
 
-    bossBallUpdateShader();
+/* NOTE: particles are only for show, so they take their randomness from raylib and never shift the world's */
+#define PARTICLE_RANDOM() ((float)GetRandomValue(0, 10000) / 10000.0f)
 
-    Ray r = GetMouseRay(head, bossBallCamera);
-    RayCollision c = GetRayCollisionQuad(r, groundTopLeft, groundBottomLeft, groundBottomRight, groundTopRight);
+void spawnAsteroidParticles(int i) {
+  float particleAmount = 1.0f * (world->asteroids[i].sprite->textureRect.width *
+                                 world->asteroids[i].sprite->textureRect.height);
+  float particlesPerCircle = particleAmount / world->asteroids[i].sprite->boundingCirclesLen;
 
-    BeginTextureMode(bossBallTargetScreen); {
-      ClearBackground(BLANK);
+  Circle *circles = colliderCircles(&world->asteroids[i].collider);
 
-      BeginMode3D(bossBallCamera); {
-        if (c.hit && c.distance < FLOAT_MAX) {
-          DrawModelEx(bossBallModel,
-                      c.point,
-                      (Vector3) {0, 0, -1}, 360 * health * 8,
-                      Vector3Scale(Vector3One(), .5),
-                      WHITE);
-        }
-      } EndMode3D();
-    } EndTextureMode();
+  for (int j = 0; j < world->asteroids[i].collider.len; j++) {
+    for (int p = 0; p < particlesPerCircle; p++) {
+      Particle *newParticle = pushParticle();
 
-    bossBallLight.position = lightPos;
-    bossBallUpdateShader();
+      if (newParticle == NULL) {
+        return;
+      }
 
-    const float pixelSize = 1.0;
+      Vector2 direction = (Vector2) {PARTICLE_RANDOM() * 2.0f - 1.0f, PARTICLE_RANDOM() * 2.0f - 1.0f};
+      float r = circles[j].radius;
+      float mag = r * PARTICLE_RANDOM();
+      Vector2 pos = Vector2Scale(direction, mag);
+      Vector2 actualPos = Vector2Add(circles[j].position, pos);
 
-    SetShaderValue(pixelationShader,
-                   pixelationShaderPixelSize,
-                   &pixelSize,
-                   SHADER_UNIFORM_FLOAT);
+      float speed = PARTICLE_RANDOM() * 2;
 
-    BeginShaderMode(pixelationShader); {
-      DrawTextureRec(bossBallTargetScreen.texture,
-                     (Rectangle) {
-                       0, 0,
-                       bossBallTargetScreen.texture.width, -bossBallTargetScreen.texture.height
-                     },
-                     Vector2Zero(),
-                     WHITE);
-    } EndShaderMode();
-  } break;
-  };
+      *newParticle = (Particle) {
+        .color = world->asteroids[i].sprite->palette[GetRandomValue(0, world->asteroids[i].sprite->paletteLen - 1)],
+        .angle = world->asteroids[i].angle,
+        .lifetime = 2.0f,
+        .position = actualPos,
+        .delta = Vector2Scale(direction, speed),
+      };
+    }
+  }
 }
 
-static Vector2 bossInfoHeadPosition = {0};
-static float infoXBase = 0;
+void processCollisions(void) {
+  collisionWorldBuild(COLLISION_LAYER_ASTEROID | COLLISION_LAYER_LASER);
 
-void renderBossInfo(void) {
-  float w = GetScreenWidth();
-  float h = GetScreenHeight();
+  Collider body = circleCollider(COLLIDER_PLAYER, 0, COLLISION_LAYER_PLAYER, world->player.position, PLAYER_HITBOX_RADIUS);
+  ContactList contacts = worldContacts();
+  collisionWorldQuery(&body, COLLISION_LAYER_ASTEROID, &contacts);
 
-  Color red = {0};
+  for (int c = 0; c < contacts.len; c++) {
+    const Contact *contact = &contacts.items[c];
+    int i = contactCollider(contact)->index;
 
-  switch (currentBoss) {
-  case BOSS_MARINE: red = (Color) {143, 30, 32, 255}; break;
-  case BOSS_BALL: red = (Color) {243, 83, 54, 255}; break;
-  }
+    if (world->asteroids[i].isDestroyed) {
+      continue;
+    }
 
-  float w3 = roundf(w / 3);
+    if (world->player.isInvincible) {
+      if (world->playerPerks & PERK_OMINOUS_AURA) {
 
-  float x1 = ceilf(infoXBase + w3);
-  float x2 = floorf(x1 + w3);
+        spawnAsteroidParticles(i);
 
-  DrawRectangle(infoXBase, 0,
-                w3, h,
-                red);
+        world->asteroids[i].isDestroyed = true;
+        moveAsteroid(i, Vector2Subtract((Vector2) {-200, -200}, world->asteroids[i].position));
+        playSound(asteroidDestructionSound);
+      } else {
+        moveAsteroid(i, contact->push);
+        world->asteroids[i].delta = Vector2Add(world->asteroids[i].delta, Vector2Scale(contact->push, 0.2f));
+        world->asteroids[i].launchedByPlayer = true;
+      }
+    } else {
+      world->player.position = Vector2Subtract(world->player.position, contact->push);
+    }
+  }
 
-  DrawTriangle((Vector2) {x1, 0},
-               (Vector2) {x1, h},
-               (Vector2) {x2, h},
-               red);
+  if (world->currentBoss != BOSS_BALL) {
+    return;
+  }
 
-  float mul = 25;
+  if (world->player.isInvincible || world->player.iframeTimer > 0.0f) {
+    return;
+  }
 
-  char *bossName = NULL;
+  body = circleCollider(COLLIDER_PLAYER, 0, COLLISION_LAYER_PLAYER, world->player.position, PLAYER_HITBOX_RADIUS);
 
-  switch (currentBoss) {
-  case BOSS_MARINE: {
-    bossName = BOSS_MARINE_NAME;
+  if (collisionWorldQuery(&body, COLLISION_LAYER_LASER, &contacts) > 0) {
+    playSound(hit);
+    world->player.health -= 1 * (world->playerPerks & PERK_MORE_BULLETS ? 2 : 1);
+    world->player.iframeTimer = 0.4f;
+  }
+}
 
-    Rectangle headRect = bossMarineHeadRect;
+void updatePlayerPosition(void) {
+  world->player.movementDirection = 0;
+  world->player.movementDelta = Vector2Zero();
 
-    DrawTexturePro(sprites,
-                   headRect,
-                   (Rectangle) {
-                     .x = bossInfoHeadPosition.x,
-                     .y = bossInfoHeadPosition.y,
-                     .width = headRect.width * mul,
-                     .height = headRect.height * mul,
-                   },
-                   (Vector2) {
-                     .x = (headRect.width * mul) / 2,
-                     .y = (headRect.height * mul) / 2,
-                   },
-                   sin(GetTime()) * 15,
-                   WHITE);
-  } break;
-  case BOSS_BALL: {
-    bossName = BOSS_BALL_NAME;
-
-    bossBallUpdateShader();
-
-    Vector3 groundTopLeft = {-50, 0, -50};
-    Vector3 groundBottomLeft = {-50, 0, 50};
-    Vector3 groundBottomRight = {50, 0, 50};
-    Vector3 groundTopRight = {50, 0, -50};
+  movePlayerWithInput();
+  movePlayerWithADash();
 
-    Ray r = GetMouseRay(bossInfoHeadPosition, bossBallCamera);
-    RayCollision c = GetRayCollisionQuad(r, groundTopLeft, groundBottomLeft, groundBottomRight, groundTopRight);
+  size_t scratch = scratchBegin();
+  processCollisions();
+  scratchEnd(scratch);
 
-    BeginTextureMode(bossBallTargetScreen); {
-      ClearBackground(BLANK);
+  world->player.position =
+    Vector2Clamp(world->player.position,
+                 (Vector2) {
+                   .x = PLAYER_HITBOX_RADIUS,
+                   .y = PLAYER_HITBOX_RADIUS,
+                 },
+                 (Vector2) {
+                   .x = level.x - PLAYER_HITBOX_RADIUS,
+                   .y = level.y - PLAYER_HITBOX_RADIUS,
+                 });
+}
 
-      BeginMode3D(bossBallCamera); {
-        if (c.hit && c.distance < FLOAT_MAX) {
-          DrawModelEx(bossBallModel,
-                      c.point,
-                      (Vector3) {0, 1, 0}, GetTime() * 15,
-                      Vector3Scale(Vector3One(), 5),
-                      WHITE);
-        }
-      } EndMode3D();
-    } EndTextureMode();
+/* NOTE: the stars are a fraction of the background's resolution and twinkle slowly, so they're redrawn a few times a second */
+#define STARS_DOWNSCALE_FACTOR 2
+#define STARS_UPDATE_RATE 15.0
 
-    const float pixelSize = 10.0;
+void preRenderBackground(bool dom) {
+  static int bakedDom = -1;
+  static double starsRenderedAt = -1.0;
+
+  if (bakedDom != dom) {
+    float domv = dom ? 1.0f : 0.0f;
+    SetShaderValue(nebula, nebulaDom, &domv, SHADER_UNIFORM_FLOAT);
+
+    BeginTextureMode(nebulaTexture); {
+      BeginBlendMode(BLEND_ALPHA); {
+        ClearBackground((Color) {41, 1, 53, 69});
+        BeginShaderMode(nebula); {
+          DrawTexture(nebulaNoise, 0, 0, WHITE);
+        }; EndShaderMode();
+      }; EndBlendMode();
+    }; EndTextureMode();
 
-    SetShaderValue(pixelationShader,
-                   pixelationShaderPixelSize,
-                   &pixelSize,
-                   SHADER_UNIFORM_FLOAT);
+    bakedDom = dom;
+  }
 
-    BeginShaderMode(pixelationShader); {
-      DrawTextureRec(bossBallTargetScreen.texture,
-                     (Rectangle) {
-                       0, 0,
-                       bossBallTargetScreen.texture.width, -bossBallTargetScreen.texture.height
-                     },
-                     Vector2Zero(),
-                     WHITE);
-    } EndShaderMode();
-  } break;
-  };
+  double now = GetTime();
 
-  Font f = GetFontDefault();
-  float fontSize = 11 * mul / 4;
-  float spacing = 1 * mul / 4;
-  Vector2 size = MeasureTextEx(f, bossName, fontSize, spacing);
+  if (now - starsRenderedAt < 1.0 / STARS_UPDATE_RATE) {
+    return;
+  }
 
-  Vector2 pos = (Vector2) {
-      .x = w / 4 * 3,
-      .y = h / 2,
-  };
+  starsRenderedAt = now;
 
-  DrawTextPro
-    (f,
-     bossName,
-     Vector2AddValue(pos, spacing),
-     Vector2Scale(size, 0.5f),
-     0,
-     fontSize,
-     spacing,
-     red);
+  float t = now;
+  SetShaderValue(stars, starsTime, &t, SHADER_UNIFORM_FLOAT);
 
-  DrawTextPro
-    (f,
-     bossName,
-     pos,
-     Vector2Scale(size, 0.5f),
-     0,
-     fontSize,
-     spacing,
-     WHITE);
+  /* NOTE: the shader's output is premultiplied and goes into the texture as is, so it's blended only once over the nebula */
+  BeginTextureMode(starsTexture); {
+    ClearBackground(BLANK);
+    BeginBlendMode(BLEND_ALPHA_PREMULTIPLY); {
+      BeginShaderMode(stars); {
+        DrawTexturePro(nebulaNoise,
+                       (Rectangle) {0, 0, nebulaNoise.width, nebulaNoise.height},
+                       (Rectangle) {0, 0, starsTexture.texture.width, starsTexture.texture.height},
+                       Vector2Zero(),
+                       0,
+                       WHITE);
+      }; EndShaderMode();
+    }; EndBlendMode();
+  }; EndTextureMode();
 }
 
-void renderFinal(void) {
-  BeginDrawing(); {
-    ClearBackground(BLACK);
+typedef enum {
+  CULL_ASTEROIDS,
+  CULL_PROJECTILES,
+  CULL_PARTICLES,
+  CULL_DASH_TRAILS,
+  CULL_THRUSTER_TRAILS,
+  CULL_BACKGROUND_ASTEROID,
+  CULL_CATEGORIES,
+} CullCategory;
+
+static const char *cullCategoryNames[CULL_CATEGORIES] = {
+  [CULL_ASTEROIDS] = "asteroids",
+  [CULL_PROJECTILES] = "projectiles",
+  [CULL_PARTICLES] = "particles",
+  [CULL_DASH_TRAILS] = "dash trails",
+  [CULL_THRUSTER_TRAILS] = "thruster trails",
+  [CULL_BACKGROUND_ASTEROID] = "background asteroid",
+};
 
-    float width = (float)target.texture.width;
-    float height = (float)target.texture.height;
+typedef struct {
+  int drawn;
+  int culled;
+} CullCount;
 
-    BeginMode2D(camera); {
-      DrawTexturePro(target.texture,
-                     (Rectangle) {
-                       .x = 0,
-                       .y = 0,
-                       .width = width,
-                       .height = -height
-                     },
-                     (Rectangle) {
-                       .x = 0,
-                       .y = 0,
-                       .width = width,
-                       .height = height
-                     },
-                     Vector2Zero(),
-                     0.0f,
-                     WHITE);
-    }; EndMode2D();
+static CullCount cullCounts[CULL_CATEGORIES] = {0};
 
-    if (gameState == GAME_BOSS_INTRODUCTION &&
-        introductionStage == BOSS_INTRODUCTION_INFO) {
-      renderBossInfo();
-    }
+void updateWorldView(void) {
+  Vector2 topLeft = GetScreenToWorld2D(Vector2Zero(), camera);
+  Vector2 bottomRight = GetScreenToWorld2D((Vector2) {GetScreenWidth(), GetScreenHeight()}, camera);
 
-    if (gameState == GAME_BOSS) {
-      renderBossHealthBar();
-      renderPlayerHealthBar();
-    }
+  worldView = GetCollisionRec((Rectangle) {0, 0, level.x, level.y},
+                              (Rectangle) {topLeft.x, topLeft.y, bottomRight.x - topLeft.x, bottomRight.y - topLeft.y});
+}
 
-    if (gameState != GAME_BOSS_INTRODUCTION &&
-        gameState != GAME_PLAYER_DEAD &&
-        gameState != GAME_BOSS_DEAD &&
-        !isGamePaused) {
-      renderMouseCursor();
-    }
+/* NOTE: `radius` has to cover the whole thing however it's rotated */
+bool isInWorldView(CullCategory category, Vector2 center, float radius) {
+  bool visible = center.x + radius >= worldView.x &&
+    center.x - radius <= worldView.x + worldView.width &&
+    center.y + radius >= worldView.y &&
+    center.y - radius <= worldView.y + worldView.height;
 
-  } EndDrawing();
+  if (visible) {
+    cullCounts[category].drawn++;
+  } else {
+    cullCounts[category].culled++;
+  }
+
+  return visible;
 }
 
-typedef struct {
-  union {
-    struct {
-      Vector2 topLeft;
-      Vector2 topRight;
-      Vector2 bottomRight;
-      Vector2 bottomLeft;
-    };
-    Vector2 points[4];
-  };
-} RectanglePoints;
+#define CULLING_REPORT_INTERVAL 1.0
 
-RectanglePoints translateIntoPoints(const Rectangle rect,
-                                    const float angle) {
-  const Vector2 halfSize = {rect.width * 0.5f, rect.height * 0.5f};
+void reportCulling(void) {
+  static double reportedAt = 0.0;
 
-  const Vector2 topLeft = {-halfSize.x, -halfSize.y};
-  const Vector2 topRight = {+halfSize.x, -halfSize.y};
-  const Vector2 bottomRight = {+halfSize.x, +halfSize.y};
-  const Vector2 bottomLeft = {-halfSize.x, +halfSize.y};
+  if (GetTime() - reportedAt < CULLING_REPORT_INTERVAL) {
+    return;
+  }
 
-  const Vector2 pos = {rect.x, rect.y};
-  const float a = angle * DEG2RAD;
+  reportedAt = GetTime();
 
-  return (RectanglePoints) {
-    .topLeft = Vector2Add(pos, Vector2Rotate(topLeft, a)),
-    .topRight = Vector2Add(pos, Vector2Rotate(topRight, a)),
-    .bottomRight = Vector2Add(pos, Vector2Rotate(bottomRight, a)),
-    .bottomLeft = Vector2Add(pos, Vector2Rotate(bottomLeft, a)),
-  };
-}
+  for (int i = 0; i < CULL_CATEGORIES; i++) {
+    if (cullCounts[i].drawn + cullCounts[i].culled == 0) {
+      continue;
+    }
 
-bool circleLineCollision(Vector2 start, Vector2 end,
-                         Vector2 circle, float radius) {
-  if (CheckCollisionPointCircle(start, circle, radius) ||
-      CheckCollisionPointCircle(end, circle, radius)) {
-    return true;
+    LOG("CULLING: %s drawn %d, culled %d\n", cullCategoryNames[i], cullCounts[i].drawn, cullCounts[i].culled);
   }
+}
 
-  float lineDistance = Vector2Distance(start, end);
-  float dot =
-    (((circle.x - start.x) * (end.x - start.x)) +
-     ((circle.y - start.y) * (end.y - start.y))) /
-    (lineDistance * lineDistance);
+/* NOTE: rectangles and circles are drawn with it, so they batch like sprites of a 1x1 texture */
+static Texture2D shapesTexture = {0};
 
-  Vector2 closest = {
-    .x = start.x + (dot * (end.x - start.x)),
-    .y = start.y + (dot * (end.y - start.y)),
-  };
+/* NOTE: the world is drawn bottom to top in these layers, inside a layer draws may be reordered */
+typedef enum {
+  DRAW_LAYER_BACKGROUND,
+  DRAW_LAYER_STARS,
+  DRAW_LAYER_BACKGROUND_ASTEROID,
+  DRAW_LAYER_ARENA_BORDER,
+  DRAW_LAYER_PARTICLES,
+  DRAW_LAYER_ASTEROIDS,
+  DRAW_LAYER_SHADE,
+  DRAW_LAYER_BOSS,
+  DRAW_LAYER_DISCONNECTED_WEAPONS,
+  DRAW_LAYER_THRUSTER_TRAILS,
+  DRAW_LAYER_DASH_TRAILS,
+  DRAW_LAYER_AURA,
+  DRAW_LAYER_SHIPS,
+  DRAW_LAYER_CONNECTED_WEAPONS,
+  DRAW_LAYER_PROJECTILES,
+  DRAW_LAYER_LASERS,
+  DRAW_LAYERS,
+} DrawLayer;
 
-  if (!CheckCollisionPointLine(closest,
-                               start, end,
-                               2)) {
-    return false;
-  }
+typedef enum {
+  DRAW_TEXTURE,
+  DRAW_RECTANGLE,
+  DRAW_CIRCLE,
+} DrawCommandType;
 
-  return Vector2Distance(closest, circle) <= radius;
-}
+typedef struct {
+  /* NOTE: layer, run, state within the run, then the order it was queued in */
+  uint64_t key;
+
+  DrawCommandType type;
+  Shader shader;
+  int blendMode;
+  Texture2D texture;
+  Rectangle source;
+  /* NOTE: a circle's center and radius are `x`, `y` and `width` */
+  Rectangle dest;
+  Vector2 origin;
+  float rotation;
+  Color tint;
+} DrawCommand;
 
-bool doesRectangleCollideWithACircle(Rectangle a, float angle,
-                                     Vector2 b, float r) {
-  RectanglePoints points = translateIntoPoints(a, angle);
+#define DRAW_RUN_STATES 8
 
-  return
-    circleLineCollision(points.topLeft, points.topRight, b, r) ||
-    circleLineCollision(points.topRight, points.bottomRight, b, r) ||
-    circleLineCollision(points.bottomRight, points.bottomLeft, b, r) ||
-    circleLineCollision(points.bottomLeft, points.topLeft, b, r);
-}
+typedef struct {
+  unsigned int shader;
+  unsigned int texture;
+  int blendMode;
+  Rectangle bounds;
+} DrawRunState;
+
+/* NOTE: draws of a run are grouped by state in the order the states first showed up, which only changes
+         what ends up on top when a draw overlaps one of a later state, and then a new run is started */
+typedef struct {
+  int run;
+  int len;
+  DrawRunState states[DRAW_RUN_STATES];
+} DrawRun;
 
-void checkRegularProjectileCollision(int i) {
-  Vector2 proj = projectiles[i].origin;
-  float radius = projectiles[i].radius;
+typedef struct {
+  DrawCommand *commands;
+  int len;
+  int capacity;
 
-  for (int j = 0; j < asteroidsLen; j++) {
-    for (int bj = 0; bj < asteroids[j].sprite->boundingCirclesLen; bj++) {
-      Vector2 pos = Vector2Add(asteroids[j].processedBoundingCircles[bj].position,
-                               asteroids[j].position);
-      float r = asteroids[j].processedBoundingCircles[bj].radius;
+  /* NOTE: outside of the world everything is drawn right away */
+  bool recording;
+  DrawLayer layer;
+  Shader shader;
+  int blendMode;
+  DrawRun runs[DRAW_LAYERS];
 
-      if (CheckCollisionCircles(proj, radius, pos, r)) {
-        projectiles[i].willBeDestroyed = true;
-        return;
-      }
-    }
-  }
+  /* NOTE: every shader change makes rlgl draw its batch, every texture change starts a new draw call in it */
+  int flushes;
+  int unsortedFlushes;
+  int drawCalls;
+} DrawQueue;
 
-  if (!player.isInvincible &&
-      !projectiles[i].willBeDestroyed &&
-      projectiles[i].isHurtfulForPlayer &&
-      CheckCollisionCircles(proj, radius, player.position, PLAYER_HITBOX_RADIUS)) {
+static DrawQueue drawQueue = {0};
 
-    projectiles[i].willBeDestroyed = true;
+void beginDrawQueue(void) {
+  drawQueue.len = 0;
+  drawQueue.recording = true;
+  drawQueue.layer = DRAW_LAYER_BACKGROUND;
+  drawQueue.shader = (Shader) {0};
+  drawQueue.blendMode = BLEND_ALPHA;
+  memset(drawQueue.runs, 0, sizeof(drawQueue.runs));
+}
 
-    if (player.iframeTimer == 0.0f) {
-      PlaySound(hit);
-      player.health -= projectiles[i].damage * (playerPerks & PERK_MORE_BULLETS ? 2 : 1);
-      player.iframeTimer = 0.3f;
-    }
+void setDrawLayer(DrawLayer layer) {
+  drawQueue.layer = layer;
+}
+
+void beginQueuedShader(Shader shader) {
+  if (!drawQueue.recording) {
+    BeginShaderMode(shader);
     return;
   }
 
-  if (!projectiles[i].isHurtfulForBoss) {
+  drawQueue.shader = shader;
+}
+
+void endQueuedShader(void) {
+  if (!drawQueue.recording) {
+    EndShaderMode();
     return;
   }
 
-  switch (currentBoss) {
-  case BOSS_MARINE: {
-    for (int j = 0; j < BOSS_MARINE_BOUNDING_CIRCLES; j++) {
-      Vector2 pos = Vector2Add(bossMarine.position,
-                               bossMarine.processedBoundingCircles[j].position);
-      float r = bossMarine.processedBoundingCircles[j].radius;
-
-      if (CheckCollisionCircles(proj, radius, pos, r)) {
-        projectiles[i].willBeDestroyed = true;
-        bossMarine.health -= projectiles[i].damage;
-        bossMarineStealHealth();
-        return;
-      }
-    }
-  } break;
-  case BOSS_BALL: {
-    if (CheckCollisionCircles(proj, radius, bossBall.position, BOSS_BALL_HITBOX_RADIUS)) {
-      projectiles[i].willBeDestroyed = true;
-      bossBall.health -= projectiles[i].damage;
-      bossBallStealHealth();
-      return;
-    }
-  } break;
-  }
+  drawQueue.shader = (Shader) {0};
 }
 
-void bossBallDeactivateWeapon(int i) {
-  StopMusicStream(bossBall.weapons[i].soundEffect);
+void beginQueuedBlendMode(int mode) {
+  if (!drawQueue.recording) {
+    BeginBlendMode(mode);
+    return;
+  }
 
-  bossBall.weapons[i].attackCooldown = 2.0f;
-  bossBall.weapons[i].attackTimer = 0.0f;
+  drawQueue.blendMode = mode;
+}
 
-  bossBall.weapons[i].laserLength = 0;
-  bossBall.weapons[i].chargeLevel = 0;
+void endQueuedBlendMode(void) {
+  if (!drawQueue.recording) {
+    EndBlendMode();
+    return;
+  }
 
-  bossBall.weapons[i].isDeactivated = true;
+  drawQueue.blendMode = BLEND_ALPHA;
 }
 
-bool checkRectangleCollision1(const Vector2 centerA, const RectanglePoints a,
-                              const RectanglePoints b) {
-  for (int i = 0; i < 4; i++) {
-    Vector2 start = centerA;
-    Vector2 end = a.points[i];
+Rectangle drawCommandBounds(const DrawCommand *c) {
+  if (c->type == DRAW_CIRCLE) {
+    return (Rectangle) {c->dest.x - c->dest.width, c->dest.y - c->dest.width, c->dest.width * 2, c->dest.width * 2};
+  }
 
-    for (int k = 0; k < 4; k++) {
-      int kn = (k + 1) % 4;
+  float w = fabsf(c->dest.width);
+  float h = fabsf(c->dest.height);
 
-      if (CheckCollisionLines(start, end,
-                              b.points[k], b.points[kn],
-                              NULL)) {
-        return true;
-      }
-    }
+  if (c->rotation == 0) {
+    return (Rectangle) {c->dest.x - c->origin.x, c->dest.y - c->origin.y, w, h};
   }
 
-  return false;
+  /* NOTE: covers every rotation around the origin */
+  float r = Vector2Length((Vector2) {
+      fmaxf(fabsf(c->origin.x), fabsf(w - c->origin.x)),
+      fmaxf(fabsf(c->origin.y), fabsf(h - c->origin.y)),
+    });
+
+  return (Rectangle) {c->dest.x - r, c->dest.y - r, r * 2, r * 2};
 }
 
-bool checkRectangleCollision(const Vector2 centerA, const RectanglePoints a,
-                             const Vector2 centerB, const RectanglePoints b) {
-  return
-    checkRectangleCollision1(centerA, a, b) ||
-    checkRectangleCollision1(centerB, b, a);
+Rectangle rectangleUnion(Rectangle a, Rectangle b) {
+  float x = fminf(a.x, b.x);
+  float y = fminf(a.y, b.y);
+
+  return (Rectangle) {x, y, fmaxf(a.x + a.width, b.x + b.width) - x, fmaxf(a.y + a.height, b.y + b.height) - y};
 }
 
-void checkSquaredProjectileCollision(int i) {
-  Rectangle proj = {
-    .x = projectiles[i].origin.x,
-    .y = projectiles[i].origin.y,
-  };
-  Vector2 origin = {
-    (projectiles[i].size.x / 2),
-    (projectiles[i].size.y / 2),
-  };
+/* returns which state of the layer's current run the draw goes with, starting a new run when it has to */
+int drawRunState(DrawRun *run, const DrawCommand *c) {
+  Rectangle bounds = drawCommandBounds(c);
 
-  float angle = projectiles[i].angle;
+  for (int i = 0; i < run->len; i++) {
+    DrawRunState *state = &run->states[i];
 
-  for (int j = 0; j < asteroidsLen; j++) {
-    for (int bj = 0; bj < asteroids[j].sprite->boundingCirclesLen; bj++) {
-      Vector2 pos = Vector2Add(asteroids[j].processedBoundingCircles[bj].position,
-                               asteroids[j].position);
-      float r = asteroids[j].processedBoundingCircles[bj].radius;
+    if (state->shader != c->shader.id || state->texture != c->texture.id || state->blendMode != c->blendMode) {
+      continue;
+    }
 
-      if (doesRectangleCollideWithACircle(proj, angle, pos, r)) {
-        projectiles[i].willBeDestroyed = true;
-        return;
+    /* NOTE: the draw would end up under the later states it overlaps */
+    bool covered = false;
+
+    for (int j = i + 1; j < run->len; j++) {
+      if (CheckCollisionRecs(run->states[j].bounds, bounds)) {
+        covered = true;
+        break;
       }
     }
-  }
 
-  if (!player.isInvincible &&
-      !projectiles[i].willBeDestroyed &&
-      projectiles[i].isHurtfulForPlayer &&
-      doesRectangleCollideWithACircle(proj, angle, player.position, PLAYER_HITBOX_RADIUS)) {
-    projectiles[i].willBeDestroyed = true;
-
-    if (player.iframeTimer == 0.0f) {
-      PlaySound(hit);
-      player.health -= projectiles[i].damage * (playerPerks & PERK_MORE_BULLETS ? 2 : 1);
-      player.iframeTimer = 0.3f;
+    if (!covered) {
+      state->bounds = rectangleUnion(state->bounds, bounds);
+      return i;
     }
 
-    if (player.health == 0) {
-      gameState = GAME_PLAYER_DEAD;
-      PauseMusicStream(bossMarineMusic);
-      PlaySound(playerDeathSound);
-    }
-    return;
+    run->run++;
+    run->len = 0;
+    break;
   }
 
-  if (projectiles[i].willBeDestroyed) {
-    return;
+  if (run->len == DRAW_RUN_STATES) {
+    run->run++;
+    run->len = 0;
   }
 
-  if (!projectiles[i].isHurtfulForBoss) {
-    return;
+  run->states[run->len] = (DrawRunState) {c->shader.id, c->texture.id, c->blendMode, bounds};
+
+  return run->len++;
+}
+
+void queueDrawCommand(DrawCommand command) {
+  if (drawQueue.len == drawQueue.capacity) {
+    drawQueue.capacity = MAX(1024, drawQueue.capacity * 2);
+    drawQueue.commands = realloc(drawQueue.commands, drawQueue.capacity * sizeof(DrawCommand));
   }
 
-  RectanglePoints a =
-    translateIntoPoints((Rectangle) {projectiles[i].origin.x, projectiles[i].origin.y,
-                                     projectiles[i].size.x, projectiles[i].size.y},
-      projectiles[i].angle);
+  command.shader = drawQueue.shader;
+  command.blendMode = drawQueue.blendMode;
 
-  for (int j = 0; j < PROJECTILES_MAX; j++) {
-    if (j == i ||
-        projectiles[j].homesOntoPlayer != true ||
-        projectiles[j].isHurtfulForPlayer != true ||
-        projectiles[j].type != PROJECTILE_SQUARED ||
-        projectiles[j].willBeDestroyed ||
-        projectiles[i].willBeDestroyed) {
-      continue;
-    }
+  DrawRun *run = &drawQueue.runs[drawQueue.layer];
+  int state = drawRunState(run, &command);
 
-    RectanglePoints b =
-      translateIntoPoints((Rectangle) {projectiles[j].origin.x, projectiles[j].origin.y,
-                                       projectiles[j].size.x, projectiles[j].size.y},
-        projectiles[j].angle);
+  assert(run->run < (1 << 21));
 
-    if (checkRectangleCollision(projectiles[i].origin, a,
-                                projectiles[j].origin, b)) {
-      projectiles[i].willBeDestroyed = true;
-      projectiles[j].willBeDestroyed = true;
-      return;
-    }
+  command.key = ((uint64_t)drawQueue.layer << 56) |
+    ((uint64_t)run->run << 35) |
+    ((uint64_t)state << 32) |
+    (uint64_t)drawQueue.len;
+
+  drawQueue.commands[drawQueue.len++] = command;
+}
+
+void queueTexturePro(Texture2D texture, Rectangle source, Rectangle dest, Vector2 origin, float rotation, Color tint) {
+  if (!drawQueue.recording) {
+    DrawTexturePro(texture, source, dest, origin, rotation, tint);
+    return;
   }
 
-  switch (currentBoss) {
-  case BOSS_MARINE: {
-    for (int j = 0; j < BOSS_MARINE_BOUNDING_CIRCLES; j++) {
-      Vector2 pos = Vector2Add(bossMarine.position,
-                               bossMarine.processedBoundingCircles[j].position);
-      float r = bossMarine.processedBoundingCircles[j].radius;
-
-      if (doesRectangleCollideWithACircle(proj, angle, pos, r)) {
-        projectiles[i].willBeDestroyed = true;
-        bossMarine.health -= projectiles[i].damage;
-        bossMarineStealHealth();
-        return;
-      }
-    }
-  } break;
-  case BOSS_BALL: {
-    if (doesRectangleCollideWithACircle(proj, angle, bossBall.position, BOSS_BALL_HITBOX_RADIUS)) {
-      projectiles[i].willBeDestroyed = true;
-      bossBall.health -= projectiles[i].damage;
-      bossBallStealHealth();
-      return;
-    }
+  queueDrawCommand((DrawCommand) {
+      .type = DRAW_TEXTURE,
+      .texture = texture,
+      .source = source,
+      .dest = dest,
+      .origin = origin,
+      .rotation = rotation,
+      .tint = tint,
+    });
+}
 
-    for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
-      if (!bossBall.weapons[i].isDisconnected) {
-        continue;
-      }
+void queueRectanglePro(Rectangle rec, Vector2 origin, float rotation, Color color) {
+  if (!drawQueue.recording) {
+    DrawRectanglePro(rec, origin, rotation, color);
+    return;
+  }
 
-      Vector2 pos = bossBall.weapons[i].position;
-      float r = bossBallWeaponHitboxRadiuses[bossBall.weapons[i].type];
+  queueDrawCommand((DrawCommand) {
+      .type = DRAW_RECTANGLE,
+      .texture = shapesTexture,
+      .dest = rec,
+      .origin = origin,
+      .rotation = rotation,
+      .tint = color,
+    });
+}
 
-      if (doesRectangleCollideWithACircle(proj, angle, pos, r)) {
-        projectiles[i].willBeDestroyed = true;
-        bossBallDeactivateWeapon(i);
-        return;
-      }
-    }
-  } break;
+void queueCircleV(Vector2 center, float radius, Color color) {
+  if (!drawQueue.recording) {
+    DrawCircleV(center, radius, color);
+    return;
   }
+
+  queueDrawCommand((DrawCommand) {
+      .type = DRAW_CIRCLE,
+      .texture = shapesTexture,
+      .dest = {center.x, center.y, radius, radius},
+      .tint = color,
+    });
 }
 
-void updateProjectiles(void) {
-  Vector2 normalDown = {0, 1};
-  Vector2 normalUp = {0, -1};
-  Vector2 normalRight = {1, 0};
-  Vector2 normalLeft = {-1, 0};
+int compareDrawCommands(const void *a, const void *b) {
+  uint64_t ka = ((const DrawCommand *)a)->key;
+  uint64_t kb = ((const DrawCommand *)b)->key;
 
-  for (int i = 0; i < PROJECTILES_MAX; i++) {
-    if (projectiles[i].type == PROJECTILE_NONE) {
-      continue;
+  return (ka > kb) - (ka < kb);
+}
+
+int countShaderChanges(void) {
+  int changes = 0;
+  unsigned int shader = 0;
+
+  for (int i = 0; i < drawQueue.len; i++) {
+    if (drawQueue.commands[i].shader.id != shader) {
+      shader = drawQueue.commands[i].shader.id;
+      changes++;
     }
+  }
 
-    projectiles[i].destructionTimer = Clamp(projectiles[i].destructionTimer - GetFrameTime(),
-                                            0,
-                                            1.0f);
+  return changes + (shader != 0);
+}
 
-    if (projectiles[i].willBeDestroyed) {
-      if (projectiles[i].destructionTimer <= 0) {
-        projectiles[i].type = PROJECTILE_NONE;
-      }
+void submitDrawQueue(void) {
+  drawQueue.recording = false;
+  drawQueue.unsortedFlushes = countShaderChanges();
 
-      continue;
-    }
+  qsort(drawQueue.commands, drawQueue.len, sizeof(DrawCommand), compareDrawCommands);
 
-    projectiles[i].lifetime -= GetFrameTime();
+  drawQueue.flushes = countShaderChanges();
+  drawQueue.drawCalls = 0;
 
-    if (projectiles[i].lifetime <= 0.0f) {
-      projectiles[i].willBeDestroyed = true;
-      projectiles[i].destructionTimer = 0.02f;
-      continue;
-    }
+  unsigned int shader = 0;
+  unsigned int texture = 0;
+  int blendMode = BLEND_ALPHA;
 
-    if (projectiles[i].canBounce && projectiles[i].type == PROJECTILE_REGULAR) {
-      float r = projectiles[i].radius;
-      Vector2 o = projectiles[i].origin;
+  for (int i = 0; i < drawQueue.len; i++) {
+    const DrawCommand *c = &drawQueue.commands[i];
 
-      #define PROJECTILE_LIFETIME_AFTER_BOUNCE 0.25f
-      if ((o.x - r) <= 0) {
-        projectiles[i].delta = Vector2Reflect(projectiles[i].delta,
-                                              normalRight);
-        projectiles[i].lifetime = MIN(PROJECTILE_LIFETIME_AFTER_BOUNCE, projectiles[i].lifetime);
-      }
+    if (c->blendMode != blendMode) {
+      BeginBlendMode(c->blendMode);
+      blendMode = c->blendMode;
+    }
 
-      if ((o.x + r) >= LEVEL_WIDTH - 1) {
-        projectiles[i].delta = Vector2Reflect(projectiles[i].delta,
-                                              normalLeft);
-        projectiles[i].lifetime = MIN(PROJECTILE_LIFETIME_AFTER_BOUNCE, projectiles[i].lifetime);
+    if (c->shader.id != shader) {
+      if (shader != 0) {
+        EndShaderMode();
       }
 
-      if ((o.y - r) <= 0) {
-        projectiles[i].delta = Vector2Reflect(projectiles[i].delta,
-                                              normalDown);
-        projectiles[i].lifetime = MIN(PROJECTILE_LIFETIME_AFTER_BOUNCE, projectiles[i].lifetime);
+      if (c->shader.id != 0) {
+        BeginShaderMode(c->shader);
       }
 
-      if ((o.y + r) >= LEVEL_HEIGHT - 1) {
-        projectiles[i].delta = Vector2Reflect(projectiles[i].delta,
-                                              normalUp);
-        projectiles[i].lifetime = MIN(PROJECTILE_LIFETIME_AFTER_BOUNCE, projectiles[i].lifetime);
-      }
-    } else if ((projectiles[i].origin.x <= 0) ||
-               (projectiles[i].origin.y <= 0) ||
-               (projectiles[i].origin.x >= (LEVEL_WIDTH - 1)) ||
-               (projectiles[i].origin.y >= (LEVEL_HEIGHT - 1))) {
-      projectiles[i].origin.x = Clamp(projectiles[i].origin.x,
-                                      0,
-                                      LEVEL_WIDTH - 1);
-      projectiles[i].origin.y = Clamp(projectiles[i].origin.y,
-                                      0,
-                                      LEVEL_HEIGHT - 1);
-
-      projectiles[i].willBeDestroyed = true;
-      projectiles[i].destructionTimer = 0.05f;
-      continue;
+      shader = c->shader.id;
+      texture = 0;
     }
 
-    switch (projectiles[i].type) {
-    case PROJECTILE_REGULAR: checkRegularProjectileCollision(i); break;
-    case PROJECTILE_SQUARED: checkSquaredProjectileCollision(i); break;
-    case PROJECTILE_NONE: break;
+    if (c->texture.id != texture) {
+      texture = c->texture.id;
+      drawQueue.drawCalls++;
     }
 
-    if (projectiles[i].willBeDestroyed) {
-      continue;
+    switch (c->type) {
+    case DRAW_TEXTURE: DrawTexturePro(c->texture, c->source, c->dest, c->origin, c->rotation, c->tint); break;
+    case DRAW_RECTANGLE: DrawRectanglePro(c->dest, c->origin, c->rotation, c->tint); break;
+    case DRAW_CIRCLE: DrawCircleV((Vector2) {c->dest.x, c->dest.y}, c->dest.width, c->tint); break;
     }
+  }
 
-    if (projectiles[i].homesOntoPlayer && projectiles[i].type == PROJECTILE_SQUARED) {
-      Vector2 direction = Vector2Normalize(Vector2Subtract(player.position, projectiles[i].origin));
-      float speed = fabsf(Vector2Length(projectiles[i].delta)) - (GetFrameTime() * 2);
+  if (shader != 0) {
+    EndShaderMode();
+  }
 
-      speed = speed < 0.0 ? 0 : speed;
+  if (blendMode != BLEND_ALPHA) {
+    EndBlendMode();
+  }
+}
 
-      projectiles[i].delta = Vector2Scale(direction, speed);
-      projectiles[i].angle = atan2(projectiles[i].delta.y, projectiles[i].delta.x) * RAD2DEG + 90;
-    }
+#define DRAW_QUEUE_REPORT_INTERVAL 1.0
 
-    if ((playerPerks & PERK_HOMING) &&
-        projectiles[i].isHurtfulForBoss) {
-      Vector2 bossPosition = Vector2Zero();
+void reportDrawQueue(void) {
+  static double reportedAt = 0.0;
 
-      switch (currentBoss) {
-      case BOSS_MARINE: bossPosition = bossMarine.position; break;
-      case BOSS_BALL: bossPosition = bossBall.position; break;
-      }
+  if (drawQueue.len == 0 || GetTime() - reportedAt < DRAW_QUEUE_REPORT_INTERVAL) {
+    return;
+  }
 
-      Vector2 direction = Vector2Normalize(Vector2Subtract(bossPosition, projectiles[i].origin));
-      float speed = fabsf(Vector2Length(projectiles[i].delta));
+  reportedAt = GetTime();
 
-      Vector2 delta = Vector2Normalize(projectiles[i].delta);
-      delta = Vector2Lerp(delta, direction, 0.1f);
+  LOG("DRAW QUEUE: %d draws, %d draw calls, %d flushes (%d in the order they were queued)\n",
+      drawQueue.len, drawQueue.drawCalls, drawQueue.flushes, drawQueue.unsortedFlushes);
+}
 
-      projectiles[i].delta = Vector2Scale(delta, speed);
-      projectiles[i].angle = atan2(projectiles[i].delta.y, projectiles[i].delta.x) * RAD2DEG + 90;
-    }
+/* NOTE: only the part of `dest` inside the view is drawn, with the matching part of the texture */
+void drawTextureInView(Texture2D texture, Rectangle dest) {
+  Rectangle visible = GetCollisionRec(dest, worldView);
 
-    projectiles[i].origin = Vector2Add(projectiles[i].delta, projectiles[i].origin);
+  if (visible.width <= 0 || visible.height <= 0) {
+    return;
   }
-}
 
-void updatePlayerCooldowns(void) {
-  float frameTime = GetFrameTime();
+  float sx = texture.width / dest.width;
+  float sy = texture.height / dest.height;
 
-  bool dashCooldownActive = player.dashCooldown > 0.0f;
+  queueTexturePro(texture,
+                  (Rectangle) {
+                    (visible.x - dest.x) * sx,
+                    (visible.y - dest.y) * sy,
+                    visible.width * sx,
+                    visible.height * sy,
+                  },
+                  visible,
+                  Vector2Zero(),
+                  0,
+                  WHITE);
+}
 
-#define COOLDOWN_MAX 10.0f
-#define DECREASE_COOLDOWN(c) (c) = Clamp((c) - frameTime, 0.0f, COOLDOWN_MAX)
+void renderBackground() {
+  Vector2 pos = world->player.position;
 
-  DECREASE_COOLDOWN(player.fireCooldown);
-  DECREASE_COOLDOWN(player.dashCooldown);
-  DECREASE_COOLDOWN(player.iframeTimer);
+  if (world->gameState == GAME_MAIN_MENU) {
+    pos = world->mouseCursor;
+  }
 
-  frameTime *= 2;
-  DECREASE_COOLDOWN(player.dashReactivationEffectAlpha);
+  float background_x = Lerp(0, BACKGROUND_PARALLAX_OFFSET,
+                            pos.x / LEVEL_WIDTH);
 
-  DECREASE_COOLDOWN(player.healTimer);
+  float background_y = Lerp(0, BACKGROUND_PARALLAX_OFFSET,
+                            pos.y / LEVEL_HEIGHT);
 
-#undef DECREASE_COOLDOWN
+  Rectangle dest = {background_x, background_y, background.x, background.y};
 
-  if (player.dashCooldown <= 0.0f && dashCooldownActive) {
-    player.dashReactivationEffectAlpha = 0.5f;
-  }
+  drawTextureInView(nebulaTexture.texture, dest);
+
+  setDrawLayer(DRAW_LAYER_STARS);
+  beginQueuedBlendMode(BLEND_ALPHA_PREMULTIPLY); {
+    drawTextureInView(starsTexture.texture, dest);
+  }; endQueuedBlendMode();
 }
 
-void updateCamera(void) {
-  float windowWidth = GetScreenWidth();
-  float windowHeight = GetScreenHeight();
+static RenderTexture2D playerTexture = {0};
+static RenderTexture2D playerTexture1 = {0};
+static RenderTexture2D playerTexture2 = {0};
+static RenderTexture2D playerAuraTexture = {0};
 
-  float x = windowWidth / (float)screenWidth;
-  float y = windowHeight / (float)screenHeight;
+#define THRUSTERS_BOTTOM 0b0001
+#define THRUSTERS_TOP    0b0010
+#define THRUSTERS_RIGHT  0b0100
+#define THRUSTERS_LEFT   0b1000
 
-  float halfScreenWidth = (windowWidth / (2 * camera.zoom));
-  float halfScreenHeight = (windowHeight / (2 * camera.zoom));
+static Rectangle thrustersRects[] = {
+  [THRUSTERS_BOTTOM] = {
+    .x = 17,
+    .y = 30,
+    .width = 17,
+    .height = 4,
+  },
+
+  [THRUSTERS_TOP] = {
+    .x = 17,
+    .y = 16,
+    .width = 17,
+    .height = 4,
+  },
 
-  Vector2 target = player.position;
+  [THRUSTERS_LEFT] = {
+    .x = 17,
+    .y = 16,
+    .width = 3,
+    .height = 18,
+  },
 
-  Vector2 topLeft = {
-    halfScreenWidth,
-    halfScreenHeight,
-  };
+  [THRUSTERS_RIGHT] = {
+    .x = 31,
+    .y = 16,
+    .width = 3,
+    .height = 18,
+  },
+};
 
-  Vector2 bottomRight = {
-    (float)LEVEL_WIDTH - halfScreenWidth,
-    (float)LEVEL_HEIGHT - halfScreenHeight,
-  };
+int whichThrustersToUse(void) {
+  float angle = playerLookingAngle();
 
-  if (gameState == GAME_BOSS_DEAD) {
-    switch (currentBoss) {
-    case BOSS_MARINE: target = bossMarine.position; break;
-    case BOSS_BALL: target = bossBall.position; break;
-    }
+  /* angle from playerLookingAngle() function is inside of the (-180; 180) range */
 
-    topLeft = Vector2Zero();
-    bottomRight = level;
+  if (angle < 0.0f) {
+    angle = 360.0f + angle;
   }
 
-  camera.offset.x = windowWidth / 2.0f;
-  camera.offset.y = windowHeight / 2.0f;
+  angle = Clamp(angle, 0.0f, 360.0f);
 
-  camera.zoom = MIN(x, y);
+  angle += 45.0f;
 
-  if (gameState == GAME_MAIN_MENU) {
-    camera.target.x = (float)LEVEL_WIDTH / 2;
-    camera.target.y = (float)LEVEL_HEIGHT / 2;
-    return;
+  if (angle >= 360.0f) {
+    angle = angle - 360.0f;
   }
 
-  if (gameState == GAME_BOSS_INTRODUCTION) {
-    camera.target = Vector2Clamp(cameraIntroductionTarget,
-                                 topLeft,
-                                 bottomRight);
-    return;
+  Direction facing = 0;
+
+  if (angle >= 0.0f && angle <= 90.0f) {
+    facing = DIRECTION_UP;
+  } else if (angle >= 90.0f && angle <= 180.0f) {
+    facing = DIRECTION_RIGHT;
+  } else if (angle >= 180.0f && angle <= 270.0f) {
+    facing = DIRECTION_DOWN;
+  } else {
+    facing = DIRECTION_LEFT;
   }
 
-  target = Vector2Clamp(target,
-                        topLeft,
-                        bottomRight);
-  camera.target = Vector2Lerp(camera.target, target, 0.1f);
-}
+  int thrusters = 0;
 
-void initRaylib() {
-#if !defined(_DEBUG)
-  SetTraceLogLevel(LOG_NONE);
-#endif
-  InitWindow(screenWidth, screenHeight, "stribun");
-  InitAudioDevice();
+#define THRUST_RULES                            \
+  do {                                          \
+    X(UP, UP, BOTTOM);                          \
+    X(UP, LEFT, RIGHT);                         \
+    X(UP, DOWN, TOP);                           \
+    X(UP, RIGHT, LEFT);                         \
+                                                \
+    X(LEFT, UP, LEFT);                          \
+    X(LEFT, LEFT, BOTTOM);                      \
+    X(LEFT, DOWN, RIGHT);                       \
+    X(LEFT, RIGHT, TOP);                        \
+                                                \
+    X(DOWN, UP, TOP);                           \
+    X(DOWN, LEFT, LEFT);                        \
+    X(DOWN, DOWN, BOTTOM);                      \
+    X(DOWN, RIGHT, RIGHT);                      \
+                                                \
+    X(RIGHT, UP, RIGHT);                        \
+    X(RIGHT, LEFT, TOP);                        \
+    X(RIGHT, DOWN, LEFT);                       \
+    X(RIGHT, RIGHT, BOTTOM);                    \
+  } while (0)
 
-#if defined(PLATFORM_DESKTOP)
-  SetExitKey(KEY_NULL);
-  SetWindowState(FLAG_WINDOW_RESIZABLE | FLAG_WINDOW_MAXIMIZED | FLAG_BORDERLESS_WINDOWED_MODE);
-#endif
+#define X(f, m, t) if (facing == DIRECTION_##f && world->player.movementDirection & DIRECTION_##m) thrusters |= THRUSTERS_##t
 
-  /* fix fragTexCoord for rectangles */
-  Texture2D t = { rlGetTextureIdDefault(), 1, 1, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
-  SetShapesTexture(t, (Rectangle){ 0.0f, 0.0f, 1.0f, 1.0f });
+  THRUST_RULES;
+
+#undef X
+#undef THRUST_RULES
+
+  return thrusters;
 }
 
-void initBackgroundAsteroid(void) {
-  bigAssAsteroidPosition.x = (float) GetRandomValue(0, LEVEL_WIDTH);
-  bigAssAsteroidPosition.y = (float) GetRandomValue(0, LEVEL_HEIGHT);
+static Vector2 thrustersOffsets[] = {
+  [THRUSTERS_BOTTOM] = {0, 14},
+  [THRUSTERS_TOP] = {0, 0},
+  [THRUSTERS_LEFT] = {0, 0},
+  [THRUSTERS_RIGHT] = {14, 0},
+};
 
-  bigAssAsteroidAngle = (float) GetRandomValue(0, 360);
+/* draws the thrusters as they sit on a ship centered on `position`, turned by `angle` */
+void renderThrustersAt(int thrusters, Vector2 position, float angle, float scale, Color tint) {
+  int all[] = {THRUSTERS_BOTTOM, THRUSTERS_TOP, THRUSTERS_LEFT, THRUSTERS_RIGHT};
 
-  bigAssAsteroidPositionDelta.x = (float)GetRandomValue(-1, 1) * 0.05f;
-  bigAssAsteroidPositionDelta.y = (float)GetRandomValue(-1, 1) * 0.05f;
+  for (int i = 0; i < 4; i++) {
+    int t = all[i];
 
-  bigAssAsteroidAngleDelta = (float)GetRandomValue(-1, 1) * 0.005f;
+    if ((thrusters & t) == 0) {
+      continue;
+    }
+
+    queueTexturePro(sprites,
+                    thrustersRects[t],
+                    (Rectangle) {
+                      .x = position.x,
+                      .y = position.y,
+                      .width = thrustersRects[t].width * scale,
+                      .height = thrustersRects[t].height * scale,
+                    },
+                    (Vector2) {
+                      .x = ((playerRect.width / 2) - thrustersOffsets[t].x) * scale,
+                      .y = ((playerRect.height / 2) - thrustersOffsets[t].y) * scale,
+                    },
+                    angle,
+                    tint);
+  }
 }
 
-void initBossBallResources(void) {
-  memset(&bossBallCamera, 0, sizeof(bossBallCamera));
-  bossBallCamera.position = (Vector3) {0, 20, 0};
-  bossBallCamera.target = (Vector3) {0, 0, 0};
-  bossBallCamera.up = (Vector3) {0, 0, -1};
-  bossBallCamera.fovy = 45.0f;
-  bossBallCamera.projection = CAMERA_PERSPECTIVE;
+#define THRUSTERS_ALPHA 0.85f
 
-  bossBallLightingShader = LoadShader(TextFormat("assets/lighting-%d.vert", GLSL_VERSION),
-                                      TextFormat("assets/lighting-%d.frag", GLSL_VERSION));
-  bossBallLightingShader.locs[SHADER_LOC_VECTOR_VIEW] =
-    GetShaderLocation(bossBallLightingShader, "viewPos");
+void renderThrusters(int thrusters) {
+  renderThrustersAt(thrusters,
+                    (Vector2) {playerRect.width / 2, playerRect.height / 2},
+                    0,
+                    1,
+                    Fade(WHITE, THRUSTERS_ALPHA));
+}
 
-  SetShaderValue(bossBallLightingShader,
-                 GetShaderLocation(bossBallLightingShader, "ambient"),
-                 (float[4]){ 0.3f, 0.3f, 0.3f, 1.0f },
-                 SHADER_UNIFORM_VEC4);
-
-  bossBallLight =
-    CreateLight(LIGHT_POINT,
-                (Vector3) {0, 10, 0},
-                Vector3Zero(),
-                WHITE,
-                bossBallLightingShader);
+/* NOTE: the trail is just where the thrusters were, it's drawn from the sprites again */
+typedef struct {
+  int thrusters;
+  Vector2 origin;
+  float angle;
+  float alpha;
+} ThrusterTrail;
 
-  bossBallTexture = LoadTexture("assets/ball.png");
+#define THRUSTER_TRAILS_MAX 10
+static ThrusterTrail thrusterTrail[THRUSTER_TRAILS_MAX] = {0};
+/* NOTE: the oldest trail, the next one to be replaced */
+static int thrusterTrailHead = 0;
 
-  bossBallModel = LoadModel("assets/ball.obj");
+ThrusterTrail *pushThrusterTrail() {
+  ThrusterTrail *t = &thrusterTrail[thrusterTrailHead];
+  thrusterTrailHead = (thrusterTrailHead + 1) % THRUSTER_TRAILS_MAX;
+  return t;
+}
 
-  SetMaterialTexture(&bossBallModel.materials[0], MATERIAL_MAP_ALBEDO, bossBallTexture);
-  bossBallModel.materials[0].shader = bossBallLightingShader;
+static Shader dashResetShader = {0};
+static int dashResetShaderAlpha = 0;
+static int dashResetShaderColor = 0;
 
-  bossBallMusic = LoadMusicStream("assets/reddream.xm");
-  SetMusicVolume(bossBallMusic, 0.5f);
-}
+/* NOTE: what the ship's textures were last drawn with, they are only redrawn when some of it changes */
+typedef struct {
+  bool valid;
+  float health;
+  float healTimer;
+  float dashReactivationEffectAlpha;
+  int thrusters;
+} PlayerTextureKey;
 
-void bossBallCheckCollisions(bool sendAsteroidsFlying) {
-  for (int ai = 0; ai < asteroidsLen; ai++) {
-    for (int abi = 0; abi < asteroids[ai].sprite->boundingCirclesLen; abi++) {
-      Vector2 pos =
-        Vector2Add(asteroids[ai].processedBoundingCircles[abi].position, asteroids[ai].position);
+static PlayerTextureKey playerTextureKey = {0};
 
-      float distance = Vector2Distance(pos, bossBall.position);
-      float radiusSum =
-        (asteroids[ai].processedBoundingCircles[abi].radius + BOSS_BALL_HITBOX_RADIUS);
+/* the ship with its damage showing */
+void renderPlayerHealthTexture(float health) {
+  BeginTextureMode(playerTexture1); {
+    ClearBackground(BLANK);
 
-      if (distance < radiusSum) {
+    DrawTexturePro(sprites,
+                   playerRect,
+                   (Rectangle) {
+                     .x = 0,
+                     .y = 0,
+                     .width = playerRect.width,
+                     .height = playerRect.height,
+                   },
+                   Vector2Zero(),
+                   0,
+                   WHITE);
 
-        if (asteroids[ai].launchedByPlayer) {
-#define ASTEROID_BASE_DAMAGE 4
-          float damageMultiplier = Vector2Length(asteroids[ai].delta);
-          bossBall.health = (int)Clamp(bossBall.health - (damageMultiplier * ASTEROID_BASE_DAMAGE),
-                                       0.0f,
-                                       BOSS_BALL_MAX_HEALTH);
-          asteroids[ai].launchedByPlayer = false;
-          bossBallStealHealth();
-        }
+    SetShaderValue(playerHealthOverlayShader,
+                   playerHealthOverlayHealth,
+                   &health,
+                   SHADER_UNIFORM_FLOAT);
 
-        float angle = angleBetweenPoints(bossBall.position, asteroids[ai].position) * DEG2RAD;
+    BeginShaderMode(playerHealthOverlayShader); {
+      DrawTexture(playerHealthMaskTexture,
+                  1, 1,
+                  WHITE);
+    } EndShaderMode();
+  } EndTextureMode();
+}
 
-        float offsetDistance = distance - radiusSum;
-        Vector2 asteroidOffset = Vector2Rotate((Vector2) {0, offsetDistance}, angle);
+/* the ship as the health bar in the corner of the screen */
+void renderPlayerHealthBarTexture(float health) {
+  BeginTextureMode(playerTexture2); {
+    ClearBackground(BLANK);
 
-        asteroids[ai].position = Vector2Add(asteroids[ai].position, asteroidOffset);
-        if (sendAsteroidsFlying) {
-          asteroids[ai].delta = Vector2Add(asteroids[ai].delta, Vector2Scale(asteroidOffset, 0.5));
-        }
-      }
-    }
-  }
+    SetShaderValue(playerHealthBarShader,
+                   playerHealthBarHealth,
+                   &health,
+                   SHADER_UNIFORM_FLOAT);
 
-  for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
-    if (!bossBall.weapons[i].isDisconnected) {
-      continue;
-    }
+    SetShaderValue(playerHealthBarShader,
+                   playerHealthBarHealTimer,
+                   &world->player.healTimer,
+                   SHADER_UNIFORM_FLOAT);
 
-    float distance = Vector2Distance(bossBall.weapons[i].position,
-                                     bossBall.position);
-    float radiusSum =
-      (bossBallWeaponHitboxRadiuses[bossBall.weapons[i].type] +
-       BOSS_BALL_HITBOX_RADIUS);
+    BeginShaderMode(playerHealthBarShader); {
+      DrawTexture(playerTexture1.texture,
+                  0, 0,
+                  WHITE);
+    }; EndShaderMode();
+  }; EndTextureMode();
+}
 
-    if (distance < radiusSum) {
-      float angle = angleBetweenPoints(bossBall.position, bossBall.weapons[i].position) * DEG2RAD;
+/* the damaged ship with the dash glow and thrusters, as it's drawn into the world */
+void renderPlayerShipTexture(int thrusters) {
+  BeginTextureMode(playerTexture); {
+    ClearBackground(BLANK);
 
-      float offsetDistance = distance - radiusSum;
-      Vector2 offset = Vector2Rotate((Vector2) {0, offsetDistance}, angle);
+    SetShaderValue(dashResetShader,
+                   dashResetShaderAlpha,
+                   &world->player.dashReactivationEffectAlpha,
+                   SHADER_UNIFORM_FLOAT);
 
-      bossBall.weapons[i].position = Vector2Add(bossBall.weapons[i].position, offset);
-    }
-  }
+    BeginShaderMode(dashResetShader); {
+      DrawTexture(playerTexture1.texture,
+                  0, 0,
+                  WHITE);
+    } EndShaderMode();
 
-  float distance = Vector2Distance(player.position, bossBall.position);
-  float radiusSum =
-    (PLAYER_HITBOX_RADIUS + BOSS_BALL_HITBOX_RADIUS);
+    renderThrusters(thrusters);
+  } EndTextureMode();
+}
 
-  if (distance < radiusSum) {
-    float angle = angleBetweenPoints(bossBall.position, player.position) * DEG2RAD;
+void renderPlayerTexture(void) {
+  int thrusters = whichThrustersToUse();
 
-    float offsetDistance = distance - radiusSum;
-    Vector2 asteroidOffset = Vector2Rotate((Vector2) {0, offsetDistance}, angle);
+  /* NOTE: the aura animates on its own, but it's only ever drawn with the perk */
+  if (world->playerPerks & PERK_OMINOUS_AURA) {
+    float t = GetTime();
 
-    player.position = Vector2Add(player.position, asteroidOffset);
+    BeginTextureMode(playerAuraTexture); {
+      ClearBackground(BLANK);
 
-    if ((player.iframeTimer <= 0.0f) &&
-        ((playerPerks & PERK_OMINOUS_AURA) == 0)) {
-      PlaySound(hit);
+      SetShaderValue(playerAuraShader,
+                     playerAuraTime,
+                     &t,
+                     SHADER_UNIFORM_FLOAT);
 
-      player.health -= 2 * (playerPerks & PERK_MORE_BULLETS ? 2 : 1);
-      player.iframeTimer = 0.4f;
-    } else if (playerPerks & PERK_OMINOUS_AURA) {
-      bossBall.health -= 2;
-    }
+      BeginShaderMode(playerAuraShader); {
+        DrawTexturePro(sprites,
+                       playerAuraRect,
+                       (Rectangle) {0, 0, PLAYER_AURA_WIDTH, PLAYER_AURA_HEIGHT},
+                       Vector2Zero(),
+                       0,
+                       WHITE);
+      }; EndShaderMode();
+    }; EndTextureMode();
   }
-}
-
-void bossBallUpdateWeapons(void);
 
-static float deadBallTimer = 0;
+  float health = (float)world->player.health / (float)MAX_PLAYER_HEALTH;
 
-void initBossBall(void) {
-  memset(&bossBall, 0, sizeof(bossBall));
-  deadBallTimer = 2.0f;
+  bool healthChanged = !playerTextureKey.valid || playerTextureKey.health != health;
+  bool healTimerChanged = !playerTextureKey.valid || playerTextureKey.healTimer != world->player.healTimer;
+  bool glowChanged = !playerTextureKey.valid ||
+    playerTextureKey.dashReactivationEffectAlpha != world->player.dashReactivationEffectAlpha ||
+    playerTextureKey.thrusters != thrusters;
 
-  bossBall = (BossBall) {
-    .position = {
-      .x = (float)LEVEL_WIDTH / 2,
-      .y = (float)LEVEL_HEIGHT / 2,
-    },
-    .standingStilTimer = 0.5f,
-    .health = BOSS_BALL_MAX_HEALTH,
+  playerTextureKey = (PlayerTextureKey) {
+    .valid = true,
+    .health = health,
+    .healTimer = world->player.healTimer,
+    .dashReactivationEffectAlpha = world->player.dashReactivationEffectAlpha,
+    .thrusters = thrusters,
   };
 
-  BossBallWeaponType types[] = {
-    BOSS_BALL_WEAPON_TURRET,
-    BOSS_BALL_WEAPON_TURRET,
-    BOSS_BALL_WEAPON_TURRET,
-    BOSS_BALL_WEAPON_TURRET,
+  if (healthChanged) {
+    renderPlayerHealthTexture(health);
+  }
 
-    BOSS_BALL_WEAPON_LASER,
-    BOSS_BALL_WEAPON_LASER,
+  if (healthChanged || healTimerChanged) {
+    renderPlayerHealthBarTexture(health);
+  }
 
-    BOSS_BALL_WEAPON_ROCKET_LAUNCHER,
-    BOSS_BALL_WEAPON_ROCKET_LAUNCHER,
+  if (healthChanged || glowChanged) {
+    renderPlayerShipTexture(thrusters);
+  }
+
+  if (thrusters == 0) {
+    return;
+  }
+
+  *pushThrusterTrail() = (ThrusterTrail) {
+    .thrusters = thrusters,
+    .origin = world->player.position,
+    .angle = playerLookingAngle(),
+    .alpha = 1.0f,
   };
+}
 
-  static_assert((sizeof(types) / sizeof(types[0])) == BOSS_BALL_WEAPONS, "asdf");
+void renderPlayer(void) {
+  float alpha = 1.0;
 
-  int i = 0;
-  while (i < BOSS_BALL_WEAPONS) {
-    int index = GetRandomValue(0, BOSS_BALL_WEAPONS - 1);
-    if (types[index] == BOSS_BALL_WEAPON_NONE) {
-      continue;
-    }
+  if (world->player.iframeTimer > 0.0f) {
+    float a = sinf(GetTime() * 40) * .5 + 1.;
+    alpha = Remap(a, 0, 1, 0.7, 1.0);
+  }
 
-    bossBall.weapons[i] = (BossBallWeapon) {
-      .type = types[index],
-      .angle = 45 * i,
-      .fireCooldown = (float)GetRandomValue(1, 15) / 10.0f,
-      .isDisconnected = false,
-      .deactivationDark = 1.0f,
-    };
+  if (world->playerPerks & PERK_OMINOUS_AURA) {
+    /* NOTE: under the ship, even though its texture may sort after the ship's */
+    setDrawLayer(DRAW_LAYER_AURA);
+    queueTexturePro(playerAuraTexture.texture,
+                    (Rectangle) {
+                      .x = 0,
+                      .y = 0,
+                      .width  = playerAuraTexture.texture.width,
+                      .height = -playerAuraTexture.texture.height,
+                    },
+                    (Rectangle) {
+                      .x = world->player.position.x,
+                      .y = world->player.position.y,
+                      .width  = playerAuraTexture.texture.width,
+                      .height = playerAuraTexture.texture.height,
+                    },
+                    (Vector2) {
+                      .x = 0.5f * playerAuraTexture.texture.width,
+                      .y = 0.5f * playerAuraTexture.texture.height,
+                    },
+                    playerLookingAngle(),
+                    WHITE);
+    setDrawLayer(DRAW_LAYER_SHIPS);
+  }
+
+  queueTexturePro(playerTexture.texture,
+                  (Rectangle) {
+                    .x = 0,
+                    .y = 0,
+                    .width = playerTexture.texture.width,
+                    .height = playerTexture.texture.height,
+                  },
+                  (Rectangle) {
+                    .x = world->player.position.x,
+                    .y = world->player.position.y,
+                    .width = playerTexture.texture.width * SPRITES_SCALE,
+                    .height = playerTexture.texture.height * SPRITES_SCALE,
+                  },
+                  (Vector2) {
+                    .x = (playerRect.width * SPRITES_SCALE) / 2,
+                    .y = (playerRect.height * SPRITES_SCALE) / 2,
+                  },
+                  playerLookingAngle(),
+                  ColorAlpha(WHITE, alpha));
+}
 
-    if (types[index] == BOSS_BALL_WEAPON_LASER) {
-      bossBall.weapons[i].soundEffect = LoadMusicStream("assets/laser.wav");
-      SetMusicVolume(bossBall.weapons[i].soundEffect, 1.5f);
-    }
+void renderWingman(void) {
+  float alpha = 1.0;
 
-    types[index] = BOSS_BALL_WEAPON_NONE;
-    i++;
+  if (world->wingman.iframeTimer > 0.0f) {
+    float a = sinf(GetTime() * 40) * .5 + 1.;
+    alpha = Remap(a, 0, 1, 0.7, 1.0);
   }
 
-  bossBall.targetPosition = bossBall.position;
-  bossBall.startingPosition = bossBall.position;
+  float angle = Vector2Angle((Vector2) {0, -1}, world->wingmanLookingDirection) * RAD2DEG;
 
-  bossBallCheckCollisions(false);
-  bossBallUpdateWeapons();
+  queueTexturePro(sprites,
+                  playerRect,
+                  (Rectangle) {
+                    .x = world->wingman.position.x,
+                    .y = world->wingman.position.y,
+                    .width = playerRect.width * SPRITES_SCALE,
+                    .height = playerRect.height * SPRITES_SCALE,
+                  },
+                  (Vector2) {
+                    .x = (playerRect.width * SPRITES_SCALE) / 2,
+                    .y = (playerRect.height * SPRITES_SCALE) / 2,
+                  },
+                  angle,
+                  ColorAlpha(GOLD, alpha));
 }
 
-void initBossMarine(void) {
-  memset(&bossMarine, 0, sizeof(bossMarine));
-  bossMarineLastAttack = 0;
-
-  bossMarine = (BossMarine) {
-    .position = {
-      .x = (float)LEVEL_WIDTH / 2,
-      .y = (float)LEVEL_HEIGHT / 2,
-    },
-    .health = BOSS_MARINE_MAX_HEALTH,
-    .boundingCircles = {
-      {{4, -25}, 12},
-      {{25, -14}, 5},
-      {{2, 22}, 15},
-      {{0, 12}, 14},
-      {{7, 10}, 12},
-      {{13, 0}, 7},
-      {{-14, 2}, 8},
-      {{-23, -9}, 12},
-      {{-10, -8}, 14},
-      {{6, -8}, 8},
-      {{17, -11}, 9},
-      {{27, -5}, 8},
-    },
-    .weaponAngle = 0,
-    .horizontalFlip = 1,
-    .walkingDirection = 1,
-    .weaponOffset = bossMarineInitialWeaponOffset,
-  };
+void renderDashTrails(void) {
+  Vector4 color = ColorNormalize(SKYBLUE);
 
-  for (int i = 0; i < BOSS_MARINE_BOUNDING_CIRCLES; i++) {
-    bossMarine.boundingCircles[i].position =
-      Vector2Scale(bossMarine.boundingCircles[i].position,
-                   SPRITES_SCALE);
-    bossMarine.boundingCircles[i].radius *= SPRITES_SCALE;
+  if (world->playerPerks & PERK_STRONG_DASH) {
+    color = ColorNormalize(RED);
   }
 
-  bossMarineCheckCollisions(false);
-};
+  SetShaderValue(dashTrailShader,
+                 dashTrailShaderColor,
+                 &color,
+                 SHADER_UNIFORM_VEC4);
 
-void initMusic(void) {
-  mainMenuMusic = LoadMusicStream("assets/drozerix_-_stardust_jam.mod");
-  SetMusicVolume(mainMenuMusic, 0.6);
+  for (int i = 0; i < world->dashTrails.pool.len; i++) {
+    float w = playerRect.width * SPRITES_SCALE;
+    float h = playerRect.height * SPRITES_SCALE;
 
-  bossMarineMusic = LoadMusicStream("assets/once_is_not_enough.mod");
-  SetMusicVolume(bossMarineMusic, 0.5);
+    if (!isInWorldView(CULL_DASH_TRAILS, world->dashTrails.items[i].position, sqrtf(w * w + h * h) / 2)) {
+      continue;
+    }
+
+    /* NOTE: the alpha comes in the tint, so that all trails share one batch */
+    beginQueuedShader(dashTrailShader); {
+      queueTexturePro(sprites,
+                      playerRect,
+                      (Rectangle) {
+                        .x = world->dashTrails.items[i].position.x,
+                        .y = world->dashTrails.items[i].position.y,
+                        .width = w,
+                        .height = h,
+                      },
+                      (Vector2) {w / 2, h / 2},
+                      world->dashTrails.items[i].angle,
+                      ColorAlpha(WHITE, world->dashTrails.items[i].alpha));
+    }; endQueuedShader();
+  }
 }
 
-void initMouse(void) {
-  DisableCursor();
+void renderThrusterTrails(void) {
+  /* NOTE: oldest first, so that newer trails are drawn over them */
+  for (int k = 0; k < THRUSTER_TRAILS_MAX; k++) {
+    const ThrusterTrail *t = &thrusterTrail[(thrusterTrailHead + k) % THRUSTER_TRAILS_MAX];
 
-  screenMouseLocation = (Vector2) {
-    .x = (float)screenWidth / 2,
-    .y = ((float)screenHeight / 6),
-  };
-}
+    if (t->alpha <= 0.0f) {
+      continue;
+    }
 
-void initPlayer(void) {
-  memset(&player, 0, sizeof(player));
-  memset(&dashTrails, 0, sizeof(dashTrails));
+    /* NOTE: the thrusters are inside the ship's rectangle */
+    float radius = Vector2Length((Vector2) {playerRect.width, playerRect.height}) * SPRITES_SCALE / 2;
 
-  player = (Player) {
-    .position = (Vector2) {
-      .x = (float)LEVEL_WIDTH / 2,
-      .y = LEVEL_HEIGHT + ((float)LEVEL_HEIGHT / 6),
-    },
-    .isInvincible = false,
-    .health = MAX_PLAYER_HEALTH,
-  };
-}
+    if (!isInWorldView(CULL_THRUSTER_TRAILS, t->origin, radius)) {
+      continue;
+    }
 
-void initCamera(void) {
-  camera.rotation = 0;
-  camera.zoom = 1;
+    renderThrustersAt(t->thrusters, t->origin, t->angle, SPRITES_SCALE, Fade(WHITE, THRUSTERS_ALPHA * t->alpha));
+  }
 }
 
-void initProjectiles(void) {
-  memset(projectiles, 0, sizeof(projectiles));
+void updateThrusterTrails(void) {
+  for (int i = 0; i < THRUSTER_TRAILS_MAX; i++) {
+    if (thrusterTrail[i].alpha <= 0.0f) {
+      continue;
+    }
+
+#define THRUSTER_TRAIL_FADE 0.2f
+    thrusterTrail[i].alpha = Clamp(thrusterTrail[i].alpha - (THRUSTER_TRAIL_FADE * frameSteps()), 0.0f, 1.0f);
+  }
 }
 
-void initAsteroids(void) {
-  const int maxAsteroidSprites = (sizeof(asteroidSprites) / sizeof(asteroidSprites[0]));
+#define MOUSE_CURSOR_SCALE (SPRITES_SCALE)
+void renderMouseCursor(void) {
+  DrawTexturePro(sprites,
+                 mouseCursorRect,
+                 (Rectangle) {
+                   .x = screenMouseLocation.x,
+                   .y = screenMouseLocation.y,
+                   .width = mouseCursorRect.width * MOUSE_CURSOR_SCALE,
+                   .height = mouseCursorRect.height * MOUSE_CURSOR_SCALE,
+                 },
+                 (Vector2) {
+                   .x = (mouseCursorRect.width * MOUSE_CURSOR_SCALE) / 2,
+                   .y = (mouseCursorRect.height * MOUSE_CURSOR_SCALE) / 2,
+                 }, 0, WHITE);
+}
 
-  for (int i = 0; i < maxAsteroidSprites; i++) {
-    if (asteroidSprites[i].palette != NULL) {
-      break;
+#define PROJECTILE_BORDER 3
+
+void renderProjectiles(void) {
+  for (int i = 0; i < world->projectiles.pool.len; i++) {
+    float radiusScale = world->projectiles.items[i].willBeDestroyed ? 1.5f : 1.0f;
+
+    float radius = world->projectiles.items[i].type == PROJECTILE_SQUARED
+      ? Vector2Length(world->projectiles.items[i].size) / 2
+      : world->projectiles.items[i].radius;
+
+    if (!isInWorldView(CULL_PROJECTILES, world->projectiles.items[i].origin, radius * radiusScale)) {
+      continue;
     }
 
-    Image a = LoadImageFromTexture(sprites);
-    ImageCrop(&a, asteroidSprites[i].textureRect);
-    asteroidSprites[i].palette = LoadImagePalette(a, MAX_ASTEROID_PALETTE_SIZE, &asteroidSprites[i].paletteLen);
-    UnloadImage(a);
-  }
+    switch (world->projectiles.items[i].type) {
+    case PROJECTILE_REGULAR: {
+      queueCircleV(world->projectiles.items[i].origin,
+                   world->projectiles.items[i].radius * radiusScale,
+                   world->projectiles.items[i].outside);
+
+      if (world->projectiles.items[i].willBeDestroyed) {
+        break;
+      }
 
-  asteroidsLen = GetRandomValue(MIN_ASTEROIDS, MAX_ASTEROIDS - 1);
+      queueCircleV(world->projectiles.items[i].origin,
+                   world->projectiles.items[i].radius - PROJECTILE_BORDER,
+                   world->projectiles.items[i].inside);
+    } break;
+    case PROJECTILE_SQUARED: {
+      Rectangle shape = (Rectangle) {
+        .x = world->projectiles.items[i].origin.x,
+        .y = world->projectiles.items[i].origin.y,
+        .width = world->projectiles.items[i].size.x * radiusScale,
+        .height = world->projectiles.items[i].size.y * radiusScale,
+      };
 
-  for (int i = 0; i < asteroidsLen; i++) {
-    int asteroidSpriteIndex = GetRandomValue(0, maxAsteroidSprites - 1);
+      queueRectanglePro(shape,
+                        (Vector2) {
+                          .x = shape.width / 2,
+                          .y = shape.height / 2,
+                        },
+                        world->projectiles.items[i].angle,
+                        world->projectiles.items[i].outside);
 
-    int w = (int)asteroidSprites[asteroidSpriteIndex].textureRect.width;
-    int h = (int)asteroidSprites[asteroidSpriteIndex].textureRect.height;
+      if (world->projectiles.items[i].willBeDestroyed) {
+        break;
+      }
 
-    asteroids[i].sprite = &asteroidSprites[asteroidSpriteIndex];
-    asteroids[i].angle = (float)GetRandomValue(0, 360) - 180;
-    asteroids[i].angleDelta = (float)GetRandomValue(-8, 8) / 64.0f;
-    asteroids[i].position.x = (float)GetRandomValue(w, LEVEL_WIDTH - w);
-    asteroids[i].position.y = (float)GetRandomValue(h, LEVEL_WIDTH - h);
-    asteroids[i].delta = (Vector2) {
-      .x = (float)GetRandomValue(-8, 8) / 64.0f,
-      .y = (float)GetRandomValue(-8, 8) / 64.0f,
-    };
+      shape.width -= PROJECTILE_BORDER * 2;
+      shape.height -= PROJECTILE_BORDER * 2;
+
+      queueRectanglePro(shape,
+                        (Vector2) {
+                          .x = shape.width / 2,
+                          .y = shape.height / 2,
+                        },
+                        world->projectiles.items[i].angle,
+                        world->projectiles.items[i].inside);
+    } break;
+    }
   }
 }
 
-void initSoundEffects(void) {
-  dashSoundEffect = LoadSound("assets/dash.wav");
-  SetSoundVolume(dashSoundEffect, 0.3);
-
-  playerShot = LoadSound("assets/shot01.wav");
-  SetSoundVolume(playerShot, 0.5);
+Vector2 arenaTopLeft = {0};
+Vector2 arenaBottomRight = {0};
 
-  beep = LoadSound("assets/beep.wav");
-  hit = LoadSound("assets/hit.wav");
-  SetSoundVolume(hit, 0.7);
+void renderArenaBorder(void) {
+  float t = GetTime();
 
-  playerHealSound = LoadSound("assets/heal.wav");
-  /* SetSoundVolume(playerHealSound, 0.5); */
+  SetShaderValue(arenaBorderShader,
+                 arenaBorderTime,
+                 &t,
+                 SHADER_UNIFORM_FLOAT);
 
-  buttonFocusEffect = LoadSound("assets/hit.wav");
-  SetSoundVolume(buttonFocusEffect, 0.1);
+  Vector2 arenaSize = Vector2Subtract(arenaBottomRight, arenaTopLeft);
+  beginQueuedShader(arenaBorderShader); {
+    queueRectanglePro((Rectangle) {arenaTopLeft.x, arenaTopLeft.y, arenaSize.x, arenaSize.y},
+                      Vector2Zero(),
+                      0,
+                      BLUE);
+  } endQueuedShader();
+}
 
-  borderActivation = LoadSound("assets/border.wav");
-  SetSoundVolume(borderActivation, 0.3);
+void renderAsteroids(void) {
+  for (int i = 0; i < world->asteroidsLen; i++) {
+    Vector2 center = {
+      .x = (world->asteroids[i].sprite->textureRect.width * SPRITES_SCALE) / 2,
+      .y = (world->asteroids[i].sprite->textureRect.height * SPRITES_SCALE) / 2,
+    };
 
-  bossMarineShotgunSound = LoadSound("assets/shot02.wav");
-  bossMarineGunshotSound = LoadSound("assets/shot03.wav");
+    if (!isInWorldView(CULL_ASTEROIDS, world->asteroids[i].position, Vector2Length(center))) {
+      continue;
+    }
 
-  bossBallTurretSound = LoadSound("assets/shot03.wav");
+    queueTexturePro(sprites,
+                    world->asteroids[i].sprite->textureRect,
+                    (Rectangle) {
+                      .x = world->asteroids[i].position.x,
+                      .y = world->asteroids[i].position.y,
+                      .width = world->asteroids[i].sprite->textureRect.width * SPRITES_SCALE,
+                      .height = world->asteroids[i].sprite->textureRect.height * SPRITES_SCALE,
+                    },
+                    center,
+                    world->asteroids[i].angle,
+                    WHITE);
+  }
+}
 
-  playerDeathSound = LoadSound("assets/dead.wav");
+void renderBackgroundAsteroid(void) {
+  Vector2 center = {
+    .x = (bigAssAsteroidRect.width * BIG_ASS_ASTEROID_SCALE) / 2,
+    .y = (bigAssAsteroidRect.height * BIG_ASS_ASTEROID_SCALE) / 2,
+  };
 
-  bossBallLaserChargingSound = LoadSound("assets/laser-charging.wav");
-  SetSoundVolume(bossBallLaserChargingSound, 0.5);
+  if (!isInWorldView(CULL_BACKGROUND_ASTEROID, bigAssAsteroidPosition, Vector2Length(center))) {
+    return;
+  }
 
-  bossBallRocketSound = LoadSound("assets/rocket.wav");
+  queueTexturePro(sprites,
+                  bigAssAsteroidRect,
+                  (Rectangle) {
+                    .x = bigAssAsteroidPosition.x,
+                    .y = bigAssAsteroidPosition.y,
+                    .width = bigAssAsteroidRect.width * BIG_ASS_ASTEROID_SCALE,
+                    .height = bigAssAsteroidRect.height * BIG_ASS_ASTEROID_SCALE,
+                  },
+                  center,
+                  bigAssAsteroidAngle,
+                  GRAY);
+}
 
-  bossBallDeath = LoadSound("assets/explosion.wav");
+/* code stolen from the `GetMouseRay` function, because it assumes window size */
+Ray traceRay(Vector2 pos, Camera camera) {
+  Ray ray = { 0 };
 
-  asteroidDestructionSound = LoadSound("assets/boom.wav");
-}
+  float x = (2.0f*pos.x)/(float)LEVEL_WIDTH - 1.0f;
+  float y = 1.0f - (2.0f*pos.y)/(float)LEVEL_HEIGHT;
+  float z = 1.0f;
 
-void initShaders(void) {
-  {
-#define NEBULAE_NOISE_DOWNSCALE_FACTOR 1
+  Vector3 deviceCoords = { x, y, z };
 
-    Image n = GenImagePerlinNoise(background.x / NEBULAE_NOISE_DOWNSCALE_FACTOR,
-                                  background.y / NEBULAE_NOISE_DOWNSCALE_FACTOR,
-                                  0, 0, 4);
+  Matrix matView = MatrixLookAt(camera.position, camera.target, camera.up);
+  Matrix matProj = MatrixIdentity();
 
-    nebulaNoise = LoadTextureFromImage(n);
-    /* SetTextureFilter(nebulaNoise, TEXTURE_FILTER_BILINEAR); */
-    UnloadImage(n);
-  }
+  matProj = MatrixPerspective(camera.fovy*DEG2RAD, ((double)LEVEL_WIDTH/(double)LEVEL_HEIGHT), RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
 
-  {
-    Vector4 arenaBorderColor0 = ColorNormalize(DARKBLUE);
-    Vector4 arenaBorderColor1 = ColorNormalize(BLUE);
+  Vector3 nearPoint = Vector3Unproject((Vector3){ deviceCoords.x, deviceCoords.y, 0.0f }, matProj, matView);
+  Vector3 farPoint = Vector3Unproject((Vector3){ deviceCoords.x, deviceCoords.y, 1.0f }, matProj, matView);
 
-    arenaBorderShader = LoadShader(NULL, TextFormat("assets/border-%d.frag", GLSL_VERSION));
-    arenaBorderTime = GetShaderLocation(arenaBorderShader, "time");
-    SetShaderValue(arenaBorderShader,
-                   GetShaderLocation(arenaBorderShader, "borderColor0"),
-                   &arenaBorderColor0,
-                   SHADER_ATTRIB_VEC4);
-    SetShaderValue(arenaBorderShader,
-                   GetShaderLocation(arenaBorderShader, "borderColor1"),
-                   &arenaBorderColor1,
-                   SHADER_ATTRIB_VEC4);
-    SetShaderValue(arenaBorderShader,
-                   GetShaderLocation(arenaBorderShader, "resolution"),
-                   &level,
-                   SHADER_ATTRIB_VEC2);
+  Vector3 direction = Vector3Normalize(Vector3Subtract(farPoint, nearPoint));
 
-  }
+  ray.position = camera.position;
+  ray.direction = direction;
 
-  {
-    Vector4 dashResetGlowColor = ColorNormalize(ColorAlpha(SKYBLUE, 0.1f));
+  return ray;
+}
 
-    dashResetShader = LoadShader(NULL, TextFormat("assets/dash-reset-glow-%d.frag", GLSL_VERSION));
-    dashResetShaderAlpha = GetShaderLocation(dashResetShader, "alpha");
-    dashResetShaderColor = GetShaderLocation(dashResetShader, "glowColor");
+/* NOTE: where the ball's frame of the atlas is in its texture, flipped like every render texture */
+Rectangle bossBallImpostorFrame(Vector3 axis, float angle) {
+  int x = (int)axis.x;
+  int z = (int)axis.z;
+  float direction = 1.0f;
 
-    SetShaderValue(dashResetShader, dashResetShaderColor, &dashResetGlowColor, SHADER_UNIFORM_VEC4);
+  if (x < 0 || (x == 0 && z < 0)) {
+    x = -x;
+    z = -z;
+    direction = -1.0f;
   }
 
-  {
-    stars = LoadShader(NULL, TextFormat("assets/stars-%d.frag", GLSL_VERSION));
-    starsTime = GetShaderLocation(stars, "time");
+  int row = 0;
+  for (int i = 0; i < BOSS_BALL_IMPOSTOR_AXES; i++) {
+    if (bossBallImpostorAxes[i][0] == x && bossBallImpostorAxes[i][1] == z) {
+      row = i;
+    }
+  }
 
-    SetShaderValue(stars,
-                   GetShaderLocation(stars, "resolution"),
-                   &background,
-                   SHADER_UNIFORM_VEC2);
+  int frame = (int)roundf(direction * angle / 360.0f * BOSS_BALL_IMPOSTOR_FRAMES);
+  frame = ((frame % BOSS_BALL_IMPOSTOR_FRAMES) + BOSS_BALL_IMPOSTOR_FRAMES) % BOSS_BALL_IMPOSTOR_FRAMES;
 
-    starsDom = GetShaderLocation(stars, "dom");
-  }
+  int index = row * BOSS_BALL_IMPOSTOR_FRAMES + frame;
+  float size = bossBallTarget.texture.width;
 
-  {
-    playerHealthBarShader = LoadShader(NULL, TextFormat("assets/health-bar-%d.frag", GLSL_VERSION));
-    Vector4 good = ColorNormalize((Color) {129, 73, 151, 255});
-    Vector4 bad = ColorNormalize(BLACK);
+  return (Rectangle) {
+    (index % BOSS_BALL_IMPOSTOR_COLUMNS) * size,
+    bossBallImpostorAtlas.texture.height - ((index / BOSS_BALL_IMPOSTOR_COLUMNS) + 1) * size,
+    size,
+    -size,
+  };
+}
 
-    SetShaderValue(playerHealthBarShader,
-                   GetShaderLocation(playerHealthBarShader, "goodColor"),
-                   &good,
-                   SHADER_UNIFORM_VEC4);
-    SetShaderValue(playerHealthBarShader,
-                   GetShaderLocation(playerHealthBarShader, "badColor"),
-                   &bad,
-                   SHADER_UNIFORM_VEC4);
-    playerHealthBarHealth = GetShaderLocation(playerHealthBarShader, "health");
+/* NOTE: snapped to the pixel grid, so the big pixels don't crawl when the ball moves */
+Rectangle bossBallRectAt(Vector2 position) {
+  float size = bossBallTarget.texture.width * BOSS_BALL_PIXEL_SIZE;
 
-    playerHealthBarHealTimer = GetShaderLocation(playerHealthBarShader, "healTimer");
-    int shaderHealColor = GetShaderLocation(playerHealthBarShader, "healColor");
-    Vector4 healColor = ColorNormalize(ColorAlpha(GREEN, 0.1));
+  return (Rectangle) {
+    .x = floorf((position.x - size / 2) / BOSS_BALL_PIXEL_SIZE) * BOSS_BALL_PIXEL_SIZE,
+    .y = floorf((position.y - size / 2) / BOSS_BALL_PIXEL_SIZE) * BOSS_BALL_PIXEL_SIZE,
+    .width = size,
+    .height = size,
+  };
+}
 
-    SetShaderValue(playerHealthBarShader,
-                   shaderHealColor,
-                   &healColor,
-                   SHADER_UNIFORM_VEC4);
+void renderBossBall(void) {
+  if (bossBallImpostor) {
+    queueTexturePro(bossBallImpostorAtlas.texture,
+                    bossBallImpostorFrame(world->bossBall.rotationAxis, world->bossBall.angle),
+                    bossBallRectAt(world->bossBall.position),
+                    Vector2Zero(),
+                    0,
+                    WHITE);
+    return;
   }
 
-  {
-    playerHealthOverlayShader = LoadShader(NULL, TextFormat("assets/health-overlay-%d.frag", GLSL_VERSION));
-
-    /* Vector4 good = ColorNormalize((Color) {164, 36, 40, 255}); */
-    Vector4 good = ColorNormalize((Color) {129, 73, 151, 255});
-    SetShaderValue(playerHealthOverlayShader,
-                   GetShaderLocation(playerHealthOverlayShader, "goodColor"),
-                   &good,
-                   SHADER_UNIFORM_VEC4);
+  queueTexturePro(bossBallTarget.texture,
+                  (Rectangle) {
+                    0, 0,
+                    bossBallTarget.texture.width, -bossBallTarget.texture.height
+                  },
+                  bossBallTargetRect,
+                  Vector2Zero(),
+                  0,
+                  WHITE);
+}
 
-    /* Vector4 bad = ColorNormalize((Color) {69, 69, 69, 255}); */
-    Vector4 bad = ColorNormalize(BLACK);
-    SetShaderValue(playerHealthOverlayShader,
-                   GetShaderLocation(playerHealthOverlayShader, "badColor"),
-                   &bad,
-                   SHADER_UNIFORM_VEC4);
+void renderBossBallWeapon(int i, float angle) {
+  Rectangle r = bossBallWeaponRects[world->bossBall.weapons[i].type];
 
-    playerHealthOverlayHealth = GetShaderLocation(playerHealthOverlayShader, "health");
+  Color color = ColorFromHSV(0, 0, world->bossBall.weapons[i].deactivationDark);
 
-    Image mask = LoadImage("assets/sprites.png");
-    ImageCrop(&mask, playerHealthOverlayMaskRect);
-    playerHealthMaskTexture = LoadTextureFromImage(mask);
-    UnloadImage(mask);
+  queueTexturePro(sprites,
+                  r,
+                  (Rectangle) {
+                    .x = world->bossBall.weapons[i].position.x,
+                    .y = world->bossBall.weapons[i].position.y,
+                    .width = r.width * SPRITES_SCALE,
+                    .height = r.height * SPRITES_SCALE,
+                  },
+                  (Vector2) {
+                    .x = (r.width * SPRITES_SCALE) * 0.5f,
+                    .y = (r.height * SPRITES_SCALE) * 0.5f,
+                  },
+                  angle,
+                  color);
+
+  if (world->bossBall.weapons[i].type == BOSS_BALL_WEAPON_LASER) {
+    queueTexturePro(sprites,
+                    bossBallChargedLaserRect,
+                    (Rectangle) {
+                      .x = world->bossBall.weapons[i].position.x,
+                      .y = world->bossBall.weapons[i].position.y,
+                      .width = r.width * SPRITES_SCALE,
+                      .height = r.height * SPRITES_SCALE,
+                    },
+                    (Vector2) {
+                      .x = (r.width * SPRITES_SCALE) * 0.5f,
+                      .y = (r.height * SPRITES_SCALE) * 0.5f,
+                    },
+                    angle,
+                    ColorAlpha(color, world->bossBall.weapons[i].chargeLevel));
   }
+}
 
-  {
-    dashTrailShader = LoadShader(NULL, TextFormat("assets/dash-trail-%d.frag", GLSL_VERSION));
-    dashTrailShaderColor = GetShaderLocation(dashTrailShader, "trailColor");
-    dashTrailShaderAlpha = GetShaderLocation(dashTrailShader, "alpha");
+void renderBossBallDisconnectedWeapons(void) {
+  for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
+    if (!world->bossBall.weapons[i].isDisconnected) {
+      continue;
+    }
+
+    renderBossBallWeapon(i, world->bossBall.weapons[i].angle);
   }
+}
 
-  {
-    pixelationShader = LoadShader(NULL, TextFormat("assets/pixelation-%d.frag", GLSL_VERSION));
-    SetShaderValue(pixelationShader,
-                   GetShaderLocation(pixelationShader, "resolution"),
-                   &level,
-                   SHADER_UNIFORM_VEC2);
+void renderBossBallConnectedWeapons(void) {
+  for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
+    if (world->bossBall.weapons[i].isDisconnected) {
+      continue;
+    }
 
-    pixelationShaderPixelSize = GetShaderLocation(pixelationShader, "pixelSize");
+    renderBossBallWeapon(i, world->bossBall.weapons[i].angle +
+                         world->bossBall.weapons[i].angleOffset +
+                         world->bossBall.weaponAngleOffset);
   }
+}
 
-  {
-    laserShader = LoadShader(NULL, TextFormat("assets/laser-%d.frag", GLSL_VERSION));
-    SetShaderValue(laserShader,
-                   GetShaderLocation(laserShader, "resolution"),
-                   (float[2]){LASER_WIDTH, LASER_HEIGHT},
-                   SHADER_UNIFORM_VEC2);
+/* NOTE: the level rectangle the ball covers when its center is at `center` */
+Rectangle bossBallProjectedBounds(Vector3 center) {
+  Vector2 min = {FLOAT_MAX, FLOAT_MAX};
+  Vector2 max = {-FLOAT_MAX, -FLOAT_MAX};
 
-    laserShaderTime = GetShaderLocation(laserShader, "time");
-  }
+  /* NOTE: the corners of the cube around the ball project onto a rectangle that covers the ball */
+  for (int i = 0; i < 8; i++) {
+    Vector3 corner = {
+      center.x + ((i & 1) ? bossBallRadius : -bossBallRadius),
+      center.y + ((i & 2) ? bossBallRadius : -bossBallRadius),
+      center.z + ((i & 4) ? bossBallRadius : -bossBallRadius),
+    };
 
-  {
-    playerAuraShader = LoadShader(NULL, TextFormat("assets/aura-%d.frag", GLSL_VERSION));
-    playerAuraTime = GetShaderLocation(playerAuraShader, "time");
+    Vector2 p = GetWorldToScreenEx(corner, bossBallCamera, LEVEL_WIDTH, LEVEL_HEIGHT);
+
+    min.x = fminf(min.x, p.x);
+    min.y = fminf(min.y, p.y);
+    max.x = fmaxf(max.x, p.x);
+    max.y = fmaxf(max.y, p.y);
   }
+
+  return (Rectangle) {min.x, min.y, max.x - min.x, max.y - min.y};
 }
 
-void adjustBossBallTargetScreen(void) {
-  UnloadRenderTexture(bossBallTargetScreen);
+/* NOTE: same as `BeginMode3D`, but only the part of the level-sized view inside `window` ends up in the target */
+void beginBossBallMode3D(Rectangle window) {
+  rlDrawRenderBatchActive();
 
-  bossBallTargetScreen = LoadRenderTexture(GetScreenWidth(), GetScreenHeight());
-}
+  rlMatrixMode(RL_PROJECTION);
+  rlPushMatrix();
+  rlLoadIdentity();
 
-void initTextures(void) {
-  sprites = LoadTexture("assets/sprites.png");
+  double top = RL_CULL_DISTANCE_NEAR * tan(bossBallCamera.fovy * 0.5 * DEG2RAD);
+  double right = top * ((double)LEVEL_WIDTH / (double)LEVEL_HEIGHT);
 
-  target = LoadRenderTexture(LEVEL_WIDTH, LEVEL_HEIGHT);
+  rlFrustum(-right + 2.0 * right * (window.x / LEVEL_WIDTH),
+            -right + 2.0 * right * ((window.x + window.width) / LEVEL_WIDTH),
+            top - 2.0 * top * ((window.y + window.height) / LEVEL_HEIGHT),
+            top - 2.0 * top * (window.y / LEVEL_HEIGHT),
+            RL_CULL_DISTANCE_NEAR,
+            RL_CULL_DISTANCE_FAR);
 
-  bossBallTarget = LoadRenderTexture(LEVEL_WIDTH, LEVEL_HEIGHT);
-  adjustBossBallTargetScreen();
+  rlMatrixMode(RL_MODELVIEW);
+  rlLoadIdentity();
 
-  playerTexture = LoadRenderTexture(playerRect.width, playerRect.height);
-  playerTexture1 = LoadRenderTexture(playerRect.width, playerRect.height);
-  playerTexture2 = LoadRenderTexture(playerRect.width, playerRect.height);
-  playerAuraTexture = LoadRenderTexture(PLAYER_AURA_WIDTH, PLAYER_AURA_HEIGHT);
+  Matrix view = MatrixLookAt(bossBallCamera.position, bossBallCamera.target, bossBallCamera.up);
+  rlMultMatrixf(MatrixToFloat(view));
+
+  rlEnableDepthTest();
+}
 
-  laserTexture = LoadRenderTexture(LASER_WIDTH, LASER_HEIGHT);
+void renderBossBallModel(Rectangle window, Vector3 center, Vector3 axis, float angle) {
+  BeginTextureMode(bossBallTarget); {
+    ClearBackground(BLANK);
 
-  backgroundTexture = LoadRenderTexture(background.x, background.y);
+    beginBossBallMode3D(window); {
+      DrawModelEx(bossBallModel, center, axis, angle, Vector3Scale(Vector3One(), 2), WHITE);
+    } EndMode3D();
+  } EndTextureMode();
 }
 
-void initThrusterTrails(void) {
-  for (int i = 0; i < THRUSTER_TRAILS_MAX; i++) {
-    thrusterTrail[i].texture = LoadRenderTexture(playerRect.width, playerRect.height);
-    thrusterTrail[i].alpha = 0.0f;
-    thrusterTrail[i].origin = Vector2Zero();
-    thrusterTrail[i].angle = 0.0f;
+void prerenderBossBall(void) {
+  /* NOTE: the impostor is drawn straight from the atlas */
+  if (bossBallImpostor) {
+    return;
+  }
+
+  bossBallUpdateShader();
+
+  Vector3 groundTopLeft = {-50, 0, -50};
+  Vector3 groundBottomLeft = {-50, 0, 50};
+  Vector3 groundBottomRight = {50, 0, 50};
+  Vector3 groundTopRight = {50, 0, -50};
+
+  Ray r = traceRay(world->bossBall.position, bossBallCamera);
+  RayCollision c = GetRayCollisionQuad(r, groundTopLeft, groundBottomLeft, groundBottomRight, groundTopRight);
+
+  if (!c.hit || c.distance >= FLOAT_MAX) {
+    return;
   }
+
+  bossBallTargetRect = bossBallRectAt(world->bossBall.position);
+  renderBossBallModel(bossBallTargetRect, c.point, world->bossBall.rotationAxis, world->bossBall.angle);
 }
 
-void updateBackgroundAsteroid(void) {
-  bigAssAsteroidPosition = Vector2Add(bigAssAsteroidPosition,
-                                      bigAssAsteroidPositionDelta);
-  bigAssAsteroidAngle += bigAssAsteroidAngleDelta;
+/* NOTE: every frame of every roll is rendered once with the ball in the middle of the level, under the light */
+void bakeBossBallImpostor(void) {
+  int size = bossBallTarget.texture.width;
+  int frames = BOSS_BALL_IMPOSTOR_AXES * BOSS_BALL_IMPOSTOR_FRAMES;
+  int rows = (frames + BOSS_BALL_IMPOSTOR_COLUMNS - 1) / BOSS_BALL_IMPOSTOR_COLUMNS;
+
+  UnloadRenderTexture(bossBallImpostorAtlas);
+  bossBallImpostorAtlas = LoadRenderTexture(size * BOSS_BALL_IMPOSTOR_COLUMNS, size * rows);
+
+  BeginTextureMode(bossBallImpostorAtlas); {
+    ClearBackground(BLANK);
+  } EndTextureMode();
+
+  bossBallUpdateShader();
+
+  Rectangle window = bossBallRectAt((Vector2) {LEVEL_WIDTH / 2.0f, LEVEL_HEIGHT / 2.0f});
+
+  for (int i = 0; i < frames; i++) {
+    const int *axis = bossBallImpostorAxes[i / BOSS_BALL_IMPOSTOR_FRAMES];
+    float angle = (float)(i % BOSS_BALL_IMPOSTOR_FRAMES) / BOSS_BALL_IMPOSTOR_FRAMES * 360.0f;
+
+    renderBossBallModel(window, Vector3Zero(), (Vector3) {axis[0], 0, axis[1]}, angle);
+
+    BeginTextureMode(bossBallImpostorAtlas); {
+      DrawTextureRec(bossBallTarget.texture,
+                     (Rectangle) {0, 0, size, -size},
+                     (Vector2) {
+                       (i % BOSS_BALL_IMPOSTOR_COLUMNS) * size,
+                       (i / BOSS_BALL_IMPOSTOR_COLUMNS) * size,
+                     },
+                     WHITE);
+    } EndTextureMode();
+  }
 }
 
-void resetGame(void) {
-  StopMusicStream(bossMarineMusic);
+void renderBossMarine(void) {
+  Vector2 center = {
+    .x = (bossMarineRect.width * SPRITES_SCALE) / 2,
+    .y = (bossMarineRect.height * SPRITES_SCALE) / 2,
+  };
 
-  initAsteroids();
-  initPlayer();
-  initBossMarine();
-  initBossBall();
-  initBossBall();
-  initBackgroundAsteroid();
-  initProjectiles();
+  Rectangle bossRect = bossMarineRect;
+  bossRect.width *= world->bossMarine.horizontalFlip;
+  Rectangle weaponRect = bossMarineWeaponRect;
+  weaponRect.width *= world->bossMarine.horizontalFlip;
+
+  queueTexturePro(sprites,
+                  bossRect,
+                  (Rectangle) {
+                    .x = world->bossMarine.position.x,
+                    .y = world->bossMarine.position.y,
+                    .width = bossMarineRect.width * SPRITES_SCALE,
+                    .height = bossMarineRect.height * SPRITES_SCALE,
+                  },
+                  center,
+                  0,
+                  WHITE);
 
-  currentBoss = BOSS_MARINE;
+  Vector2 weaponCenter = {
+    .x = (bossMarineWeaponRect.width * SPRITES_SCALE) / 2,
+    .y = (bossMarineWeaponRect.height * SPRITES_SCALE) / 2,
+  };
 
-  memset(particles, 0, sizeof(particles));
+  queueTexturePro(sprites,
+                  weaponRect,
+                  (Rectangle) {
+                    .x = world->bossMarine.position.x + (world->bossMarine.weaponOffset.x * world->bossMarine.horizontalFlip),
+                    .y = world->bossMarine.position.y + world->bossMarine.weaponOffset.y,
+                    .width = bossMarineWeaponRect.width * SPRITES_SCALE,
+                    .height = bossMarineWeaponRect.height * SPRITES_SCALE,
+                  },
+                  weaponCenter,
+                  world->bossMarine.weaponAngle,
+                  WHITE);
+}
 
-  for (int i = 0; i < THRUSTER_TRAILS_MAX; i++) {
-    thrusterTrail[i].alpha = 0.0f;
-    thrusterTrail[i].origin = Vector2Zero();
-    thrusterTrail[i].angle = 0.0f;
+void renderBoss(void) {
+  switch (world->currentBoss) {
+  case BOSS_MARINE: renderBossMarine(); break;
+  case BOSS_BALL: renderBossBall(); break;
   }
+}
 
-  introductionStage = BOSS_INTRODUCTION_BEGINNING;
+static float blackBackgroundAlpha = 0;
+
+/* NOTE: the beam is shaded right on its quad, only as long as it reaches */
+void renderLaserBeam(Vector2 position, float angle, float length) {
+  if (length <= 0.0f) {
+    return;
+  }
+
+  /* NOTE: the texture coordinates run to how far the beam reaches, so that beams of any length share one batch */
+  beginQueuedShader(laserShader); {
+    queueTexturePro(shapesTexture,
+                    (Rectangle) {0, 0, length / LASER_WIDTH, 1},
+                    (Rectangle) {position.x, position.y, length, LASER_HEIGHT},
+                    (Vector2) {0, LASER_HEIGHT / 2.0f},
+                    angle,
+                    WHITE);
+  }; endQueuedShader();
 }
 
-static bool pauseMouseWasDown = false;
+void renderLasers(void) {
+  float t = GetTime() * 69.0f * 0.5f;
 
-static Vector2 previousMousePressLocation = {0};
-static Vector2 previousMouseLocation = {0};
-void updateAndRenderPauseScreen(void) {
-  updateMouse();
+  SetShaderValue(laserShader,
+                 laserShaderTime,
+                 &t,
+                 SHADER_UNIFORM_FLOAT);
 
-  bool isMouseDown = IsMouseButtonDown(MOUSE_BUTTON_LEFT);
-  bool released = false;
+  for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
+    if (world->bossBall.weapons[i].type != BOSS_BALL_WEAPON_LASER) {
+      continue;
+    }
 
-  if (isMouseDown == false && pauseMouseWasDown == true) {
-    released = true;
-  }
-  pauseMouseWasDown = isMouseDown;
+    Vector2 pos = Vector2Add(world->bossBall.weapons[i].position,
+                             world->bossBall.weapons[i].bulletOrigin);
 
-  bool pressed = IsMouseButtonPressed(MOUSE_BUTTON_LEFT);
+    float angle = bossBallWeaponAimAngle(i) - 90;
+
+#define LASER_POINTER_HEIGHT 3.6f
+
+    if (world->bossBall.weapons[i].chargeLevel > 0.0f && world->bossBall.weapons[i].chargeLevel <= 1.0f) {
+      queueRectanglePro((Rectangle) {pos.x, pos.y, LASER_WIDTH, LASER_POINTER_HEIGHT},
+                        (Vector2) {0, LASER_POINTER_HEIGHT / 2.0f},
+                        angle,
+                        ColorAlpha(RED, world->bossBall.weapons[i].chargeLevel));
+    } else {
+      renderLaserBeam(pos, angle, world->bossBall.weapons[i].laserLength);
+    }
 
-  if (pressed) {
-    previousMousePressLocation = screenMouseLocation;
   }
+}
 
-  float mul = camera.zoom * 2;
-  Font f = GetFontDefault();
-  float fontSize = 25 * mul;
-  float spacing = 2 * mul;
+void renderParticles(void) {
+  for (int i = 0; i < world->particles.pool.len; i++) {
+    if (!isInWorldView(CULL_PARTICLES, world->particles.items[i].position, SPRITES_SCALE)) {
+      continue;
+    }
 
-  float w = (float)GetScreenWidth();
-  float h = (float)GetScreenHeight();
+    queueRectanglePro((Rectangle) {world->particles.items[i].position.x, world->particles.items[i].position.y, SPRITES_SCALE, SPRITES_SCALE},
+                      (Vector2) {SPRITES_SCALE * 0.5f, SPRITES_SCALE * 0.5f},
+                      world->particles.items[i].angle,
+                      ColorAlpha(world->particles.items[i].color, world->particles.items[i].lifetime));
+  }
+}
 
-  float bw = w / 4.5;
-  float bh = h / 8;
-  float x = w / 2;
-  float y = h / 2 - (bh);
+/* NOTE: the world target is drawn into a smaller part of itself when frames take too long */
+#define RESOLUTION_SCALE_MIN 0.5f
+#define RESOLUTION_SCALE_MAX 1.0f
+#define RESOLUTION_SCALE_STEP 0.125f
+/* NOTE: the averaged frame time has to go this far over or under the budget to change the scale */
+#define RESOLUTION_SLOW_FRAME 1.15f
+#define RESOLUTION_FAST_FRAME 1.05f
+/* NOTE: seconds of fast frames before trying a bigger target, doubled every time that try was too slow */
+#define RESOLUTION_PROBE_DELAY 2.0f
+#define RESOLUTION_PROBE_DELAY_MAX 32.0f
 
-  Rectangle buttonContinue = {x - (bw / 2), y - (bh / 2), bw, bh};
-  Rectangle buttonQuit = {x - (bw / 2), y - (bh / 2) + (bh * 2), bw, bh};
+typedef struct {
+  bool enabled;
+  float scale;
+  float averageFrameTime;
+  float fastFor;
+  float probeDelay;
+  float sinceStepUp;
+} DynamicResolution;
+
+static DynamicResolution dynamicResolution = {
+#if defined(PLATFORM_WEB)
+  /* NOTE: there's no command line on the web, and it's where weak machines show up the most */
+  .enabled = true,
+#endif
+  .scale = RESOLUTION_SCALE_MAX,
+  .probeDelay = RESOLUTION_PROBE_DELAY,
+  .sinceStepUp = FLOAT_MAX,
+};
 
-  BeginDrawing(); {
-    ClearBackground(BLACK);
+void updateDynamicResolution(float frameTime) {
+  if (!dynamicResolution.enabled || directRendering) {
+    return;
+  }
 
-    {
-      float width = (float)target.texture.width;
-      float height = (float)target.texture.height;
-
-      BeginMode2D(camera); {
-        DrawTexturePro(target.texture,
-                       (Rectangle) {
-                         .x = 0,
-                         .y = 0,
-                         .width = width,
-                         .height = -height
-                       },
-                       (Rectangle) {
-                         .x = 0,
-                         .y = 0,
-                         .width = width,
-                         .height = height
-                       },
-                       Vector2Zero(),
-                       0.0f,
-                       WHITE);
-      }; EndMode2D();
+  DynamicResolution *dr = &dynamicResolution;
+  float budget = 1.0f / REFERENCE_FRAME_RATE;
 
-      if (gameState == GAME_BOSS) {
-        renderBossHealthBar();
-        renderPlayerHealthBar();
+  dr->averageFrameTime = Lerp(dr->averageFrameTime, frameTime, 0.1f);
+  dr->sinceStepUp += frameTime;
+
+  if (dr->averageFrameTime > budget * RESOLUTION_SLOW_FRAME) {
+    if (dr->scale > RESOLUTION_SCALE_MIN) {
+      /* NOTE: the bigger target it just tried was too much, so it waits longer before the next try */
+      if (dr->sinceStepUp < dr->probeDelay) {
+        dr->probeDelay = fminf(dr->probeDelay * 2, RESOLUTION_PROBE_DELAY_MAX);
       }
+
+      dr->scale = fmaxf(dr->scale - RESOLUTION_SCALE_STEP, RESOLUTION_SCALE_MIN);
+      /* NOTE: the average starts over, so a single slow stretch only steps down once */
+      dr->averageFrameTime = budget;
+      LOG("DYNAMIC RESOLUTION: %d%%\n", (int)roundf(dr->scale * 100));
     }
 
-    DrawRectangle(0, 0, w, h, ColorAlpha(BLACK, 0.7));
+    dr->fastFor = 0;
+    return;
+  }
 
-    {
-      if (!CheckCollisionPointRec(previousMouseLocation, buttonContinue) &&
-          CheckCollisionPointRec(screenMouseLocation, buttonContinue)) {
-        PlaySound(buttonFocusEffect);
-      }
+  if (dr->averageFrameTime < budget * RESOLUTION_FAST_FRAME) {
+    dr->fastFor += frameTime;
+  } else {
+    dr->fastFor = 0;
+  }
 
+  if (dr->fastFor >= dr->probeDelay && dr->scale < RESOLUTION_SCALE_MAX) {
+    dr->scale = fminf(dr->scale + RESOLUTION_SCALE_STEP, RESOLUTION_SCALE_MAX);
+    dr->fastFor = 0;
+    dr->sinceStepUp = 0;
+    LOG("DYNAMIC RESOLUTION: %d%%\n", (int)roundf(dr->scale * 100));
+  }
+}
 
-      if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) &&
-          CheckCollisionPointRec(previousMousePressLocation, buttonContinue) &&
-          CheckCollisionPointRec(screenMouseLocation, buttonContinue)) {
-        DrawRectangleRec(buttonContinue,
-                         LIGHTGRAY);
-      } else {
-        DrawRectangleRec(buttonContinue,
-                         WHITE);
-      }
+/* NOTE: the part of `target` the world is drawn into at the current scale, in pixels */
+Vector2 worldTargetSize(void) {
+  return (Vector2) {
+    roundf(target.texture.width * dynamicResolution.scale),
+    roundf(target.texture.height * dynamicResolution.scale),
+  };
+}
 
-      if (CheckCollisionPointRec(screenMouseLocation, buttonContinue)) {
-        DrawRectangleLinesEx(buttonContinue,
-                             2 * mul,
-                             LIGHTGRAY);
-      }
+/* NOTE: the scale keeps moving on frames that only show the last picture, like the pause menu */
+static Vector2 targetDrawnSize;
 
-      char *text = "CONTINUE";
+/* NOTE: every layer of the world in level coordinates, into whatever `presentWorld` set up */
+void renderWorld(void) {
+  /* NOTE: even when drawn into `target`, only the camera's window of it ends up on screen */
+  updateWorldView();
+  memset(cullCounts, 0, sizeof(cullCounts));
 
-      Vector2 size = MeasureTextEx(f, text, fontSize, spacing);
+  beginDrawQueue();
 
-      Vector2 pos = (Vector2) {
-        .x = (float)buttonContinue.x + buttonContinue.width / 2,
-        .y = (float)buttonContinue.y + buttonContinue.height / 2,
-      };
+  setDrawLayer(DRAW_LAYER_BACKGROUND);
+  renderBackground();
 
-      DrawTextPro(f,
-                  text,
-                  pos,
-                  Vector2Scale(size, 0.5f),
-                  0,
-                  fontSize,
-                  spacing,
-                  BLACK);
-    }
+  if (world->currentBoss == BOSS_MARINE) {
+    setDrawLayer(DRAW_LAYER_BACKGROUND_ASTEROID);
+    renderBackgroundAsteroid();
+  }
 
-    {
+  if (world->gameState == GAME_BOSS ||
+      (world->gameState == GAME_BOSS_INTRODUCTION &&
+       introductionStage != BOSS_INTRODUCTION_BEGINNING)) {
+    setDrawLayer(DRAW_LAYER_ARENA_BORDER);
+    renderArenaBorder();
+  }
 
-      if (!CheckCollisionPointRec(previousMouseLocation, buttonQuit) &&
-          CheckCollisionPointRec(screenMouseLocation, buttonQuit)) {
-        PlaySound(buttonFocusEffect);
-      }
+  setDrawLayer(DRAW_LAYER_PARTICLES);
+  renderParticles();
 
-      if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) &&
-          CheckCollisionPointRec(previousMousePressLocation, buttonQuit) &&
-          CheckCollisionPointRec(screenMouseLocation, buttonQuit)) {
-        DrawRectangleRec(buttonQuit,
-                         LIGHTGRAY);
-      } else {
-        DrawRectangleRec(buttonQuit,
-                         WHITE);
-      }
+  setDrawLayer(DRAW_LAYER_ASTEROIDS);
+  renderAsteroids();
 
-      if (CheckCollisionPointRec(screenMouseLocation, buttonQuit)) {
-        DrawRectangleLinesEx(buttonQuit,
-                             2 * mul,
-                             LIGHTGRAY);
-      }
+  if (world->gameState == GAME_BOSS_DEAD || world->gameState == GAME_PLAYER_DEAD) {
+    setDrawLayer(DRAW_LAYER_SHADE);
+    queueRectanglePro((Rectangle) {0, 0, level.x, level.y},
+                      Vector2Zero(),
+                      0,
+                      ColorAlpha(BLACK, blackBackgroundAlpha));
+  }
 
-      char *text = "QUIT";
+  setDrawLayer(DRAW_LAYER_BOSS);
+  renderBoss();
 
-      Vector2 size = MeasureTextEx(f, text, fontSize, spacing);
+  if (world->currentBoss == BOSS_BALL) {
+    setDrawLayer(DRAW_LAYER_DISCONNECTED_WEAPONS);
+    renderBossBallDisconnectedWeapons();
+  }
 
-      Vector2 pos = (Vector2) {
-        .x = (float)buttonQuit.x + buttonQuit.width / 2,
-        .y = (float)buttonQuit.y + buttonQuit.height / 2,
-      };
+  setDrawLayer(DRAW_LAYER_THRUSTER_TRAILS);
+  renderThrusterTrails();
 
-      DrawTextPro(f,
-                  text,
-                  pos,
-                  Vector2Scale(size, 0.5f),
-                  0,
-                  fontSize,
-                  spacing,
-                  BLACK);
-    }
+  setDrawLayer(DRAW_LAYER_DASH_TRAILS);
+  renderDashTrails();
 
-    renderMouseCursor();
-  } EndDrawing();
+  setDrawLayer(DRAW_LAYER_SHIPS);
+  renderPlayer();
 
-  if (released) {
-    if (CheckCollisionPointRec(previousMousePressLocation, buttonContinue) &&
-        CheckCollisionPointRec(screenMouseLocation, buttonContinue)) {
-      PlaySound(beep);
-      isGamePaused = false;
-    } else if (CheckCollisionPointRec(previousMousePressLocation, buttonQuit) &&
-               CheckCollisionPointRec(screenMouseLocation, buttonQuit)) {
-      PlaySound(beep);
-      isGamePaused = false;
+  if (world->coop) {
+    renderWingman();
+  }
 
-      gameState = GAME_MAIN_MENU;
-      resetGame();
-    }
+  if (world->currentBoss == BOSS_BALL) {
+    setDrawLayer(DRAW_LAYER_CONNECTED_WEAPONS);
+    renderBossBallConnectedWeapons();
   }
 
-  previousMouseLocation = screenMouseLocation;
+  setDrawLayer(DRAW_LAYER_PROJECTILES);
+  renderProjectiles();
+
+  setDrawLayer(DRAW_LAYER_LASERS);
+  renderLasers();
+
+  submitDrawQueue();
 }
 
-void bossBallRoll(void) {
-  if (bossBall.standingStilTimer > 0.0f) {
-    bossBall.standingStilTimer -= GetFrameTime();
+void renderPhase1(void) {
+  renderPlayerTexture();
+
+  if (world->currentBoss == BOSS_BALL) {
+    prerenderBossBall();
+  }
+
+  preRenderBackground(world->currentBoss != BOSS_BALL);
+
+  if (directRendering) {
+    return;
+  }
+
+  BeginTextureMode(target); {
+    ClearBackground(BLACK);
+
+    /* NOTE: the projection still covers the whole level, the viewport squeezes it into the bottom-left corner */
+    targetDrawnSize = worldTargetSize();
+    rlViewport(0, 0, (int)targetDrawnSize.x, (int)targetDrawnSize.y);
+
+    renderWorld();
+  } EndTextureMode();
+}
+
+/* NOTE: puts the world on screen, either by stretching `target` or by drawing `layers` under the camera,
+         cut to the level and to what the window shows of it */
+void presentWorld(void (*layers)(void)) {
+  if (!directRendering) {
+    BeginMode2D(camera); {
+      DrawTexturePro(target.texture,
+                     (Rectangle) {0, 0, targetDrawnSize.x, -targetDrawnSize.y},
+                     (Rectangle) {0, 0, level.x, level.y},
+                     Vector2Zero(),
+                     0.0f,
+                     WHITE);
+    }; EndMode2D();
+
+    return;
+  }
+
+  updateWorldView();
+
+  Vector2 viewTopLeft = GetWorldToScreen2D((Vector2) {worldView.x, worldView.y}, camera);
+  Vector2 viewBottomRight = GetWorldToScreen2D((Vector2) {worldView.x + worldView.width, worldView.y + worldView.height}, camera);
+
+  BeginScissorMode((int)floorf(viewTopLeft.x),
+                   (int)floorf(viewTopLeft.y),
+                   (int)ceilf(viewBottomRight.x - viewTopLeft.x),
+                   (int)ceilf(viewBottomRight.y - viewTopLeft.y)); {
+    BeginMode2D(camera); {
+      layers();
+    }; EndMode2D();
+  } EndScissorMode();
+}
+
+#define HEALTH_BAR_HEIGHT 5
+
+static Rectangle bossMarineHeadRect = {
+  .x = 76,
+  .y = 30,
+  .width = 23,
+  .height = 21,
+};
+
+void renderPlayerHealthBar(void) {
+  float w = playerRect.width * camera.zoom * SPRITES_SCALE;
+  float h = playerRect.height * camera.zoom * SPRITES_SCALE;
+
+  Rectangle rect = {
+    .x = w / 2 + 20,
+    .y = h / 2 + 20,
+    .width = w,
+    .height = h,
+  };
+
+  DrawTexturePro(playerTexture2.texture,
+                 (Rectangle) {
+                   0, 0, playerTexture2.texture.width, playerTexture2.texture.height
+                 },
+                 rect,
+                 (Vector2) {w*0.5f, h*0.5f},
+                 sin(GetTime() * 10) * 50 * world->player.iframeTimer,
+                 WHITE);
+}
+
+void renderBossHealthBar(void) {
+  const float screenFill = 0.7;
+
+  const float width = (float)GetScreenWidth() * screenFill;
+  const float height = HEALTH_BAR_HEIGHT * SPRITES_SCALE * camera.zoom;
+
+  Rectangle rect = {
+    .x = (float)GetScreenWidth() / 2,
+    .y = height * 1.5,
+    .width = width,
+    .height = height,
+  };
+
+  Rectangle wRect = rect;
+  wRect.width += SPRITES_SCALE * camera.zoom * 2;
+
+  Rectangle hRect = rect;
+  hRect.height += SPRITES_SCALE * camera.zoom * 2;
+
+  DrawRectanglePro(wRect, (Vector2) {wRect.width / 2, wRect.height / 2}, 0, BLACK);
+  DrawRectanglePro(hRect, (Vector2) {hRect.width / 2, hRect.height / 2}, 0, BLACK);
+
+  float health = 0;
+
+  char *bossName = NULL;
+
+  switch (world->currentBoss) {
+  case BOSS_MARINE: {
+    health = (float)world->bossMarine.health / BOSS_MARINE_MAX_HEALTH;
+    bossName = BOSS_MARINE_NAME;
+  } break;
+  case BOSS_BALL: {
+    health = (float)world->bossBall.health / BOSS_BALL_MAX_HEALTH;
+    bossName = BOSS_BALL_NAME;
+  } break;
+  };
+
+  rect.x -= rect.width / 2;
+
+  Vector2 head = {
+    .x = rect.x + rect.width * health,
+    .y = rect.y,
+  };
+
+  rect.y -= rect.height / 2;
+
+  rect.width *= health;
+
+  DrawRectanglePro(rect, Vector2Zero(), 0, RED);
+
+  float mul = SPRITES_SCALE * camera.zoom * 0.6;
+
+  Font f = GetFontDefault();
+  float fontSize = 11 * mul;
+  float spacing = 1 * mul;
+  Vector2 size = MeasureTextEx(f, bossName, fontSize, spacing);
+
+  Vector2 pos = {
+      .x = (float)GetScreenWidth() / 2,
+      .y = height * 2,
+  };
+
+  DrawTextPro(f, bossName, pos, Vector2Scale(size, 0.5f), 0, fontSize, spacing, BLACK);
+  DrawTextPro(f, bossName, Vector2SubtractValue(pos, spacing), Vector2Scale(size, 0.5f), 0, fontSize, spacing, WHITE);
+
+  switch (world->currentBoss) {
+  case BOSS_MARINE: {
+    DrawTexturePro(sprites,
+                   bossMarineHeadRect,
+                   (Rectangle) {
+                     .x = head.x,
+                     .y = head.y,
+                     .width = bossMarineHeadRect.width * mul,
+                     .height = bossMarineHeadRect.height * mul,
+                   },
+                   (Vector2) {
+                     .x = (bossMarineHeadRect.width * mul) / 2,
+                     .y = (bossMarineHeadRect.height * mul) / 2,
+                   },
+                   sin(GetTime() * 2) * 15,
+                   WHITE);
+  } break;
+  case BOSS_BALL: {
+
+    Vector3 groundTopLeft = {-50, 0, -50};
+    Vector3 groundBottomLeft = {-50, 0, 50};
+    Vector3 groundBottomRight = {50, 0, 50};
+    Vector3 groundTopRight = {50, 0, -50};
+
+    Vector3 lightPos = bossBallLight.position;
+
+    Ray lightRay = GetMouseRay(screenMouseLocation, bossBallCamera);
+    RayCollision lc = GetRayCollisionQuad(lightRay, groundTopLeft, groundBottomLeft, groundBottomRight, groundTopRight);
+
+    if (lc.hit && lc.distance < FLOAT_MAX) {
+      bossBallLight.position = (Vector3) {
+        lc.point.x, lightPos.y, lc.point.z
+      };
+    }
+
+    bossBallUpdateShader();
+
+    Ray r = GetMouseRay(head, bossBallCamera);
+    RayCollision c = GetRayCollisionQuad(r, groundTopLeft, groundBottomLeft, groundBottomRight, groundTopRight);
+
+    BeginTextureMode(bossBallTargetScreen); {
+      ClearBackground(BLANK);
+
+      BeginMode3D(bossBallCamera); {
+        if (c.hit && c.distance < FLOAT_MAX) {
+          DrawModelEx(bossBallModel,
+                      c.point,
+                      (Vector3) {0, 0, -1}, 360 * health * 8,
+                      Vector3Scale(Vector3One(), .5),
+                      WHITE);
+        }
+      } EndMode3D();
+    } EndTextureMode();
+
+    bossBallLight.position = lightPos;
+    bossBallUpdateShader();
+
+    const float pixelSize = 1.0;
+
+    SetShaderValue(pixelationShader,
+                   pixelationShaderPixelSize,
+                   &pixelSize,
+                   SHADER_UNIFORM_FLOAT);
+
+    BeginShaderMode(pixelationShader); {
+      DrawTextureRec(bossBallTargetScreen.texture,
+                     (Rectangle) {
+                       0, 0,
+                       bossBallTargetScreen.texture.width, -bossBallTargetScreen.texture.height
+                     },
+                     Vector2Zero(),
+                     WHITE);
+    } EndShaderMode();
+  } break;
+  };
+}
+
+static Vector2 bossInfoHeadPosition = {0};
+static float infoXBase = 0;
+
+void renderBossInfo(void) {
+  float w = GetScreenWidth();
+  float h = GetScreenHeight();
+
+  Color red = {0};
+
+  switch (world->currentBoss) {
+  case BOSS_MARINE: red = (Color) {143, 30, 32, 255}; break;
+  case BOSS_BALL: red = (Color) {243, 83, 54, 255}; break;
+  }
+
+  float w3 = roundf(w / 3);
+
+  float x1 = ceilf(infoXBase + w3);
+  float x2 = floorf(x1 + w3);
+
+  DrawRectangle(infoXBase, 0,
+                w3, h,
+                red);
+
+  DrawTriangle((Vector2) {x1, 0},
+               (Vector2) {x1, h},
+               (Vector2) {x2, h},
+               red);
+
+  float mul = 25;
+
+  char *bossName = NULL;
+
+  switch (world->currentBoss) {
+  case BOSS_MARINE: {
+    bossName = BOSS_MARINE_NAME;
+
+    Rectangle headRect = bossMarineHeadRect;
+
+    DrawTexturePro(sprites,
+                   headRect,
+                   (Rectangle) {
+                     .x = bossInfoHeadPosition.x,
+                     .y = bossInfoHeadPosition.y,
+                     .width = headRect.width * mul,
+                     .height = headRect.height * mul,
+                   },
+                   (Vector2) {
+                     .x = (headRect.width * mul) / 2,
+                     .y = (headRect.height * mul) / 2,
+                   },
+                   sin(GetTime()) * 15,
+                   WHITE);
+  } break;
+  case BOSS_BALL: {
+    bossName = BOSS_BALL_NAME;
+
+    bossBallUpdateShader();
+
+    Vector3 groundTopLeft = {-50, 0, -50};
+    Vector3 groundBottomLeft = {-50, 0, 50};
+    Vector3 groundBottomRight = {50, 0, 50};
+    Vector3 groundTopRight = {50, 0, -50};
+
+    Ray r = GetMouseRay(bossInfoHeadPosition, bossBallCamera);
+    RayCollision c = GetRayCollisionQuad(r, groundTopLeft, groundBottomLeft, groundBottomRight, groundTopRight);
+
+    BeginTextureMode(bossBallTargetScreen); {
+      ClearBackground(BLANK);
+
+      BeginMode3D(bossBallCamera); {
+        if (c.hit && c.distance < FLOAT_MAX) {
+          DrawModelEx(bossBallModel,
+                      c.point,
+                      (Vector3) {0, 1, 0}, GetTime() * 15,
+                      Vector3Scale(Vector3One(), 5),
+                      WHITE);
+        }
+      } EndMode3D();
+    } EndTextureMode();
+
+    const float pixelSize = 10.0;
+
+    SetShaderValue(pixelationShader,
+                   pixelationShaderPixelSize,
+                   &pixelSize,
+                   SHADER_UNIFORM_FLOAT);
+
+    BeginShaderMode(pixelationShader); {
+      DrawTextureRec(bossBallTargetScreen.texture,
+                     (Rectangle) {
+                       0, 0,
+                       bossBallTargetScreen.texture.width, -bossBallTargetScreen.texture.height
+                     },
+                     Vector2Zero(),
+                     WHITE);
+    } EndShaderMode();
+  } break;
+  };
+
+  Font f = GetFontDefault();
+  float fontSize = 11 * mul / 4;
+  float spacing = 1 * mul / 4;
+  Vector2 size = MeasureTextEx(f, bossName, fontSize, spacing);
+
+  Vector2 pos = (Vector2) {
+      .x = w / 4 * 3,
+      .y = h / 2,
+  };
+
+  DrawTextPro
+    (f,
+     bossName,
+     Vector2AddValue(pos, spacing),
+     Vector2Scale(size, 0.5f),
+     0,
+     fontSize,
+     spacing,
+     red);
+
+  DrawTextPro
+    (f,
+     bossName,
+     pos,
+     Vector2Scale(size, 0.5f),
+     0,
+     fontSize,
+     spacing,
+     WHITE);
+}
+
+void renderFinal(void) {
+  BeginDrawing(); {
+    ClearBackground(BLACK);
+
+    presentWorld(renderWorld);
+
+    if (world->gameState == GAME_BOSS_INTRODUCTION &&
+        introductionStage == BOSS_INTRODUCTION_INFO) {
+      renderBossInfo();
+    }
+
+    if (world->gameState == GAME_BOSS) {
+      renderBossHealthBar();
+      renderPlayerHealthBar();
+    }
+
+    if (world->gameState != GAME_BOSS_INTRODUCTION &&
+        world->gameState != GAME_PLAYER_DEAD &&
+        world->gameState != GAME_BOSS_DEAD &&
+        !isGamePaused) {
+      renderMouseCursor();
+    }
+
+  } EndDrawing();
+}
+
+
+void emitCollisionEvent(CollisionEvents *events, CollisionEventType type, int projectile, int other) {
+  if (events->len >= COLLISION_EVENTS_MAX) {
+    return;
+  }
+
+  events->items[events->len++] = (CollisionEvent) {
+    .type = type,
+    .projectile = projectile,
+    .other = other,
+  };
+}
+
+#define PROJECTILE_CONTACTS_MAX 16
+
+/* NOTE: detection only reads the game state, everything it finds goes into `events` */
+void detectRegularProjectileCollision(int i, CollisionEvents *events) {
+  Contact buffer[PROJECTILE_CONTACTS_MAX];
+  ContactList contacts = {buffer, 0, PROJECTILE_CONTACTS_MAX};
+
+  Collider body = circleCollider(COLLIDER_PROJECTILE, i, COLLISION_LAYER_NONE,
+                                 world->projectiles.items[i].origin, world->projectiles.items[i].radius);
+
+  CollisionLayer mask = COLLISION_LAYER_ASTEROID | world->projectiles.items[i].hurts;
+  mask &= ~invincibleShips();
+
+  collisionWorldQuery(&body, mask, &contacts);
+
+  if (findContact(&contacts, COLLISION_LAYER_ASTEROID)) {
+    emitCollisionEvent(events, COLLISION_EVENT_PROJECTILE_BLOCKED, i, 0);
+    return;
+  }
+
+  const Contact *ship = findContact(&contacts, COLLISION_LAYER_SHIPS);
+
+  if (ship) {
+    emitCollisionEvent(events, COLLISION_EVENT_PLAYER_HIT, i, contactCollider(ship)->index);
+    return;
+  }
+
+  const Contact *boss = findContact(&contacts, COLLISION_LAYER_BOSS);
+
+  if (boss) {
+    emitCollisionEvent(events, COLLISION_EVENT_BOSS_HIT, i, contactCollider(boss)->owner);
+  }
+}
+
+void detectSquaredProjectileCollision(int i, CollisionEvents *events) {
+  Contact buffer[PROJECTILE_CONTACTS_MAX];
+  ContactList contacts = {buffer, 0, PROJECTILE_CONTACTS_MAX};
+
+  Rectangle proj = {
+    .x = world->projectiles.items[i].origin.x,
+    .y = world->projectiles.items[i].origin.y,
+  };
+
+  Collider body = boxCollider(COLLIDER_PROJECTILE, i, COLLISION_LAYER_NONE, proj, world->projectiles.items[i].angle);
+
+  CollisionLayer mask = COLLISION_LAYER_ASTEROID | (world->projectiles.items[i].hurts & COLLISION_LAYER_SHIPS);
+  mask &= ~invincibleShips();
+
+  collisionWorldQuery(&body, mask, &contacts);
+
+  if (findContact(&contacts, COLLISION_LAYER_ASTEROID)) {
+    emitCollisionEvent(events, COLLISION_EVENT_PROJECTILE_BLOCKED, i, 0);
+    return;
+  }
+
+  const Contact *ship = findContact(&contacts, COLLISION_LAYER_SHIPS);
+
+  if (ship) {
+    emitCollisionEvent(events, COLLISION_EVENT_PLAYER_HIT, i, contactCollider(ship)->index);
+    return;
+  }
+
+  if ((world->projectiles.items[i].hurts & COLLISION_LAYER_BOSS) == 0) {
+    return;
+  }
+
+  if (world->projectiles.items[i].hurts & COLLISION_LAYER_ROCKET) {
+    Collider box = boxCollider(COLLIDER_PROJECTILE, i, COLLISION_LAYER_NONE,
+                               (Rectangle) {world->projectiles.items[i].origin.x, world->projectiles.items[i].origin.y,
+                                            world->projectiles.items[i].size.x, world->projectiles.items[i].size.y},
+                               world->projectiles.items[i].angle);
+
+    collisionWorldQuery(&box, COLLISION_LAYER_ROCKET, &contacts);
+
+    /* NOTE: every candidate is reported, the first rocket still flying at resolve time is the one that gets hit */
+    for (int c = 0; c < contacts.len; c++) {
+      emitCollisionEvent(events, COLLISION_EVENT_ROCKET_SHOT_DOWN, i, contactCollider(&contacts.items[c])->index);
+    }
+  }
+
+  collisionWorldQuery(&body, world->projectiles.items[i].hurts & (COLLISION_LAYER_BOSS | COLLISION_LAYER_BOSS_WEAPON), &contacts);
+
+  const Contact *boss = findContact(&contacts, COLLISION_LAYER_BOSS);
+
+  if (boss) {
+    emitCollisionEvent(events, COLLISION_EVENT_BOSS_HIT, i, contactCollider(boss)->owner);
+    return;
+  }
+
+  const Contact *weapon = findContact(&contacts, COLLISION_LAYER_BOSS_WEAPON);
+
+  if (weapon) {
+    emitCollisionEvent(events, COLLISION_EVENT_WEAPON_HIT, i, contactCollider(weapon)->index);
+  }
+}
+
+void detectProjectileCollisions(int first, int last, CollisionEvents *events) {
+  for (int i = first; i < last; i++) {
+    if (world->projectiles.items[i].willBeDestroyed) {
+      continue;
+    }
+
+    switch (world->projectiles.items[i].type) {
+    case PROJECTILE_REGULAR: detectRegularProjectileCollision(i, events); break;
+    case PROJECTILE_SQUARED: detectSquaredProjectileCollision(i, events); break;
+    }
+  }
+}
+
+void bossBallDeactivateWeapon(int i) {
+  stopMusic(bossBallLaserSounds[i]);
+
+  world->bossBall.weapons[i].attackCooldown = 2.0f;
+  world->bossBall.weapons[i].attackTimer = 0.0f;
+
+  world->bossBall.weapons[i].laserLength = 0;
+  world->bossBall.weapons[i].chargeLevel = 0;
+
+  world->bossBall.weapons[i].isDeactivated = true;
+}
+
+void resolveCollisionEvents(const CollisionEvents *events) {
+  for (int e = 0; e < events->len; e++) {
+    const CollisionEvent *event = &events->items[e];
+    int i = event->projectile;
+
+    /* NOTE: an earlier event already took care of this projectile */
+    if (world->projectiles.items[i].willBeDestroyed) {
+      continue;
+    }
+
+    switch (event->type) {
+    case COLLISION_EVENT_PROJECTILE_BLOCKED: {
+      world->projectiles.items[i].willBeDestroyed = true;
+    } break;
+    case COLLISION_EVENT_PLAYER_HIT: {
+      world->projectiles.items[i].willBeDestroyed = true;
+
+      Player *ship = event->other == 0 ? &world->player : &world->wingman;
+
+      if (ship->iframeTimer == 0.0f) {
+        playSound(hit);
+        ship->health -= world->projectiles.items[i].damage * (world->playerPerks & PERK_MORE_BULLETS ? 2 : 1);
+        ship->iframeTimer = 0.3f;
+      }
+
+      if (ship->health <= 0 && world->gameState != GAME_PLAYER_DEAD) {
+        world->gameState = GAME_PLAYER_DEAD;
+        pauseMusic(bossMarineMusic);
+        pauseMusic(bossBallMusic);
+        playSound(playerDeathSound);
+      }
+    } break;
+    case COLLISION_EVENT_BOSS_HIT: {
+      world->projectiles.items[i].willBeDestroyed = true;
+
+      switch ((ColliderOwner)event->other) {
+      case COLLIDER_BOSS_MARINE: {
+        world->bossMarine.health -= world->projectiles.items[i].damage;
+        bossMarineStealHealth();
+      } break;
+      case COLLIDER_BOSS_BALL: {
+        world->bossBall.health -= world->projectiles.items[i].damage;
+        bossBallStealHealth();
+      } break;
+      default: break;
+      }
+    } break;
+    case COLLISION_EVENT_ROCKET_SHOT_DOWN: {
+      if (world->projectiles.items[event->other].willBeDestroyed) {
+        break;
+      }
+
+      world->projectiles.items[i].willBeDestroyed = true;
+      world->projectiles.items[event->other].willBeDestroyed = true;
+    } break;
+    case COLLISION_EVENT_WEAPON_HIT: {
+      world->projectiles.items[i].willBeDestroyed = true;
+      bossBallDeactivateWeapon(event->other);
+    } break;
+    }
+  }
+}
+
+void ageProjectiles(int first, int last) {
+  Vector2 normalDown = {0, 1};
+  Vector2 normalUp = {0, -1};
+  Vector2 normalRight = {1, 0};
+  Vector2 normalLeft = {-1, 0};
+
+  for (int i = first; i < last; i++) {
+    world->projectiles.items[i].destructionTimer = Clamp(world->projectiles.items[i].destructionTimer - simulationFrameTime(),
+                                                   0,
+                                                   1.0f);
+
+    if (world->projectiles.items[i].willBeDestroyed) {
+      if (world->projectiles.items[i].destructionTimer <= 0) {
+        killEntity(&world->projectiles, i);
+      }
+
+      continue;
+    }
+
+    world->projectiles.items[i].lifetime -= simulationFrameTime();
+
+    if (world->projectiles.items[i].lifetime <= 0.0f) {
+      world->projectiles.items[i].willBeDestroyed = true;
+      world->projectiles.items[i].destructionTimer = 0.02f;
+      continue;
+    }
+
+    if (world->projectiles.items[i].canBounce && world->projectiles.items[i].type == PROJECTILE_REGULAR) {
+      float r = world->projectiles.items[i].radius;
+      Vector2 o = world->projectiles.items[i].origin;
+
+      #define PROJECTILE_LIFETIME_AFTER_BOUNCE 0.25f
+      if ((o.x - r) <= 0) {
+        world->projectiles.items[i].delta = Vector2Reflect(world->projectiles.items[i].delta,
+                                                     normalRight);
+        world->projectiles.items[i].lifetime = MIN(PROJECTILE_LIFETIME_AFTER_BOUNCE, world->projectiles.items[i].lifetime);
+      }
+
+      if ((o.x + r) >= LEVEL_WIDTH - 1) {
+        world->projectiles.items[i].delta = Vector2Reflect(world->projectiles.items[i].delta,
+                                                     normalLeft);
+        world->projectiles.items[i].lifetime = MIN(PROJECTILE_LIFETIME_AFTER_BOUNCE, world->projectiles.items[i].lifetime);
+      }
+
+      if ((o.y - r) <= 0) {
+        world->projectiles.items[i].delta = Vector2Reflect(world->projectiles.items[i].delta,
+                                                     normalDown);
+        world->projectiles.items[i].lifetime = MIN(PROJECTILE_LIFETIME_AFTER_BOUNCE, world->projectiles.items[i].lifetime);
+      }
+
+      if ((o.y + r) >= LEVEL_HEIGHT - 1) {
+        world->projectiles.items[i].delta = Vector2Reflect(world->projectiles.items[i].delta,
+                                                     normalUp);
+        world->projectiles.items[i].lifetime = MIN(PROJECTILE_LIFETIME_AFTER_BOUNCE, world->projectiles.items[i].lifetime);
+      }
+    } else if ((world->projectiles.items[i].origin.x <= 0) ||
+               (world->projectiles.items[i].origin.y <= 0) ||
+               (world->projectiles.items[i].origin.x >= (LEVEL_WIDTH - 1)) ||
+               (world->projectiles.items[i].origin.y >= (LEVEL_HEIGHT - 1))) {
+      world->projectiles.items[i].origin.x = Clamp(world->projectiles.items[i].origin.x,
+                                             0,
+                                             LEVEL_WIDTH - 1);
+      world->projectiles.items[i].origin.y = Clamp(world->projectiles.items[i].origin.y,
+                                             0,
+                                             LEVEL_HEIGHT - 1);
+
+      world->projectiles.items[i].willBeDestroyed = true;
+      world->projectiles.items[i].destructionTimer = 0.05f;
+      continue;
+    }
+  }
+}
+
+void moveProjectiles(int first, int last) {
+  for (int i = first; i < last; i++) {
+    if (world->projectiles.items[i].willBeDestroyed) {
+      continue;
+    }
+
+    if (world->projectiles.items[i].homesOntoPlayer && world->projectiles.items[i].type == PROJECTILE_SQUARED) {
+      Vector2 direction = Vector2Normalize(Vector2Subtract(world->player.position, world->projectiles.items[i].origin));
+      float speed = fabsf(Vector2Length(world->projectiles.items[i].delta)) - (simulationFrameTime() * 2);
+
+      speed = speed < 0.0 ? 0 : speed;
+
+      world->projectiles.items[i].delta = Vector2Scale(direction, speed);
+      world->projectiles.items[i].angle = atan2(world->projectiles.items[i].delta.y, world->projectiles.items[i].delta.x) * RAD2DEG + 90;
+    }
+
+    if ((world->playerPerks & PERK_HOMING) &&
+        (world->projectiles.items[i].hurts & COLLISION_LAYER_BOSS)) {
+      Vector2 bossPosition = Vector2Zero();
+
+      switch (world->currentBoss) {
+      case BOSS_MARINE: bossPosition = world->bossMarine.position; break;
+      case BOSS_BALL: bossPosition = world->bossBall.position; break;
+      }
+
+      Vector2 direction = Vector2Normalize(Vector2Subtract(bossPosition, world->projectiles.items[i].origin));
+      float speed = fabsf(Vector2Length(world->projectiles.items[i].delta));
+
+      Vector2 delta = Vector2Normalize(world->projectiles.items[i].delta);
+      delta = dampVector2(delta, direction, 0.1f);
+
+      world->projectiles.items[i].delta = Vector2Scale(delta, speed);
+      world->projectiles.items[i].angle = atan2(world->projectiles.items[i].delta.y, world->projectiles.items[i].delta.x) * RAD2DEG + 90;
+    }
+
+    world->projectiles.items[i].origin = stepVector2(world->projectiles.items[i].origin, world->projectiles.items[i].delta);
+  }
+}
+
+void buildProjectileCollisionWorld(void) {
+  collisionWorldBuild(COLLISION_LAYER_SHIPS |
+                      COLLISION_LAYER_ASTEROID |
+                      COLLISION_LAYER_BOSS |
+                      COLLISION_LAYER_BOSS_WEAPON |
+                      COLLISION_LAYER_ROCKET);
+}
+
+void updateProjectiles(void) {
+  int len = world->projectiles.pool.len;
+
+  ageProjectiles(0, len);
+  buildProjectileCollisionWorld();
+
+  world->collisionEvents.len = 0;
+  detectProjectileCollisions(0, len, &world->collisionEvents);
+  resolveCollisionEvents(&world->collisionEvents);
+
+  moveProjectiles(0, len);
+  compactEntities(&world->projectiles);
+}
+
+void updatePlayerCooldowns(void) {
+  float frameTime = simulationFrameTime();
+
+  bool dashCooldownActive = world->player.dashCooldown > 0.0f;
+
+#define COOLDOWN_MAX 10.0f
+#define DECREASE_COOLDOWN(c) (c) = Clamp((c) - frameTime, 0.0f, COOLDOWN_MAX)
+
+  DECREASE_COOLDOWN(world->player.fireCooldown);
+  DECREASE_COOLDOWN(world->player.dashCooldown);
+  DECREASE_COOLDOWN(world->player.iframeTimer);
+
+  frameTime *= 2;
+  DECREASE_COOLDOWN(world->player.dashReactivationEffectAlpha);
+
+  DECREASE_COOLDOWN(world->player.healTimer);
+
+#undef DECREASE_COOLDOWN
+
+  if (world->player.dashCooldown <= 0.0f && dashCooldownActive) {
+    world->player.dashReactivationEffectAlpha = 0.5f;
+  }
+}
+
+void updateCamera(void) {
+  float windowWidth = GetScreenWidth();
+  float windowHeight = GetScreenHeight();
+
+  float x = windowWidth / (float)screenWidth;
+  float y = windowHeight / (float)screenHeight;
+
+  float halfScreenWidth = (windowWidth / (2 * camera.zoom));
+  float halfScreenHeight = (windowHeight / (2 * camera.zoom));
+
+  Vector2 target = localShip == 0 ? world->player.position : world->wingman.position;
+
+  Vector2 topLeft = {
+    halfScreenWidth,
+    halfScreenHeight,
+  };
+
+  Vector2 bottomRight = {
+    (float)LEVEL_WIDTH - halfScreenWidth,
+    (float)LEVEL_HEIGHT - halfScreenHeight,
+  };
+
+  if (world->gameState == GAME_BOSS_DEAD) {
+    switch (world->currentBoss) {
+    case BOSS_MARINE: target = world->bossMarine.position; break;
+    case BOSS_BALL: target = world->bossBall.position; break;
+    }
+
+    topLeft = Vector2Zero();
+    bottomRight = level;
+  }
+
+  camera.offset.x = windowWidth / 2.0f;
+  camera.offset.y = windowHeight / 2.0f;
+
+  camera.zoom = MIN(x, y);
+
+  if (world->gameState == GAME_MAIN_MENU) {
+    camera.target.x = (float)LEVEL_WIDTH / 2;
+    camera.target.y = (float)LEVEL_HEIGHT / 2;
+    return;
+  }
+
+  if (world->gameState == GAME_BOSS_INTRODUCTION) {
+    camera.target = Vector2Clamp(cameraIntroductionTarget,
+                                 topLeft,
+                                 bottomRight);
+    return;
+  }
+
+  target = Vector2Clamp(target,
+                        topLeft,
+                        bottomRight);
+  camera.target = dampVector2(camera.target, target, 0.1f);
+}
+
+void initRaylib() {
+#if !defined(_DEBUG)
+  SetTraceLogLevel(LOG_NONE);
+#endif
+  InitWindow(screenWidth, screenHeight, "stribun");
+  InitAudioDevice();
+
+#if defined(PLATFORM_DESKTOP)
+  SetExitKey(KEY_NULL);
+  SetWindowState(FLAG_WINDOW_RESIZABLE | FLAG_WINDOW_MAXIMIZED | FLAG_BORDERLESS_WINDOWED_MODE);
+#endif
+
+  /* fix fragTexCoord for rectangles */
+  shapesTexture = (Texture2D) { rlGetTextureIdDefault(), 1, 1, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+  SetShapesTexture(shapesTexture, (Rectangle){ 0.0f, 0.0f, 1.0f, 1.0f });
+}
+
+void initBackgroundAsteroid(void) {
+  bigAssAsteroidPosition.x = (float) GetRandomValue(0, LEVEL_WIDTH);
+  bigAssAsteroidPosition.y = (float) GetRandomValue(0, LEVEL_HEIGHT);
+
+  bigAssAsteroidAngle = (float) GetRandomValue(0, 360);
+
+  bigAssAsteroidPositionDelta.x = (float)GetRandomValue(-1, 1) * 0.05f;
+  bigAssAsteroidPositionDelta.y = (float)GetRandomValue(-1, 1) * 0.05f;
+
+  bigAssAsteroidAngleDelta = (float)GetRandomValue(-1, 1) * 0.005f;
+}
+
+void initBossBallResources(void) {
+  memset(&bossBallCamera, 0, sizeof(bossBallCamera));
+  bossBallCamera.position = (Vector3) {0, 20, 0};
+  bossBallCamera.target = (Vector3) {0, 0, 0};
+  bossBallCamera.up = (Vector3) {0, 0, -1};
+  bossBallCamera.fovy = 45.0f;
+  bossBallCamera.projection = CAMERA_PERSPECTIVE;
+
+  bossBallLightingShader = LoadShader(TextFormat("assets/lighting-%d.vert", GLSL_VERSION),
+                                      TextFormat("assets/lighting-%d.frag", GLSL_VERSION));
+  bossBallLightingShader.locs[SHADER_LOC_VECTOR_VIEW] =
+    GetShaderLocation(bossBallLightingShader, "viewPos");
+
+  SetShaderValue(bossBallLightingShader,
+                 GetShaderLocation(bossBallLightingShader, "ambient"),
+                 (float[4]){ 0.3f, 0.3f, 0.3f, 1.0f },
+                 SHADER_UNIFORM_VEC4);
+
+  bossBallLight =
+    CreateLight(LIGHT_POINT,
+                (Vector3) {0, 10, 0},
+                Vector3Zero(),
+                WHITE,
+                bossBallLightingShader);
+
+  bossBallTexture = LoadTexture("assets/ball.png");
+
+  bossBallModel = LoadModel("assets/ball.obj");
+
+  SetMaterialTexture(&bossBallModel.materials[0], MATERIAL_MAP_ALBEDO, bossBallTexture);
+  bossBallModel.materials[0].shader = bossBallLightingShader;
+
+  bossBallRadius = 0.0f;
+  for (int m = 0; m < bossBallModel.meshCount; m++) {
+    Mesh mesh = bossBallModel.meshes[m];
+
+    for (int v = 0; v < mesh.vertexCount; v++) {
+      Vector3 vertex = {mesh.vertices[v * 3 + 0], mesh.vertices[v * 3 + 1], mesh.vertices[v * 3 + 2]};
+      bossBallRadius = fmaxf(bossBallRadius, Vector3Length(vertex));
+    }
+  }
+
+  /* NOTE: the model is drawn twice its size */
+  bossBallRadius *= 2;
+
+  /* NOTE: perspective makes the ball a bit bigger away from the center, so the target fits the biggest one */
+  float size = 0.0f;
+  Vector2 spots[] = {
+    {LEVEL_WIDTH / 2.0f, LEVEL_HEIGHT / 2.0f},
+    {0, 0},
+    {LEVEL_WIDTH, 0},
+    {0, LEVEL_HEIGHT},
+    {LEVEL_WIDTH, LEVEL_HEIGHT},
+  };
+
+  for (int i = 0; i < (int)(sizeof(spots) / sizeof(spots[0])); i++) {
+    Ray r = traceRay(spots[i], bossBallCamera);
+    Vector3 center = Vector3Add(r.position, Vector3Scale(r.direction, -r.position.y / r.direction.y));
+
+    Rectangle bounds = bossBallProjectedBounds(center);
+    size = fmaxf(size, fmaxf(bounds.width, bounds.height));
+  }
+
+  /* NOTE: one big pixel of room on every side for the snapping */
+  int pixels = (int)ceilf(size / BOSS_BALL_PIXEL_SIZE) + 2;
+
+  UnloadRenderTexture(bossBallTarget);
+  bossBallTarget = LoadRenderTexture(pixels, pixels);
+
+  if (bossBallImpostor) {
+    bakeBossBallImpostor();
+  }
+
+  bossBallMusic = LoadMusicStream("assets/reddream.xm");
+  SetMusicVolume(bossBallMusic, 0.5f);
+
+  for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
+    bossBallLaserSounds[i] = LoadMusicStream("assets/laser.wav");
+    SetMusicVolume(bossBallLaserSounds[i], 1.5f);
+  }
+}
+
+void bossBallCheckCollisions(bool sendAsteroidsFlying) {
+  collisionWorldBuild(COLLISION_LAYER_ASTEROID | COLLISION_LAYER_BOSS_WEAPON | COLLISION_LAYER_PLAYER);
+
+  Collider ball = circleCollider(COLLIDER_BOSS_BALL, 0, COLLISION_LAYER_BOSS, world->bossBall.position, BOSS_BALL_HITBOX_RADIUS);
+  size_t scratch = scratchBegin();
+  ContactList contacts = worldContacts();
+  collisionWorldQuery(&ball, COLLISION_LAYER_ASTEROID | COLLISION_LAYER_BOSS_WEAPON | COLLISION_LAYER_PLAYER, &contacts);
+
+  for (int c = 0; c < contacts.len; c++) {
+    const Contact *contact = &contacts.items[c];
+    const Collider *other = contactCollider(contact);
+
+    switch (other->owner) {
+    case COLLIDER_ASTEROID: {
+      int ai = other->index;
+
+      if (world->asteroids[ai].launchedByPlayer) {
+#define ASTEROID_BASE_DAMAGE 4
+        float damageMultiplier = Vector2Length(world->asteroids[ai].delta);
+        world->bossBall.health = (int)Clamp(world->bossBall.health - (damageMultiplier * ASTEROID_BASE_DAMAGE),
+                                            0.0f,
+                                            BOSS_BALL_MAX_HEALTH);
+        world->asteroids[ai].launchedByPlayer = false;
+        bossBallStealHealth();
+      }
+
+      moveAsteroid(ai, contact->push);
+      if (sendAsteroidsFlying) {
+        world->asteroids[ai].delta = Vector2Add(world->asteroids[ai].delta, Vector2Scale(contact->push, 0.5));
+      }
+    } break;
+    case COLLIDER_BOSS_BALL_WEAPON: {
+      world->bossBall.weapons[other->index].position = Vector2Add(world->bossBall.weapons[other->index].position, contact->push);
+      collisionWorldMove(contact->collider, contact->push);
+    } break;
+    case COLLIDER_PLAYER: {
+      world->player.position = Vector2Add(world->player.position, contact->push);
+      collisionWorldMove(contact->collider, contact->push);
+
+      if ((world->player.iframeTimer <= 0.0f) &&
+          ((world->playerPerks & PERK_OMINOUS_AURA) == 0)) {
+        playSound(hit);
+
+        world->player.health -= 2 * (world->playerPerks & PERK_MORE_BULLETS ? 2 : 1);
+        world->player.iframeTimer = 0.4f;
+      } else if (world->playerPerks & PERK_OMINOUS_AURA) {
+        world->bossBall.health -= 2;
+      }
+    } break;
+    default: break;
+    }
+  }
+
+  scratchEnd(scratch);
+}
+
+void bossBallUpdateWeapons(void);
+
+
+void initBossBall(void) {
+  memset(&world->bossBall, 0, sizeof(world->bossBall));
+  world->deadBallTimer = 2.0f;
+
+  world->bossBall = (BossBall) {
+    .position = {
+      .x = (float)LEVEL_WIDTH / 2,
+      .y = (float)LEVEL_HEIGHT / 2,
+    },
+    .standingStilTimer = 0.5f,
+    .health = BOSS_BALL_MAX_HEALTH,
+  };
+
+  BossBallWeaponType types[] = {
+    BOSS_BALL_WEAPON_TURRET,
+    BOSS_BALL_WEAPON_TURRET,
+    BOSS_BALL_WEAPON_TURRET,
+    BOSS_BALL_WEAPON_TURRET,
+
+    BOSS_BALL_WEAPON_LASER,
+    BOSS_BALL_WEAPON_LASER,
+
+    BOSS_BALL_WEAPON_ROCKET_LAUNCHER,
+    BOSS_BALL_WEAPON_ROCKET_LAUNCHER,
+  };
+
+  static_assert((sizeof(types) / sizeof(types[0])) == BOSS_BALL_WEAPONS, "asdf");
+
+  int i = 0;
+  while (i < BOSS_BALL_WEAPONS) {
+    int index = randomValue(0, BOSS_BALL_WEAPONS - 1);
+    if (types[index] == BOSS_BALL_WEAPON_NONE) {
+      continue;
+    }
+
+    world->bossBall.weapons[i] = (BossBallWeapon) {
+      .type = types[index],
+      .angle = 45 * i,
+      .fireCooldown = (float)randomValue(1, 15) / 10.0f,
+      .isDisconnected = false,
+      .deactivationDark = 1.0f,
+    };
+
+    types[index] = BOSS_BALL_WEAPON_NONE;
+    i++;
+  }
+
+  world->bossBall.targetPosition = world->bossBall.position;
+  world->bossBall.startingPosition = world->bossBall.position;
+
+  bossBallCheckCollisions(false);
+  bossBallUpdateWeapons();
+}
+
+void initBossMarine(void) {
+  memset(&world->bossMarine, 0, sizeof(world->bossMarine));
+  world->bossMarineLastAttack = 0;
+
+  world->bossMarine = (BossMarine) {
+    .position = {
+      .x = (float)LEVEL_WIDTH / 2,
+      .y = (float)LEVEL_HEIGHT / 2,
+    },
+    .health = BOSS_MARINE_MAX_HEALTH,
+    .boundingCircles = {
+      {{4, -25}, 12},
+      {{25, -14}, 5},
+      {{2, 22}, 15},
+      {{0, 12}, 14},
+      {{7, 10}, 12},
+      {{13, 0}, 7},
+      {{-14, 2}, 8},
+      {{-23, -9}, 12},
+      {{-10, -8}, 14},
+      {{6, -8}, 8},
+      {{17, -11}, 9},
+      {{27, -5}, 8},
+    },
+    .weaponAngle = 0,
+    .horizontalFlip = 1,
+    .walkingDirection = 1,
+    .weaponOffset = bossMarineInitialWeaponOffset,
+  };
+
+  initCompoundShape(&world->bossMarine.shapes[BOSS_MARINE_SHAPE(-1)],
+                    world->bossMarine.boundingCircles, BOSS_MARINE_BOUNDING_CIRCLES,
+                    SPRITES_SCALE, 0, -1);
+  initCompoundShape(&world->bossMarine.shapes[BOSS_MARINE_SHAPE(1)],
+                    world->bossMarine.boundingCircles, BOSS_MARINE_BOUNDING_CIRCLES,
+                    SPRITES_SCALE, 0, 1);
+
+  bossMarineUpdateBoundingCircles();
+  bossMarineCheckCollisions(false);
+};
+
+void initMusic(void) {
+  mainMenuMusic = LoadMusicStream("assets/drozerix_-_stardust_jam.mod");
+  SetMusicVolume(mainMenuMusic, 0.6);
+
+  bossMarineMusic = LoadMusicStream("assets/once_is_not_enough.mod");
+  SetMusicVolume(bossMarineMusic, 0.5);
+}
+
+void initMouse(void) {
+  DisableCursor();
+
+  screenMouseLocation = (Vector2) {
+    .x = (float)screenWidth / 2,
+    .y = ((float)screenHeight / 6),
+  };
+}
+
+void initPlayer(void) {
+  memset(&world->player, 0, sizeof(world->player));
+  memset(&world->dashTrails, 0, sizeof(world->dashTrails));
+
+  world->player = (Player) {
+    .position = (Vector2) {
+      .x = (float)LEVEL_WIDTH / 2,
+      .y = LEVEL_HEIGHT + ((float)LEVEL_HEIGHT / 6),
+    },
+    .isInvincible = false,
+    .health = MAX_PLAYER_HEALTH,
+  };
+}
+
+void initCamera(void) {
+  camera.rotation = 0;
+  camera.zoom = 1;
+}
+
+void initProjectiles(void) {
+  memset(&world->projectiles, 0, sizeof(world->projectiles));
+}
+
+void loadAsteroidPalettes(void) {
+  const int maxAsteroidSprites = (sizeof(asteroidSprites) / sizeof(asteroidSprites[0]));
+
+  for (int i = 0; i < maxAsteroidSprites; i++) {
+    Image a = LoadImageFromTexture(sprites);
+    ImageCrop(&a, asteroidSprites[i].textureRect);
+    asteroidSprites[i].palette = LoadImagePalette(a, MAX_ASTEROID_PALETTE_SIZE, &asteroidSprites[i].paletteLen);
+    UnloadImage(a);
+  }
+}
+
+void initAsteroids(void) {
+  const int maxAsteroidSprites = (sizeof(asteroidSprites) / sizeof(asteroidSprites[0]));
+
+  world->asteroidsLen = randomValue(MIN_ASTEROIDS, MAX_ASTEROIDS - 1);
+
+  for (int i = 0; i < world->asteroidsLen; i++) {
+    int asteroidSpriteIndex = randomValue(0, maxAsteroidSprites - 1);
+
+    int w = (int)asteroidSprites[asteroidSpriteIndex].textureRect.width;
+    int h = (int)asteroidSprites[asteroidSpriteIndex].textureRect.height;
+
+    world->asteroids[i].sprite = &asteroidSprites[asteroidSpriteIndex];
+    world->asteroids[i].angle = (float)randomValue(0, 360) - 180;
+    world->asteroids[i].angleDelta = (float)randomValue(-8, 8) / 64.0f;
+    world->asteroids[i].position.x = (float)randomValue(w, LEVEL_WIDTH - w);
+    world->asteroids[i].position.y = (float)randomValue(h, LEVEL_WIDTH - h);
+    world->asteroids[i].delta = (Vector2) {
+      .x = (float)randomValue(-8, 8) / 64.0f,
+      .y = (float)randomValue(-8, 8) / 64.0f,
+    };
+
+    asteroidUpdateBoundingCircles(i);
+  }
+}
+
+void initSoundEffects(void) {
+  dashSoundEffect = LoadSound("assets/dash.wav");
+  SetSoundVolume(dashSoundEffect, 0.3);
+
+  playerShot = LoadSound("assets/shot01.wav");
+  SetSoundVolume(playerShot, 0.5);
+
+  beep = LoadSound("assets/beep.wav");
+  hit = LoadSound("assets/hit.wav");
+  SetSoundVolume(hit, 0.7);
+
+  playerHealSound = LoadSound("assets/heal.wav");
+  /* SetSoundVolume(playerHealSound, 0.5); */
+
+  buttonFocusEffect = LoadSound("assets/hit.wav");
+  SetSoundVolume(buttonFocusEffect, 0.1);
+
+  borderActivation = LoadSound("assets/border.wav");
+  SetSoundVolume(borderActivation, 0.3);
+
+  bossMarineShotgunSound = LoadSound("assets/shot02.wav");
+  bossMarineGunshotSound = LoadSound("assets/shot03.wav");
+
+  bossBallTurretSound = LoadSound("assets/shot03.wav");
+
+  playerDeathSound = LoadSound("assets/dead.wav");
+
+  bossBallLaserChargingSound = LoadSound("assets/laser-charging.wav");
+  SetSoundVolume(bossBallLaserChargingSound, 0.5);
+
+  bossBallRocketSound = LoadSound("assets/rocket.wav");
+
+  bossBallDeath = LoadSound("assets/explosion.wav");
+
+  asteroidDestructionSound = LoadSound("assets/boom.wav");
+}
+
+void initShaders(void) {
+  {
+#define NEBULAE_NOISE_DOWNSCALE_FACTOR 1
+
+    Image n = GenImagePerlinNoise(background.x / NEBULAE_NOISE_DOWNSCALE_FACTOR,
+                                  background.y / NEBULAE_NOISE_DOWNSCALE_FACTOR,
+                                  0, 0, 4);
+
+    nebulaNoise = LoadTextureFromImage(n);
+    /* SetTextureFilter(nebulaNoise, TEXTURE_FILTER_BILINEAR); */
+    UnloadImage(n);
+  }
+
+  {
+    Vector4 arenaBorderColor0 = ColorNormalize(DARKBLUE);
+    Vector4 arenaBorderColor1 = ColorNormalize(BLUE);
+
+    arenaBorderShader = LoadShader(NULL, TextFormat("assets/border-%d.frag", GLSL_VERSION));
+    arenaBorderTime = GetShaderLocation(arenaBorderShader, "time");
+    SetShaderValue(arenaBorderShader,
+                   GetShaderLocation(arenaBorderShader, "borderColor0"),
+                   &arenaBorderColor0,
+                   SHADER_ATTRIB_VEC4);
+    SetShaderValue(arenaBorderShader,
+                   GetShaderLocation(arenaBorderShader, "borderColor1"),
+                   &arenaBorderColor1,
+                   SHADER_ATTRIB_VEC4);
+    SetShaderValue(arenaBorderShader,
+                   GetShaderLocation(arenaBorderShader, "resolution"),
+                   &level,
+                   SHADER_ATTRIB_VEC2);
+
+  }
+
+  {
+    Vector4 dashResetGlowColor = ColorNormalize(ColorAlpha(SKYBLUE, 0.1f));
+
+    dashResetShader = LoadShader(NULL, TextFormat("assets/dash-reset-glow-%d.frag", GLSL_VERSION));
+    dashResetShaderAlpha = GetShaderLocation(dashResetShader, "alpha");
+    dashResetShaderColor = GetShaderLocation(dashResetShader, "glowColor");
+
+    SetShaderValue(dashResetShader, dashResetShaderColor, &dashResetGlowColor, SHADER_UNIFORM_VEC4);
+  }
+
+  {
+    stars = LoadShader(NULL, TextFormat("assets/stars-%d.frag", GLSL_VERSION));
+    starsTime = GetShaderLocation(stars, "time");
+
+    SetShaderValue(stars,
+                   GetShaderLocation(stars, "resolution"),
+                   &background,
+                   SHADER_UNIFORM_VEC2);
+
+    nebula = LoadShader(NULL, TextFormat("assets/nebula-%d.frag", GLSL_VERSION));
+    nebulaDom = GetShaderLocation(nebula, "dom");
+  }
+
+  {
+    playerHealthBarShader = LoadShader(NULL, TextFormat("assets/health-bar-%d.frag", GLSL_VERSION));
+    Vector4 good = ColorNormalize((Color) {129, 73, 151, 255});
+    Vector4 bad = ColorNormalize(BLACK);
+
+    SetShaderValue(playerHealthBarShader,
+                   GetShaderLocation(playerHealthBarShader, "goodColor"),
+                   &good,
+                   SHADER_UNIFORM_VEC4);
+    SetShaderValue(playerHealthBarShader,
+                   GetShaderLocation(playerHealthBarShader, "badColor"),
+                   &bad,
+                   SHADER_UNIFORM_VEC4);
+    playerHealthBarHealth = GetShaderLocation(playerHealthBarShader, "health");
+
+    playerHealthBarHealTimer = GetShaderLocation(playerHealthBarShader, "healTimer");
+    int shaderHealColor = GetShaderLocation(playerHealthBarShader, "healColor");
+    Vector4 healColor = ColorNormalize(ColorAlpha(GREEN, 0.1));
+
+    SetShaderValue(playerHealthBarShader,
+                   shaderHealColor,
+                   &healColor,
+                   SHADER_UNIFORM_VEC4);
+  }
+
+  {
+    playerHealthOverlayShader = LoadShader(NULL, TextFormat("assets/health-overlay-%d.frag", GLSL_VERSION));
+
+    /* Vector4 good = ColorNormalize((Color) {164, 36, 40, 255}); */
+    Vector4 good = ColorNormalize((Color) {129, 73, 151, 255});
+    SetShaderValue(playerHealthOverlayShader,
+                   GetShaderLocation(playerHealthOverlayShader, "goodColor"),
+                   &good,
+                   SHADER_UNIFORM_VEC4);
+
+    /* Vector4 bad = ColorNormalize((Color) {69, 69, 69, 255}); */
+    Vector4 bad = ColorNormalize(BLACK);
+    SetShaderValue(playerHealthOverlayShader,
+                   GetShaderLocation(playerHealthOverlayShader, "badColor"),
+                   &bad,
+                   SHADER_UNIFORM_VEC4);
+
+    playerHealthOverlayHealth = GetShaderLocation(playerHealthOverlayShader, "health");
+
+    Image mask = LoadImage("assets/sprites.png");
+    ImageCrop(&mask, playerHealthOverlayMaskRect);
+    playerHealthMaskTexture = LoadTextureFromImage(mask);
+    UnloadImage(mask);
+  }
+
+  {
+    dashTrailShader = LoadShader(NULL, TextFormat("assets/dash-trail-%d.frag", GLSL_VERSION));
+    dashTrailShaderColor = GetShaderLocation(dashTrailShader, "trailColor");
+  }
+
+  {
+    pixelationShader = LoadShader(NULL, TextFormat("assets/pixelation-%d.frag", GLSL_VERSION));
+    SetShaderValue(pixelationShader,
+                   GetShaderLocation(pixelationShader, "resolution"),
+                   &level,
+                   SHADER_UNIFORM_VEC2);
+
+    pixelationShaderPixelSize = GetShaderLocation(pixelationShader, "pixelSize");
+  }
+
+  {
+    laserShader = LoadShader(NULL, TextFormat("assets/laser-%d.frag", GLSL_VERSION));
+    SetShaderValue(laserShader,
+                   GetShaderLocation(laserShader, "resolution"),
+                   (float[2]){LASER_WIDTH, LASER_HEIGHT},
+                   SHADER_UNIFORM_VEC2);
+
+    laserShaderTime = GetShaderLocation(laserShader, "time");
+  }
+
+  {
+    playerAuraShader = LoadShader(NULL, TextFormat("assets/aura-%d.frag", GLSL_VERSION));
+    playerAuraTime = GetShaderLocation(playerAuraShader, "time");
+  }
+}
+
+void adjustBossBallTargetScreen(void) {
+  UnloadRenderTexture(bossBallTargetScreen);
+
+  bossBallTargetScreen = LoadRenderTexture(GetScreenWidth(), GetScreenHeight());
+}
+
+void initTextures(void) {
+  sprites = LoadTexture("assets/sprites.png");
+  loadAsteroidPalettes();
+
+  if (!directRendering) {
+    target = LoadRenderTexture(LEVEL_WIDTH, LEVEL_HEIGHT);
+  }
+
+  adjustBossBallTargetScreen();
+
+  playerTexture = LoadRenderTexture(playerRect.width, playerRect.height);
+  playerTexture1 = LoadRenderTexture(playerRect.width, playerRect.height);
+  playerTexture2 = LoadRenderTexture(playerRect.width, playerRect.height);
+  playerAuraTexture = LoadRenderTexture(PLAYER_AURA_WIDTH, PLAYER_AURA_HEIGHT);
+
+  nebulaTexture = LoadRenderTexture(background.x, background.y);
+
+  starsTexture = LoadRenderTexture(background.x / STARS_DOWNSCALE_FACTOR, background.y / STARS_DOWNSCALE_FACTOR);
+  SetTextureFilter(starsTexture.texture, TEXTURE_FILTER_BILINEAR);
+}
+
+void initThrusterTrails(void) {
+  memset(thrusterTrail, 0, sizeof(thrusterTrail));
+  thrusterTrailHead = 0;
+}
+
+void updateBackgroundAsteroid(void) {
+  bigAssAsteroidPosition = stepVector2(bigAssAsteroidPosition,
+                                       bigAssAsteroidPositionDelta);
+  bigAssAsteroidAngle += bigAssAsteroidAngleDelta * frameSteps();
+}
+
+void resetGame(void) {
+  StopMusicStream(bossMarineMusic);
+
+  initAsteroids();
+  initPlayer();
+  initBossMarine();
+  initBossBall();
+  initBossBall();
+  initBackgroundAsteroid();
+  initProjectiles();
+
+  world->currentBoss = BOSS_MARINE;
+
+  memset(&world->particles, 0, sizeof(world->particles));
+
+  initThrusterTrails();
+
+  introductionStage = BOSS_INTRODUCTION_BEGINNING;
+}
+
+static bool pauseMouseWasDown = false;
+
+static Vector2 previousMousePressLocation = {0};
+static Vector2 previousMouseLocation = {0};
+
+bool updateReplayScrubBar(Rectangle bar);
+void renderReplayScrubBar(Rectangle bar, float mul);
+
+void updateAndRenderPauseScreen(void) {
+  updateMouse();
+
+  bool isMouseDown = IsMouseButtonDown(MOUSE_BUTTON_LEFT);
+  bool released = false;
+
+  if (isMouseDown == false && pauseMouseWasDown == true) {
+    released = true;
+  }
+  pauseMouseWasDown = isMouseDown;
+
+  bool pressed = IsMouseButtonPressed(MOUSE_BUTTON_LEFT);
+
+  if (pressed) {
+    previousMousePressLocation = screenMouseLocation;
+  }
+
+  float mul = camera.zoom * 2;
+  Font f = GetFontDefault();
+  float fontSize = 25 * mul;
+  float spacing = 2 * mul;
+
+  float w = (float)GetScreenWidth();
+  float h = (float)GetScreenHeight();
+
+  float bw = w / 4.5;
+  float bh = h / 8;
+  float x = w / 2;
+  float y = h / 2 - (bh);
+
+  Rectangle buttonContinue = {x - (bw / 2), y - (bh / 2), bw, bh};
+  Rectangle buttonQuit = {x - (bw / 2), y - (bh / 2) + (bh * 2), bw, bh};
+  Rectangle scrubBar = {w * 0.15f, h - (bh * 1.25f), w * 0.7f, bh / 4};
+
+  /* NOTE: the world was rewound, so the frame behind the menu has to be drawn again */
+  if (updateReplayScrubBar(scrubBar)) {
+    updateCamera();
+    renderPhase1();
+  }
+
+  BeginDrawing(); {
+    ClearBackground(BLACK);
+
+    {
+      presentWorld(renderWorld);
+
+      if (world->gameState == GAME_BOSS) {
+        renderBossHealthBar();
+        renderPlayerHealthBar();
+      }
+    }
+
+    DrawRectangle(0, 0, w, h, ColorAlpha(BLACK, 0.7));
+
+    {
+      if (!CheckCollisionPointRec(previousMouseLocation, buttonContinue) &&
+          CheckCollisionPointRec(screenMouseLocation, buttonContinue)) {
+        PlaySound(buttonFocusEffect);
+      }
+
+
+      if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) &&
+          CheckCollisionPointRec(previousMousePressLocation, buttonContinue) &&
+          CheckCollisionPointRec(screenMouseLocation, buttonContinue)) {
+        DrawRectangleRec(buttonContinue,
+                         LIGHTGRAY);
+      } else {
+        DrawRectangleRec(buttonContinue,
+                         WHITE);
+      }
+
+      if (CheckCollisionPointRec(screenMouseLocation, buttonContinue)) {
+        DrawRectangleLinesEx(buttonContinue,
+                             2 * mul,
+                             LIGHTGRAY);
+      }
+
+      char *text = "CONTINUE";
+
+      Vector2 size = MeasureTextEx(f, text, fontSize, spacing);
+
+      Vector2 pos = (Vector2) {
+        .x = (float)buttonContinue.x + buttonContinue.width / 2,
+        .y = (float)buttonContinue.y + buttonContinue.height / 2,
+      };
+
+      DrawTextPro(f,
+                  text,
+                  pos,
+                  Vector2Scale(size, 0.5f),
+                  0,
+                  fontSize,
+                  spacing,
+                  BLACK);
+    }
+
+    {
+
+      if (!CheckCollisionPointRec(previousMouseLocation, buttonQuit) &&
+          CheckCollisionPointRec(screenMouseLocation, buttonQuit)) {
+        PlaySound(buttonFocusEffect);
+      }
+
+      if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) &&
+          CheckCollisionPointRec(previousMousePressLocation, buttonQuit) &&
+          CheckCollisionPointRec(screenMouseLocation, buttonQuit)) {
+        DrawRectangleRec(buttonQuit,
+                         LIGHTGRAY);
+      } else {
+        DrawRectangleRec(buttonQuit,
+                         WHITE);
+      }
+
+      if (CheckCollisionPointRec(screenMouseLocation, buttonQuit)) {
+        DrawRectangleLinesEx(buttonQuit,
+                             2 * mul,
+                             LIGHTGRAY);
+      }
+
+      char *text = "QUIT";
+
+      Vector2 size = MeasureTextEx(f, text, fontSize, spacing);
+
+      Vector2 pos = (Vector2) {
+        .x = (float)buttonQuit.x + buttonQuit.width / 2,
+        .y = (float)buttonQuit.y + buttonQuit.height / 2,
+      };
+
+      DrawTextPro(f,
+                  text,
+                  pos,
+                  Vector2Scale(size, 0.5f),
+                  0,
+                  fontSize,
+                  spacing,
+                  BLACK);
+    }
+
+    renderReplayScrubBar(scrubBar, mul);
+
+    renderMouseCursor();
+  } EndDrawing();
+
+  if (released) {
+    if (CheckCollisionPointRec(previousMousePressLocation, buttonContinue) &&
+        CheckCollisionPointRec(screenMouseLocation, buttonContinue)) {
+      PlaySound(beep);
+      isGamePaused = false;
+    } else if (CheckCollisionPointRec(previousMousePressLocation, buttonQuit) &&
+               CheckCollisionPointRec(screenMouseLocation, buttonQuit)) {
+      PlaySound(beep);
+      isGamePaused = false;
+
+      world->gameState = GAME_MAIN_MENU;
+      resetGame();
+    }
+  }
+
+  previousMouseLocation = screenMouseLocation;
+}
+
+void bossBallRoll(void) {
+  if (world->bossBall.standingStilTimer > 0.0f) {
+    world->bossBall.standingStilTimer -= simulationFrameTime();
+    return;
+  }
+
+  float distance = Vector2Distance(world->bossBall.targetPosition, world->bossBall.position);
+  float step = BOSS_BALL_MOVE_SPEED * frameSteps();
+
+  if (distance <= (step / 2.0f)) {
+    bool toMoveOrNotToMove = (bool)randomValue(0, 1);
+
+    if (toMoveOrNotToMove) {
+      world->bossBall.targetPosition.x = (float)randomValue(BOSS_BALL_HITBOX_RADIUS, LEVEL_WIDTH - BOSS_BALL_HITBOX_RADIUS);
+      world->bossBall.targetPosition.y = (float)randomValue(BOSS_BALL_HITBOX_RADIUS, LEVEL_HEIGHT - BOSS_BALL_HITBOX_RADIUS);
+
+      world->bossBall.startingPosition = world->bossBall.position;
+
+      Vector2 dir = Vector2Normalize(Vector2Subtract(world->bossBall.targetPosition, world->bossBall.startingPosition));
+
+      world->bossBall.standingStilTimer = 0;
+      world->bossBall.angle = 1;
+      world->bossBall.rotationAxis = (Vector3) {roundf(dir.y), 0, -roundf(dir.x)};
+    } else {
+      world->bossBall.standingStilTimer = (float)randomValue(1, 10) / 10.0f;
+      world->bossBall.rotationAxis = Vector3Zero();
+      world->bossBall.angle = 0;
+      world->bossBall.targetPosition = world->bossBall.position;
+      world->bossBall.startingPosition = world->bossBall.position;
+    }
+
+    if (randomValue(1, 10) == 1) {
+      world->bossBall.weaponAngleTargetOffset = randomValue(0, 360);
+
+      for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
+        world->bossBall.weapons[i].attackTimer = 0;
+        world->bossBall.weapons[i].chargeLevel = 0;
+        world->bossBall.weapons[i].laserLength = 0;
+      }
+    }
+  } else {
+    Vector2 dir = Vector2Normalize(Vector2Subtract(world->bossBall.targetPosition, world->bossBall.startingPosition));
+    Vector2 delta = Vector2Scale(dir, step);
+
+    world->bossBall.position = Vector2Add(world->bossBall.position, delta);
+
+    world->bossBall.position = Vector2Clamp(world->bossBall.position,
+                                            (Vector2) {
+                                       BOSS_BALL_HITBOX_RADIUS,
+                                       BOSS_BALL_HITBOX_RADIUS,
+                                            },
+                                            (Vector2) {
+                                       LEVEL_WIDTH - BOSS_BALL_HITBOX_RADIUS,
+                                       LEVEL_HEIGHT - BOSS_BALL_HITBOX_RADIUS,
+                                            });
+
+    float fullDistance = Vector2Distance(world->bossBall.targetPosition, world->bossBall.startingPosition);
+    float progress = Vector2Distance(world->bossBall.position, world->bossBall.startingPosition);
+
+    float angle = (progress / fullDistance) * 360;
+
+    if (isnormal(angle)) {
+      world->bossBall.angle = angle;
+    }
+  }
+}
+
+void bossBallShootProjectile(float speedMultiplier, float fireCooldown, Sound *sound, float lifetime, Color inside, Color outside, int i, float angle, Vector2 origin) {
+  if (world->bossBall.weapons[i].fireCooldown > 0.0f) {
+    return;
+  }
+
+  Projectile *new_projectile = push_projectile();
+
+  if (new_projectile == NULL) {
+    return;
+  }
+
+  *new_projectile = (Projectile) {
+    .type = PROJECTILE_REGULAR,
+    .hurts = BOSS_PROJECTILE_HURTS,
+    .damage = 1,
+    .origin = Vector2Add(origin, world->bossBall.weapons[i].position),
+    .radius = 10,
+    .delta = Vector2Rotate((Vector2){0, -(25.0f * speedMultiplier)},
+                           angle * DEG2RAD),
+    .angle = 0,
+    .inside = inside,
+    .outside = outside,
+    .lifetime = lifetime,
+    .canBounce = false,
+  };
+
+  world->bossBall.weapons[i].fireCooldown = fireCooldown;
+
+  if (sound) {
+    playSound(*sound);
+  }
+}
+
+void bossBallAttack(void) {
+  collisionWorldBuild(COLLISION_LAYER_ASTEROID);
+
+  for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
+    Color red = {243, 83, 54, 255};
+
+    world->bossBall.weapons[i].attackCooldown -= simulationFrameTime();
+
+    if (world->bossBall.weapons[i].attackCooldown > 0.0f) {
+      continue;
+    }
+
+    if (world->bossBall.weapons[i].isDisconnected) {
+      world->bossBall.weapons[i].seesPlayer = true;
+    }
+
+    world->bossBall.weapons[i].isDeactivated = false;
+
+    world->bossBall.weapons[i].attackTimer -= simulationFrameTime();
+
+    if (world->bossBall.weapons[i].seesPlayer &&
+        world->bossBall.weapons[i].attackTimer <= 0.0f &&
+        world->bossBall.weapons[i].attackCooldown <= 0.0f) {
+      world->bossBall.weapons[i].attackTimer = 1;
+    }
+
+    if (world->bossBall.weapons[i].attackTimer > 0.0f) {
+      world->bossBall.weapons[i].fireCooldown -= simulationFrameTime();
+
+      float angle = bossBallWeaponAimAngle(i);
+
+      switch (world->bossBall.weapons[i].type) {
+      case BOSS_BALL_WEAPON_TURRET: {
+        if (world->bossBall.weapons[i].fireCooldown <= 0.0f) {
+          bossBallShootProjectile(0.5f, 0, NULL, 10, red, RED, i, angle, world->bossBall.weapons[i].bulletOrigin);
+          bossBallShootProjectile(0.5f, 0.07f, NULL, 10, red, RED, i, angle, world->bossBall.weapons[i].bulletOrigin2);
+          playSound(bossBallTurretSound);
+        }
+      } break;
+      case BOSS_BALL_WEAPON_LASER: {
+        if (world->bossBall.weapons[i].chargeLevel == 0.0f) {
+          playSound(bossBallLaserChargingSound);
+        }
+
+        updateMusic(bossBallLaserSounds[i]);
+
+        if (world->bossBall.weapons[i].chargeLevel < 1.0f) {
+          world->bossBall.weapons[i].chargeLevel += simulationFrameTime();
+        } else {
+          if (!isMusicPlaying(bossBallLaserSounds[i])) {
+            playMusic(bossBallLaserSounds[i]);
+          }
+
+          /* NOTE: the beam stops at the first asteroid in its way */
+          float reach = collisionWorldRaycast(laserOrigin(i), laserDirection(i), LASER_WIDTH, COLLISION_LAYER_ASTEROID);
+
+          world->bossBall.weapons[i].laserLength = MIN(damp(world->bossBall.weapons[i].laserLength, reach, 0.1f), reach);
+        }
+      } break;
+      case BOSS_BALL_WEAPON_ROCKET_LAUNCHER: {
+        if (world->bossBall.weapons[i].fireCooldown > 0.0f) {
+          break;
+        }
+
+        Projectile *new_projectile = push_projectile();
+
+        if (new_projectile == NULL) {
+          break;
+        }
+
+        *new_projectile = (Projectile) {
+          .type = PROJECTILE_SQUARED,
+          .hurts = BOSS_PROJECTILE_HURTS,
+          .damage = 1,
+          .origin = Vector2Add(world->bossBall.weapons[i].bulletOrigin, world->bossBall.weapons[i].position),
+          .size = (Vector2) {30, 50},
+          .delta = Vector2Rotate((Vector2){0, -10}, angle * DEG2RAD),
+          .angle = angle,
+          .inside = BLACK,
+          .outside = red,
+          .lifetime = 5,
+          .canBounce = false,
+          .homesOntoPlayer = true,
+        };
+
+        world->bossBall.weapons[i].fireCooldown = 1.0f;
+
+        playSound(bossBallRocketSound);
+      } break;
+      case BOSS_BALL_WEAPON_COUNT: break;
+      case BOSS_BALL_WEAPON_NONE: break;
+      }
+    } else {
+      stopMusic(bossBallLaserSounds[i]);
+
+      world->bossBall.weapons[i].laserLength = 0;
+      world->bossBall.weapons[i].chargeLevel = 0;
+
+      world->bossBall.weapons[i].attackCooldown = world->bossBall.weapons[i].isDisconnected ? 2.5f : 0.5f;
+    }
+  }
+}
+
+void bossBallWeaponCalculateBulletOrigin(int i, float angle) {
+  Vector2 laserBulletOrigin = Vector2Scale((Vector2){0, -20}, SPRITES_SCALE);
+  Vector2 rocketLauncherBulletOrigin = Vector2Scale((Vector2){0, -30}, SPRITES_SCALE);
+
+  Vector2 turretBulletOrigin1 = Vector2Scale((Vector2){-13, -23}, SPRITES_SCALE);
+  Vector2 turretBulletOrigin2 = Vector2Scale((Vector2){13, -23}, SPRITES_SCALE);
+
+  float rads = angle * DEG2RAD;
+
+  switch (world->bossBall.weapons[i].type) {
+  case BOSS_BALL_WEAPON_LASER: {
+    world->bossBall.weapons[i].bulletOrigin = Vector2Rotate(laserBulletOrigin, rads);
+  } break;
+  case BOSS_BALL_WEAPON_ROCKET_LAUNCHER: {
+    world->bossBall.weapons[i].bulletOrigin = Vector2Rotate(rocketLauncherBulletOrigin, rads);
+  } break;
+  case BOSS_BALL_WEAPON_TURRET: {
+    world->bossBall.weapons[i].bulletOrigin = Vector2Rotate(turretBulletOrigin1, rads);
+    world->bossBall.weapons[i].bulletOrigin2 = Vector2Rotate(turretBulletOrigin2, rads);
+  } break;
+  case BOSS_BALL_WEAPON_COUNT: break;
+  case BOSS_BALL_WEAPON_NONE: break;
+  }
+}
+
+#define BOSS_BALL_WEAPON_DISTANCE ((float)BOSS_BALL_HITBOX_RADIUS * 1.5f)
+
+void bossBallUpdateConnectedWeapon(int i) {
+  Vector2 up = {0, -BOSS_BALL_WEAPON_DISTANCE};
+
+  float angle =
+    world->bossBall.weapons[i].angle +
+    world->bossBall.weaponAngleOffset;
+
+  if (angle >= 360.0) {
+    angle -= 360.0f;
+  }
+
+  world->bossBall.weapons[i].position = Vector2Rotate(up, angle * DEG2RAD);
+  world->bossBall.weapons[i].position = Vector2Add(world->bossBall.position, world->bossBall.weapons[i].position);
+
+  float a = angleBetweenPoints(world->bossBall.weapons[i].position, world->player.position);
+  float offset = a - angle;
+
+  world->bossBall.weapons[i].seesPlayer = true;
+
+#define BOSS_BALL_MAX_WEAPON_ANGLE_OFFSET 60.0f
+  if (fabsf(offset) > BOSS_BALL_MAX_WEAPON_ANGLE_OFFSET) {
+    offset = 0;
+    world->bossBall.weapons[i].seesPlayer = false;
+  }
+
+  float t = 0.1f;
+
+  if (world->bossBall.weapons[i].type == BOSS_BALL_WEAPON_LASER &&
+      world->bossBall.weapons[i].chargeLevel >= 1.0f) {
+    t = 0.03;
+  }
+
+  world->bossBall.weapons[i].angleOffset = damp(world->bossBall.weapons[i].angleOffset, offset, t);
+
+  bossBallWeaponCalculateBulletOrigin(i, world->bossBall.weapons[i].angle + world->bossBall.weaponAngleOffset + world->bossBall.weapons[i].angleOffset);
+}
+
+void disconnectedWeaponsCollision(int i) {
+  collisionWorldBuild(COLLISION_LAYER_BOSS_WEAPON);
+
+  Collider weapon = circleCollider(COLLIDER_BOSS_BALL_WEAPON, i, COLLISION_LAYER_BOSS_WEAPON,
+                                   world->bossBall.weapons[i].position,
+                                   bossBallWeaponHitboxRadiuses[world->bossBall.weapons[i].type]);
+
+  size_t scratch = scratchBegin();
+  ContactList contacts = worldContacts();
+
+  if (collisionWorldQuery(&weapon, COLLISION_LAYER_BOSS_WEAPON, &contacts) > 0) {
+    const Contact *contact = &contacts.items[0];
+    int j = contactCollider(contact)->index;
+
+    world->bossBall.weapons[j].position = Vector2Add(world->bossBall.weapons[j].position, contact->push);
+  }
+
+  scratchEnd(scratch);
+}
+
+#define WEAPON_MOVE_SPEED 2
+#define WEAPON_MIN_PLAYER_DISTANCE 150
+#define WEAPON_MAX_PLAYER_DISTANCE 600
+void weaponFollowPlayer(int i) {
+  float weaponPlayerAngle = angleBetweenPoints(world->player.position, world->bossBall.weapons[i].position);
+  float weaponPlayerDistance = Vector2Distance(world->player.position, world->bossBall.weapons[i].position);
+
+  Vector2 delta = Vector2Rotate((Vector2) {0, -WEAPON_MOVE_SPEED},
+                                weaponPlayerAngle * DEG2RAD);
+
+  if (weaponPlayerDistance < WEAPON_MIN_PLAYER_DISTANCE) {
+    world->bossBall.weapons[i].position = stepVector2(world->bossBall.weapons[i].position,
+                                                      Vector2Scale(delta, -1));
+  } else if (weaponPlayerDistance > WEAPON_MAX_PLAYER_DISTANCE) {
+    world->bossBall.weapons[i].position = stepVector2(world->bossBall.weapons[i].position,
+                                                      delta);
+  } else if (world->bossBall.weapons[i].isWalking) {
+    float angle = world->bossBall.weapons[i].walkingDirection * WEAPON_MOVE_SPEED * frameSteps();
+    Vector2 diff = Vector2Subtract(world->bossBall.weapons[i].position, world->player.position);
+    diff = Vector2Rotate(diff, angle * DEG2RAD);
+    world->bossBall.weapons[i].position = dampVector2(world->bossBall.weapons[i].position,
+                                                      Vector2Add(diff, world->player.position),
+                                                      0.1f);
+  }
+}
+
+void bossBallUpdateDisconnectedWeapon(int i) {
+  disconnectedWeaponsCollision(i);
+
+  if (world->bossBall.weapons[i].isDeactivated) {
+    world->bossBall.weapons[i].deactivationDark = damp(world->bossBall.weapons[i].deactivationDark, 0.5f, 0.1f);
+    return;
+  }
+
+  world->bossBall.weapons[i].deactivationDark = damp(world->bossBall.weapons[i].deactivationDark, 1.0f, 0.1f);
+
+  if (world->bossBall.weapons[i].standingWalkingTimer <= 0.0f) {
+    world->bossBall.weapons[i].isWalking = randomValue(0, 1);
+    world->bossBall.weapons[i].walkingDirection = randomValue(-1, 1);
+    world->bossBall.weapons[i].standingWalkingTimer = randomValue(1, 5);
+  } else {
+    world->bossBall.weapons[i].standingWalkingTimer -= simulationFrameTime();
+  }
+
+  weaponFollowPlayer(i);
+
+  float angle = angleBetweenPoints(world->bossBall.weapons[i].position, world->player.position);
+
+  float t = 0.1f;
+
+  if (world->bossBall.weapons[i].type == BOSS_BALL_WEAPON_LASER &&
+      world->bossBall.weapons[i].chargeLevel >= 1.0f) {
+    t = 0.03;
+  }
+
+  world->bossBall.weapons[i].angle = damp(world->bossBall.weapons[i].angle, angle, t);
+
+  bossBallWeaponCalculateBulletOrigin(i, world->bossBall.weapons[i].angle);
+
+  float r = bossBallWeaponHitboxRadiuses[world->bossBall.weapons[i].type];
+  Vector2 min = {r, r};
+  Vector2 max = {LEVEL_WIDTH - r, LEVEL_HEIGHT - r};
+
+  world->bossBall.weapons[i].position = Vector2Clamp(world->bossBall.weapons[i].position, min, max);
+}
+
+void bossBallUpdateWeapons(void) {
+  for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
+    if (world->bossBall.weapons[i].isDisconnected) {
+      bossBallUpdateDisconnectedWeapon(i);
+    } else {
+      bossBallUpdateConnectedWeapon(i);
+    }
+  }
+}
+
+int compareWeaponsBasedOnDistanceToPlayer(const void *a, const void *b) {
+  const int i = *(const int*)a;
+  const int j = *(const int*)b;
+
+  const float d1 = Vector2Distance(world->bossBall.weapons[i].position,
+                                   world->player.position);
+  const float d2 = Vector2Distance(world->bossBall.weapons[j].position,
+                                   world->player.position);
+
+  if (d1 < d2) {
+    return -1;
+  }
+
+  if (d1 > d2) {
+    return 1;
+  }
+
+  return 0;
+}
+
+void tryDisconnectingWeapon(void) {
+  int weaponIndexes[BOSS_BALL_WEAPONS] = {0};
+  for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
+    weaponIndexes[i] = i;
+  }
+
+  qsort(weaponIndexes,
+        BOSS_BALL_WEAPONS, sizeof(weaponIndexes[0]),
+        compareWeaponsBasedOnDistanceToPlayer);
+
+  for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
+    int j = weaponIndexes[i];
+
+    if (world->bossBall.weapons[j].isDisconnected) {
+      continue;
+    }
+
+    world->bossBall.weapons[j].isDisconnected = true;
+    break;
+  }
+}
+
+void disconnectAWeaponIfThePlayerIsTooCloseForTooLong(void) {
+  if (Vector2Distance(world->player.position, world->bossBall.position) <= (BOSS_BALL_WEAPON_DISTANCE * 1.5f)) {
+    world->bossBall.playerInsideDeadZoneTimer += simulationFrameTime();
+  } else {
+    world->bossBall.playerInsideDeadZoneTimer = damp(world->bossBall.playerInsideDeadZoneTimer, 0, 0.1f);
+  }
+
+  #define PLAYER_DEAD_ZONE_TIMER_LIMIT 1.5f
+  if (world->bossBall.playerInsideDeadZoneTimer >= PLAYER_DEAD_ZONE_TIMER_LIMIT) {
+    world->bossBall.playerInsideDeadZoneTimer = 0.0f;
+
+    tryDisconnectingWeapon();
+  }
+}
+
+void bossBallCheckDisconnectedWeaponCollisions(void) {
+  collisionWorldBuild(COLLISION_LAYER_ASTEROID | COLLISION_LAYER_PLAYER);
+
+  size_t scratch = scratchBegin();
+  ContactList contacts = worldContacts();
+
+  for (int w = 0; w < BOSS_BALL_WEAPONS; w++) {
+    if (!world->bossBall.weapons[w].isDisconnected) {
+      continue;
+    }
+
+    Collider weapon = circleCollider(COLLIDER_BOSS_BALL_WEAPON, w, COLLISION_LAYER_BOSS_WEAPON,
+                                     world->bossBall.weapons[w].position,
+                                     bossBallWeaponHitboxRadiuses[world->bossBall.weapons[w].type]);
+
+    if (collisionWorldQuery(&weapon, COLLISION_LAYER_ASTEROID, &contacts) > 0) {
+      const Contact *contact = &contacts.items[0];
+      int i = contactCollider(contact)->index;
+
+      moveAsteroid(i, contact->push);
+      world->asteroids[i].delta = Vector2Add(world->asteroids[i].delta, Vector2Scale(contact->push, 0.1f));
+
+      if (world->asteroids[i].launchedByPlayer) {
+        world->asteroids[i].launchedByPlayer = false;
+        bossBallDeactivateWeapon(w);
+      }
+    }
+
+    if (collisionWorldQuery(&weapon, COLLISION_LAYER_PLAYER, &contacts) > 0) {
+      const Contact *contact = &contacts.items[0];
+
+      world->player.position = Vector2Add(world->player.position, contact->push);
+      collisionWorldMove(contact->collider, contact->push);
+
+      if (world->playerPerks & PERK_OMINOUS_AURA) {
+        bossBallDeactivateWeapon(w);
+      }
+    }
+  }
+
+  scratchEnd(scratch);
+}
+
+void disconnectWeaponBasedOhHealth(void) {
+  float health = (float)world->bossBall.health / (float)BOSS_BALL_MAX_HEALTH;
+  int supposedAmountOfConnectedWeapons = floorf(((float)BOSS_BALL_WEAPONS + 1) * health);
+
+  int amountOfConnectedWeapons = 0;
+  for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
+    if (!world->bossBall.weapons[i].isDisconnected) {
+      amountOfConnectedWeapons += 1;
+    }
+  }
+
+  if (amountOfConnectedWeapons > supposedAmountOfConnectedWeapons) {
+    tryDisconnectingWeapon();
+  }
+}
+
+void updateBossBall(void) {
+  if (world->bossBall.health <= 0) {
+    pauseMusic(bossBallMusic);
+    world->playerStats.kills += 1;
+    world->gameState = GAME_BOSS_DEAD;
+
+    for (int i = 0; i < world->projectiles.pool.len; i++) {
+      world->projectiles.items[i].willBeDestroyed = true;
+      world->projectiles.items[i].destructionTimer = 0.02f;
+    }
+    return;
+  }
+
+  world->bossBall.weaponAngleOffset = damp(world->bossBall.weaponAngleOffset,
+                                           world->bossBall.weaponAngleTargetOffset,
+                                           0.1f);
+
+  disconnectWeaponBasedOhHealth();
+  disconnectAWeaponIfThePlayerIsTooCloseForTooLong();
+
+  bossBallUpdateWeapons();
+
+  bossBallRoll();
+  bossBallCheckCollisions(true);
+  bossBallCheckDisconnectedWeaponCollisions();
+
+  bossBallAttack();
+}
+
+void integrateParticles(int first, int last) {
+  const float ft = simulationFrameTime();
+  const float steps = frameSteps();
+
+  for (int i = first; i < last; i++) {
+    world->particles.items[i].lifetime -= ft;
+    world->particles.items[i].position = Vector2Add(world->particles.items[i].position, Vector2Scale(world->particles.items[i].delta, steps));
+
+    if (world->particles.items[i].lifetime <= 0.0f) {
+      killEntity(&world->particles, i);
+    }
+  }
+}
+
+/* small work-stealing job system, the main thread is always worker 0 */
+typedef void (*JobFunction)(int first, int last, void *data);
+
+#define JOBS_MAX 64
+#define JOB_MAX_DEPENDENTS 16
+#define JOB_WORKERS_MAX 8
+
+typedef struct {
+  JobFunction function;
+  void *data;
+  int first;
+  int last;
+  World *world;
+
+  /* NOTE: for jobs that play sounds or change the game state */
+  bool mainThreadOnly;
+
+  atomic_int pendingDependencies;
+  int dependents[JOB_MAX_DEPENDENTS];
+  int dependentsLen;
+} Job;
+
+/* NOTE: every job is pushed at most once per run, so the queues never wrap around */
+typedef struct {
+  int items[JOBS_MAX];
+  int top;
+  int bottom;
+#if !defined(JOBS_SINGLE_THREADED)
+  pthread_mutex_t lock;
+#endif
+} JobQueue;
+
+typedef struct {
+  Job jobs[JOBS_MAX];
+  int len;
+  atomic_int unfinished;
+
+  JobQueue queues[JOB_WORKERS_MAX];
+  JobQueue mainQueue;
+  int workersLen;
+
+#if !defined(JOBS_SINGLE_THREADED)
+  pthread_t threads[JOB_WORKERS_MAX];
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  int generation;
+  bool quit;
+  atomic_int busyWorkers;
+#endif
+} JobSystem;
+
+static JobSystem jobSystem = {0};
+
+#if defined(JOBS_SINGLE_THREADED)
+#define JOB_QUEUE_LOCK(q)
+#define JOB_QUEUE_UNLOCK(q)
+#else
+#define JOB_QUEUE_LOCK(q) pthread_mutex_lock(&(q)->lock)
+#define JOB_QUEUE_UNLOCK(q) pthread_mutex_unlock(&(q)->lock)
+#endif
+
+void jobQueuePush(JobQueue *q, int job) {
+  JOB_QUEUE_LOCK(q);
+  q->items[q->bottom++] = job;
+  JOB_QUEUE_UNLOCK(q);
+}
+
+/* the owner works on its newest jobs first... */
+int jobQueuePop(JobQueue *q) {
+  int job = -1;
+
+  JOB_QUEUE_LOCK(q);
+  if (q->bottom > q->top) {
+    job = q->items[--q->bottom];
+  }
+  JOB_QUEUE_UNLOCK(q);
+
+  return job;
+}
+
+/* ...while the others steal the oldest ones */
+int jobQueueSteal(JobQueue *q) {
+  int job = -1;
+
+  JOB_QUEUE_LOCK(q);
+  if (q->bottom > q->top) {
+    job = q->items[q->top++];
+  }
+  JOB_QUEUE_UNLOCK(q);
+
+  return job;
+}
+
+void resetJobs(void) {
+  jobSystem.len = 0;
+}
+
+int addJob(JobFunction function, int first, int last, void *data) {
+  assert(jobSystem.len < JOBS_MAX);
+
+  int id = jobSystem.len++;
+  Job *job = &jobSystem.jobs[id];
+
+  job->function = function;
+  job->data = data;
+  job->first = first;
+  job->last = last;
+  job->world = world;
+  job->mainThreadOnly = false;
+  job->dependentsLen = 0;
+  atomic_store(&job->pendingDependencies, 0);
+
+  return id;
+}
+
+int addMainThreadJob(JobFunction function, int first, int last, void *data) {
+  int id = addJob(function, first, last, data);
+  jobSystem.jobs[id].mainThreadOnly = true;
+
+  return id;
+}
+
+void addJobDependency(int job, int dependsOn) {
+  Job *parent = &jobSystem.jobs[dependsOn];
+
+  assert(parent->dependentsLen < JOB_MAX_DEPENDENTS);
+
+  parent->dependents[parent->dependentsLen++] = job;
+  atomic_fetch_add(&jobSystem.jobs[job].pendingDependencies, 1);
+}
+
+void scheduleJob(int worker, int job) {
+  if (jobSystem.jobs[job].mainThreadOnly) {
+    jobQueuePush(&jobSystem.mainQueue, job);
+  } else {
+    jobQueuePush(&jobSystem.queues[worker], job);
+  }
+}
+
+void executeJob(int worker, int j) {
+  Job *job = &jobSystem.jobs[j];
+
+  World *previous = world;
+  world = job->world;
+
+  size_t scratch = scratchBegin();
+  job->function(job->first, job->last, job->data);
+  scratchEnd(scratch);
+
+  world = previous;
+
+  for (int i = 0; i < job->dependentsLen; i++) {
+    int d = job->dependents[i];
+
+    if (atomic_fetch_sub(&jobSystem.jobs[d].pendingDependencies, 1) == 1) {
+      scheduleJob(worker, d);
+    }
+  }
+
+  atomic_fetch_sub(&jobSystem.unfinished, 1);
+}
+
+int findJob(int worker) {
+  int job = -1;
+
+  if (worker == 0) {
+    job = jobQueuePop(&jobSystem.mainQueue);
+
+    if (job >= 0) {
+      return job;
+    }
+  }
+
+  job = jobQueuePop(&jobSystem.queues[worker]);
+
+  if (job >= 0) {
+    return job;
+  }
+
+  for (int k = 1; k < jobSystem.workersLen; k++) {
+    job = jobQueueSteal(&jobSystem.queues[(worker + k) % jobSystem.workersLen]);
+
+    if (job >= 0) {
+      return job;
+    }
+  }
+
+  return -1;
+}
+
+void workUntilDone(int worker) {
+  while (atomic_load(&jobSystem.unfinished) > 0) {
+    int job = findJob(worker);
+
+    if (job < 0) {
+#if !defined(JOBS_SINGLE_THREADED)
+      sched_yield();
+#endif
+      continue;
+    }
+
+    executeJob(worker, job);
+  }
+}
+
+#if !defined(JOBS_SINGLE_THREADED)
+void *jobWorker(void *arg) {
+  int worker = (int)(intptr_t)arg;
+  int seen = 0;
+
+  for (;;) {
+    pthread_mutex_lock(&jobSystem.lock);
+    while (jobSystem.generation == seen && !jobSystem.quit) {
+      pthread_cond_wait(&jobSystem.wake, &jobSystem.lock);
+    }
+    seen = jobSystem.generation;
+    bool quit = jobSystem.quit;
+    pthread_mutex_unlock(&jobSystem.lock);
+
+    if (quit) {
+      break;
+    }
+
+    workUntilDone(worker);
+    atomic_fetch_sub(&jobSystem.busyWorkers, 1);
+  }
+
+  freeFrameArena();
+  return NULL;
+}
+#endif
+
+/* runs every added job and returns once all of them are done */
+void runJobs(void) {
+  for (int w = 0; w < jobSystem.workersLen; w++) {
+    jobSystem.queues[w].top = 0;
+    jobSystem.queues[w].bottom = 0;
+  }
+
+  jobSystem.mainQueue.top = 0;
+  jobSystem.mainQueue.bottom = 0;
+
+  atomic_store(&jobSystem.unfinished, jobSystem.len);
+
+  for (int j = 0; j < jobSystem.len; j++) {
+    if (atomic_load(&jobSystem.jobs[j].pendingDependencies) == 0) {
+      scheduleJob(0, j);
+    }
+  }
+
+#if !defined(JOBS_SINGLE_THREADED)
+  atomic_store(&jobSystem.busyWorkers, jobSystem.workersLen - 1);
+
+  pthread_mutex_lock(&jobSystem.lock);
+  jobSystem.generation += 1;
+  pthread_cond_broadcast(&jobSystem.wake);
+  pthread_mutex_unlock(&jobSystem.lock);
+#endif
+
+  workUntilDone(0);
+
+#if !defined(JOBS_SINGLE_THREADED)
+  /* NOTE: no worker touches the queues once this returns */
+  while (atomic_load(&jobSystem.busyWorkers) > 0) {
+    sched_yield();
+  }
+#endif
+}
+
+int hardwareThreads(void) {
+#if defined(JOBS_SINGLE_THREADED)
+  return 1;
+#elif defined(_WIN32)
+  return pthread_num_processors_np();
+#else
+  return (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+}
+
+void initJobs(void) {
+  jobSystem.workersLen = MAX(1, MIN(hardwareThreads(), JOB_WORKERS_MAX));
+
+#if !defined(JOBS_SINGLE_THREADED)
+  for (int w = 0; w < jobSystem.workersLen; w++) {
+    pthread_mutex_init(&jobSystem.queues[w].lock, NULL);
+  }
+
+  pthread_mutex_init(&jobSystem.mainQueue.lock, NULL);
+  pthread_mutex_init(&jobSystem.lock, NULL);
+  pthread_cond_init(&jobSystem.wake, NULL);
+
+  for (int w = 1; w < jobSystem.workersLen; w++) {
+    if (pthread_create(&jobSystem.threads[w], NULL, jobWorker, (void *)(intptr_t)w) != 0) {
+      /* NOTE: the remaining work just ends up on fewer threads */
+      jobSystem.workersLen = w;
+      break;
+    }
+  }
+#endif
+
+  LOG("JOBS: %d worker(s)\n", jobSystem.workersLen);
+}
+
+void closeJobs(void) {
+#if !defined(JOBS_SINGLE_THREADED)
+  pthread_mutex_lock(&jobSystem.lock);
+  jobSystem.quit = true;
+  pthread_cond_broadcast(&jobSystem.wake);
+  pthread_mutex_unlock(&jobSystem.lock);
+
+  for (int w = 1; w < jobSystem.workersLen; w++) {
+    pthread_join(jobSystem.threads[w], NULL);
+  }
+#endif
+}
+
+
+void updatePlayerDashTrailsJob(int first, int last, void *data) {
+  updatePlayerDashTrails();
+}
+
+void integrateParticlesJob(int first, int last, void *data) {
+  integrateParticles(first, last);
+}
+
+void ageProjectilesJob(int first, int last, void *data) {
+  ageProjectiles(first, last);
+}
+
+void buildProjectileCollisionWorldJob(int first, int last, void *data) {
+  buildProjectileCollisionWorld();
+}
+
+void detectProjectileCollisionsJob(int first, int last, void *data) {
+  CollisionEvents *events = data;
+
+  events->len = 0;
+  detectProjectileCollisions(first, last, events);
+}
+
+void resolveProjectileCollisionsJob(int first, int last, void *data) {
+  /* NOTE: chunks are resolved in order, so the outcome is the same as the serial update */
+  for (int c = first; c < last; c++) {
+    resolveCollisionEvents(&world->projectileChunkEvents[c]);
+  }
+}
+
+void moveProjectilesJob(int first, int last, void *data) {
+  moveProjectiles(first, last);
+}
+
+void updateAsteroidsJob(int first, int last, void *data) {
+  updateAsteroids();
+}
+
+/* particles, projectiles and asteroids for one tick, spread over the job system */
+void updateSimulationJobs(void) {
+  /* NOTE: batch worlds already run one per worker, so they update serially */
+  if (world->headless) {
+    updatePlayerDashTrails();
+    integrateParticles(0, world->particles.pool.len);
+    updateProjectiles();
+    updateAsteroids();
+    compactEntities(&world->dashTrails);
+    compactEntities(&world->particles);
+    return;
+  }
+
+  resetJobs();
+
+  addJob(updatePlayerDashTrailsJob, 0, 0, NULL);
+
+  /* NOTE: nothing spawns while the jobs run, so the chunks split what is alive at the start of the tick */
+  int len = world->particles.pool.len;
+  int chunk = (len + PARTICLE_JOB_CHUNKS - 1) / PARTICLE_JOB_CHUNKS;
+  for (int c = 0; c < PARTICLE_JOB_CHUNKS; c++) {
+    addJob(integrateParticlesJob, MIN(c * chunk, len), MIN((c + 1) * chunk, len), NULL);
+  }
+
+  int build = addJob(buildProjectileCollisionWorldJob, 0, 0, NULL);
+  int resolve = addMainThreadJob(resolveProjectileCollisionsJob, 0, PROJECTILE_JOB_CHUNKS, NULL);
+
+  len = world->projectiles.pool.len;
+  chunk = (len + PROJECTILE_JOB_CHUNKS - 1) / PROJECTILE_JOB_CHUNKS;
+  for (int c = 0; c < PROJECTILE_JOB_CHUNKS; c++) {
+    int first = MIN(c * chunk, len);
+    int last = MIN((c + 1) * chunk, len);
+
+    int age = addJob(ageProjectilesJob, first, last, NULL);
+    int detect = addJob(detectProjectileCollisionsJob, first, last, &world->projectileChunkEvents[c]);
+    int move = addJob(moveProjectilesJob, first, last, NULL);
+
+    addJobDependency(build, age);
+    addJobDependency(detect, build);
+    addJobDependency(resolve, detect);
+    addJobDependency(move, resolve);
+  }
+
+  /* NOTE: asteroids rebuild the collision world, so they wait for the narrowphase to be done with it */
+  int asteroidsJob = addJob(updateAsteroidsJob, 0, 0, NULL);
+  addJobDependency(asteroidsJob, resolve);
+
+  runJobs();
+
+  compactEntities(&world->dashTrails);
+  compactEntities(&world->particles);
+  compactEntities(&world->projectiles);
+}
+
+#define AUTOPILOT_DISTANCE 450.0f
+#define AUTOPILOT_DISTANCE_SLACK 100.0f
+#define AUTOPILOT_LOOKAHEAD 30.0f
+#define AUTOPILOT_DANGER_MARGIN 24.0f
+#define AUTOPILOT_DASH_FRAMES 6.0f
+#define AUTOPILOT_BORDER 150.0f
+
+/* NOTE: steering towards `away` gets stronger the sooner the danger arrives */
+Vector2 autopilotAvoid(Vector2 steering, Vector2 away, float frames) {
+  float urgency = 0.5f + (3.0f * (1.0f - (frames / AUTOPILOT_LOOKAHEAD)));
+  return Vector2Add(steering, Vector2Scale(away, urgency));
+}
+
+PlayerInput autopilotInput(void) {
+  PlayerInput input = {0};
+
+  Vector2 bossPosition = Vector2Zero();
+
+  switch (world->currentBoss) {
+  case BOSS_MARINE: bossPosition = world->bossMarine.position; break;
+  case BOSS_BALL: bossPosition = world->bossBall.position; break;
+  }
+
+  Vector2 towards = Vector2Normalize(Vector2Subtract(bossPosition, world->player.position));
+  float distance = Vector2Distance(bossPosition, world->player.position);
+
+  /* NOTE: stay in shooting range, circling around the boss */
+  Vector2 steering = Vector2Scale((Vector2) {-towards.y, towards.x}, 0.5f);
+
+  if (distance < AUTOPILOT_DISTANCE - AUTOPILOT_DISTANCE_SLACK) {
+    steering = Vector2Negate(towards);
+  } else if (distance > AUTOPILOT_DISTANCE + AUTOPILOT_DISTANCE_SLACK) {
+    steering = towards;
+  }
+
+  float soonestHit = AUTOPILOT_LOOKAHEAD;
+
+  for (int i = 0; i < world->projectiles.pool.len; i++) {
+    if (world->projectiles.items[i].willBeDestroyed ||
+        (world->projectiles.items[i].hurts & COLLISION_LAYER_PLAYER) == 0) {
+      continue;
+    }
+
+    float radius = world->projectiles.items[i].radius;
+
+    if (world->projectiles.items[i].type == PROJECTILE_SQUARED) {
+      radius = Vector2Length(world->projectiles.items[i].size) / 2.0f;
+    }
+
+    /* NOTE: the closest the projectile gets to a standing player within the lookahead */
+    Vector2 relative = Vector2Subtract(world->projectiles.items[i].origin, world->player.position);
+    Vector2 velocity = world->projectiles.items[i].delta;
+    float speedSqr = Vector2LengthSqr(velocity);
+    float frames = 0.0f;
+
+    if (speedSqr > 0.0f) {
+      frames = Clamp(-Vector2DotProduct(relative, velocity) / speedSqr, 0.0f, AUTOPILOT_LOOKAHEAD);
+    }
+
+    Vector2 closest = Vector2Add(relative, Vector2Scale(velocity, frames));
+    float danger = radius + PLAYER_HITBOX_RADIUS + AUTOPILOT_DANGER_MARGIN;
+
+    if (Vector2LengthSqr(closest) > (danger * danger)) {
+      continue;
+    }
+
+    Vector2 away = Vector2Normalize(Vector2Negate(closest));
+
+    if (away.x == 0.0f && away.y == 0.0f) {
+      away = Vector2Normalize((Vector2) {-velocity.y, velocity.x});
+    }
+
+    steering = autopilotAvoid(steering, away, frames);
+    soonestHit = MIN(soonestHit, frames);
+  }
+
+  if (world->currentBoss == BOSS_BALL) {
+    for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
+      if (world->bossBall.weapons[i].type != BOSS_BALL_WEAPON_LASER ||
+          world->bossBall.weapons[i].chargeLevel <= 0.0f) {
+        continue;
+      }
+
+      /* NOTE: a charging laser is avoided along its whole reach, it is about to fire there */
+      float length = world->bossBall.weapons[i].chargeLevel >= 1.0f ? world->bossBall.weapons[i].laserLength : LASER_WIDTH;
+      Vector2 start = laserOrigin(i);
+      Vector2 direction = laserDirection(i);
+      Vector2 end = Vector2Add(start, Vector2Scale(direction, length));
+      float danger = (LASER_HEIGHT / 2.0f) + PLAYER_HITBOX_RADIUS + AUTOPILOT_DANGER_MARGIN;
+
+      if (segmentPointDistanceSqr(start, end, world->player.position) > (danger * danger)) {
+        continue;
+      }
+
+      Vector2 side = {-direction.y, direction.x};
+
+      if (Vector2DotProduct(side, Vector2Subtract(world->player.position, start)) < 0.0f) {
+        side = Vector2Negate(side);
+      }
+
+      float frames = world->bossBall.weapons[i].chargeLevel >= 1.0f ? 0.0f : AUTOPILOT_LOOKAHEAD / 2.0f;
+      steering = autopilotAvoid(steering, side, frames);
+      soonestHit = MIN(soonestHit, frames);
+    }
+  }
+
+  /* NOTE: the walls are where you get cornered */
+  if (world->player.position.x < AUTOPILOT_BORDER) steering.x += 1.0f;
+  if (world->player.position.x > LEVEL_WIDTH - AUTOPILOT_BORDER) steering.x -= 1.0f;
+  if (world->player.position.y < AUTOPILOT_BORDER) steering.y += 1.0f;
+  if (world->player.position.y > LEVEL_HEIGHT - AUTOPILOT_BORDER) steering.y -= 1.0f;
+
+  /* NOTE: sin(22.5) splits the steering into the eight directions the keys can do */
+  steering = Vector2Normalize(steering);
+
+  if (steering.y < -0.38f) input.movement |= DIRECTION_UP;
+  if (steering.y > 0.38f) input.movement |= DIRECTION_DOWN;
+  if (steering.x < -0.38f) input.movement |= DIRECTION_LEFT;
+  if (steering.x > 0.38f) input.movement |= DIRECTION_RIGHT;
+
+  input.aim = bossPosition;
+  input.fire = true;
+  input.dash = soonestHit < AUTOPILOT_DASH_FRAMES && input.movement != 0;
+
+  return input;
+}
+
+typedef struct {
+  int loop;
+  double startTime;
+  double startSimulationTime;
+  float worstFrameTime;
+  int bossesDefeated;
+} AutopilotReport;
+
+static AutopilotReport autopilotReport = {0};
+
+/* in bytes, 0 where the platform does not tell */
+size_t residentMemory(void) {
+#if defined(__linux__)
+  FILE *statm = fopen("/proc/self/statm", "r");
+
+  if (statm == NULL) {
+    return 0;
+  }
+
+  size_t pages = 0;
+  size_t residentPages = 0;
+
+  if (fscanf(statm, "%zu %zu", &pages, &residentPages) != 2) {
+    residentPages = 0;
+  }
+
+  fclose(statm);
+
+  return residentPages * (size_t)sysconf(_SC_PAGESIZE);
+#else
+  return 0;
+#endif
+}
+
+void autopilotFinishLoop(void) {
+  if (autopilotReport.loop > 0) {
+    LOG("AUTOPILOT: loop %d took %.2fs (%.1fs simulated), worst frame %.1fms, %d boss(es) defeated, %zu KiB resident\n",
+        autopilotReport.loop,
+        GetTime() - autopilotReport.startTime,
+        simulationTime() - autopilotReport.startSimulationTime,
+        autopilotReport.worstFrameTime * 1000.0f,
+        autopilotReport.bossesDefeated,
+        residentMemory() / 1024);
+  }
+
+  autopilotReport = (AutopilotReport) {
+    .loop = autopilotReport.loop + 1,
+    .startTime = GetTime(),
+    .startSimulationTime = simulationTime(),
+    .worstFrameTime = 0.0f,
+    .bossesDefeated = 0,
+  };
+}
+
+/* NOTE: clicks through the menus the same way a player would */
+void updateAutopilot(void) {
+  autopilotReport.worstFrameTime = MAX(autopilotReport.worstFrameTime, GetFrameTime());
+
+  if (world->gameState == GAME_MAIN_MENU) {
+    autopilotFinishLoop();
+    world->gameState = GAME_TUTORIAL;
+  }
+}
+
+/* runs `update` for every simulation tick of this frame, stops once the game leaves `state` */
+void simulateTicks(void (*update)(void), GameState state) {
+  for (int tick = 0; tick < world->simulationClock.scale; tick++) {
+    if (tick > 0) {
+      advanceSimulationClock();
+    }
+
+    update();
+
+    if (world->gameState != state) {
+      break;
+    }
+  }
+}
+
+void swapShips(void) {
+  Player ship = world->player;
+  world->player = world->wingman;
+  world->wingman = ship;
+
+  PlayerInput input = world->playerInput;
+  world->playerInput = world->wingmanInput;
+  world->wingmanInput = input;
+
+  Vector2 looking = world->lookingDirection;
+  world->lookingDirection = world->wingmanLookingDirection;
+  world->wingmanLookingDirection = looking;
+}
+
+void aimShip(void) {
+  world->lookingDirection = Vector2Normalize(Vector2Subtract(world->playerInput.aim, world->player.position));
+}
+
+void simulateWingman(void) {
+  swapShips();
+  aimShip();
+
+  updatePlayerPosition();
+  updatePlayerCooldowns();
+
+  tryDashing();
+  tryFiringAShot();
+
+  swapShips();
+}
+
+void simulateFight(void) {
+  /* NOTE: seeking, rollback and batches run many ticks per frame, none of them keep a tick's scratch */
+  size_t scratch = scratchBegin();
+
+  updateSimulationJobs();
+
+  if (world->coop) {
+    aimShip();
+  }
+
+  updatePlayerPosition();
+  updatePlayerCooldowns();
+
+  switch (world->currentBoss) {
+  case BOSS_MARINE: updateBossMarine(); break;
+  case BOSS_BALL: updateBossBall(); break;
+  }
+
+  tryDashing();
+  tryFiringAShot();
+
+  if (world->coop) {
+    simulateWingman();
+  }
+
+  world->playerStats.time += simulationFrameTime();
+  world->playerStats.bossTime += simulationFrameTime();
+
+  scratchEnd(scratch);
+}
+
+/* NOTE: a replay is the input and length of every tick, plus keyframes of the world to seek from */
+#define REPLAY_KEYFRAME_INTERVAL 120
+/* NOTE: every this many keyframes one is stored whole, so that seeking never decodes a longer chain */
+#define REPLAY_FULL_KEYFRAME_INTERVAL 16
+
+typedef struct {
+  /* NOTE: the aim holds where the cursor was, the ship turns towards it */
+  PlayerInput input;
+  float tick;
+} ReplayTick;
+
+typedef struct {
+  uint8_t *data;
+  int size;
+} ReplayKeyframe;
+
+typedef struct {
+  ReplayTick *ticks;
+  int len;
+  int capacity;
+
+  ReplayKeyframe *keyframes;
+  int keyframesLen;
+  int keyframesCapacity;
+
+  /* NOTE: the last keyframe in full, what the next one is delta-compressed against */
+  World *lastKeyframe;
+  World *scratch;
+  uint8_t *encodeBuffer;
+  size_t keyframeBytes;
+
+  /* the tick the world is at, ticks before `len` are played back instead of read from the devices */
+  int cursor;
+} Replay;
+
+static Replay replay = {0};
+
+void stopReplay(void) {
+  for (int i = 0; i < replay.keyframesLen; i++) {
+    free(replay.keyframes[i].data);
+  }
+
+  free(replay.ticks);
+  free(replay.keyframes);
+  free(replay.lastKeyframe);
+  free(replay.scratch);
+  free(replay.encodeBuffer);
+
+  memset(&replay, 0, sizeof(replay));
+}
+
+void startReplay(void) {
+  stopReplay();
+
+  replay.lastKeyframe = calloc(1, sizeof(World));
+  replay.scratch = malloc(sizeof(World));
+  /* NOTE: a literal run costs four bytes of header at most every four bytes of data */
+  replay.encodeBuffer = malloc(sizeof(World) * 2 + 16);
+}
+
+/* NOTE: xor against the previous keyframe, then runs of four or more zero bytes are squeezed out */
+int encodeKeyframe(const uint8_t *current, const uint8_t *previous, int size, uint8_t *out) {
+  int len = 0;
+  int i = 0;
+
+  while (i < size) {
+    int zeros = 0;
+    while (i + zeros < size && zeros < UINT16_MAX && current[i + zeros] == previous[i + zeros]) {
+      zeros++;
+    }
+
+    i += zeros;
+
+    int literals = 0;
+    while (i + literals < size && literals < UINT16_MAX) {
+      /* NOTE: a few equal bytes are cheaper to keep as literals than to give them a header of their own */
+      int same = 0;
+      while (same < 4 && i + literals + same < size &&
+             current[i + literals + same] == previous[i + literals + same]) {
+        same++;
+      }
+
+      if (same == 4) {
+        break;
+      }
+
+      literals += MAX(same, 1);
+    }
+
+    literals = MIN(literals, UINT16_MAX);
+
+    uint16_t header[2] = {zeros, literals};
+    memcpy(out + len, header, sizeof(header));
+    len += sizeof(header);
+
+    for (int b = 0; b < literals; b++) {
+      out[len++] = current[i + b] ^ previous[i + b];
+    }
+
+    i += literals;
+  }
+
+  return len;
+}
+
+void decodeKeyframe(const uint8_t *data, int len, uint8_t *bytes) {
+  int at = 0;
+  int i = 0;
+
+  while (at < len) {
+    uint16_t header[2];
+    memcpy(header, data + at, sizeof(header));
+    at += sizeof(header);
+
+    i += header[0];
+
+    for (int b = 0; b < header[1]; b++) {
+      bytes[i++] ^= data[at++];
+    }
+  }
+}
+
+void recordKeyframe(void) {
+  static const World empty = {0};
+
+  bool full = (replay.keyframesLen % REPLAY_FULL_KEYFRAME_INTERVAL) == 0;
+  const World *previous = full ? &empty : replay.lastKeyframe;
+
+  int size = encodeKeyframe((const uint8_t *)world, (const uint8_t *)previous, sizeof(World), replay.encodeBuffer);
+
+  if (replay.keyframesLen == replay.keyframesCapacity) {
+    replay.keyframesCapacity = MAX(16, replay.keyframesCapacity * 2);
+    replay.keyframes = realloc(replay.keyframes, replay.keyframesCapacity * sizeof(ReplayKeyframe));
+  }
+
+  ReplayKeyframe *keyframe = &replay.keyframes[replay.keyframesLen++];
+  keyframe->data = malloc(size);
+  keyframe->size = size;
+  memcpy(keyframe->data, replay.encodeBuffer, size);
+
+  replay.keyframeBytes += size;
+  memcpy(replay.lastKeyframe, world, sizeof(World));
+}
+
+void replayApply(const ReplayTick *tick) {
+  world->playerInput = tick->input;
+  world->mouseCursor = tick->input.aim;
+  world->lookingDirection = Vector2Normalize(Vector2Subtract(tick->input.aim, world->player.position));
+}
+
+/* records this tick's input, or swaps in the recorded one while a rewound world catches up */
+void replayTick(void) {
+  if (replay.lastKeyframe == NULL) {
+    return;
+  }
+
+  if (replay.cursor < replay.len) {
+    const ReplayTick *tick = &replay.ticks[replay.cursor++];
+
+    /* NOTE: the clock already moved by this frame's length, it has to move by the recorded one */
+    world->simulationClock.time += tick->tick - world->simulationClock.tick;
+    world->simulationClock.tick = tick->tick;
+
+    replayApply(tick);
+    return;
+  }
+
+  if ((replay.len % REPLAY_KEYFRAME_INTERVAL) == 0) {
+    recordKeyframe();
+  }
+
+  if (replay.len == replay.capacity) {
+    replay.capacity = MAX(1024, replay.capacity * 2);
+    replay.ticks = realloc(replay.ticks, replay.capacity * sizeof(ReplayTick));
+  }
+
+  PlayerInput input = world->playerInput;
+  input.aim = world->mouseCursor;
+
+  replay.ticks[replay.len++] = (ReplayTick) {
+    .input = input,
+    .tick = simulationFrameTime(),
+  };
+
+  replay.cursor = replay.len;
+}
+
+/* NOTE: restores the nearest keyframe and resimulates the rest, both bounded no matter how long the replay is */
+void replaySeek(int tick) {
+  if (replay.keyframesLen == 0) {
+    return;
+  }
+
+  tick = Clamp(tick, 0, replay.len);
+
+  int keyframe = MIN(tick / REPLAY_KEYFRAME_INTERVAL, replay.keyframesLen - 1);
+  int full = keyframe - (keyframe % REPLAY_FULL_KEYFRAME_INTERVAL);
+
+  memset(replay.scratch, 0, sizeof(World));
+
+  for (int k = full; k <= keyframe; k++) {
+    decodeKeyframe(replay.keyframes[k].data, replay.keyframes[k].size, (uint8_t *)replay.scratch);
+  }
+
+  /* NOTE: the keyframes hold the whole world, including how it's being run */
+  int scale = world->simulationClock.scale;
+  bool silent = world->silent;
+  bool headless = world->headless;
+  bool coop = world->coop;
+
+  memcpy(world, replay.scratch, sizeof(World));
+  world->simulationClock.scale = scale;
+  world->headless = headless;
+  world->coop = coop;
+
+  world->silent = true;
+
+  /* NOTE: keyframes are taken after the clock moved, so only the ticks after it move it again */
+  int first = keyframe * REPLAY_KEYFRAME_INTERVAL;
+
+  for (int t = first; t < tick; t++) {
+    if (t > first) {
+      world->simulationClock.tick = replay.ticks[t].tick;
+      world->simulationClock.time += world->simulationClock.tick;
+    }
+
+    replayApply(&replay.ticks[t]);
+    simulateFight();
+  }
+
+  world->silent = silent;
+  replay.cursor = tick;
+}
+
+float replayTime(int ticks) {
+  float time = 0.0f;
+
+  for (int t = 0; t < ticks; t++) {
+    time += replay.ticks[t].tick;
+  }
+
+  return time;
+}
+
+/* NOTE: while dragged, the world follows the tick under the mouse, true when it moved */
+/* NOTE: only during the fight, seeking back from a finished one would bring it back to life */
+bool updateReplayScrubBar(Rectangle bar) {
+  if (replay.len == 0 ||
+      world->gameState != GAME_BOSS ||
+      !IsMouseButtonDown(MOUSE_BUTTON_LEFT) ||
+      !CheckCollisionPointRec(previousMousePressLocation, bar)) {
+    return false;
+  }
+
+  float progress = Clamp((screenMouseLocation.x - bar.x) / bar.width, 0.0f, 1.0f);
+  int tick = (int)roundf(progress * replay.len);
+
+  if (tick == replay.cursor) {
+    return false;
+  }
+
+  replaySeek(tick);
+  return true;
+}
+
+void renderReplayScrubBar(Rectangle bar, float mul) {
+  if (replay.len == 0 || world->gameState != GAME_BOSS) {
+    return;
+  }
+
+  DrawRectangleRec(bar, ColorAlpha(WHITE, 0.3f));
+
+  float progress = (float)replay.cursor / (float)replay.len;
+
+  DrawRectangleRec((Rectangle) {bar.x, bar.y, bar.width * progress, bar.height},
+                   WHITE);
+
+  for (int k = 0; k < replay.keyframesLen; k++) {
+    float x = bar.x + bar.width * ((float)(k * REPLAY_KEYFRAME_INTERVAL) / (float)replay.len);
+    DrawRectangleRec((Rectangle) {x, bar.y + bar.height, mul, bar.height / 2},
+                     LIGHTGRAY);
+  }
+
+  Font f = GetFontDefault();
+  float fontSize = 10 * mul;
+  float spacing = 1 * mul;
+
+  const char *text = frameFormat("%.1fs / %.1fs", replayTime(replay.cursor), replayTime(replay.len));
+  Vector2 size = MeasureTextEx(f, text, fontSize, spacing);
+
+  DrawTextPro(f,
+              text,
+              (Vector2) {bar.x + bar.width / 2, bar.y - size.y},
+              Vector2Scale(size, 0.5f),
+              0,
+              fontSize,
+              spacing,
+              WHITE);
+}
+
+void updateBossFight(void) {
+  if (world->player.health == 0) {
+    world->gameState = GAME_PLAYER_DEAD;
+
+    PauseMusicStream(bossMarineMusic);
+    PauseMusicStream(bossBallMusic);
+    PlaySound(playerDeathSound);
+    return;
+  }
+
+  updateCamera();
+  updateThrusterTrails();
+  updateBackgroundAsteroid();
+
+  world->playerInput = autopilot ? autopilotInput() : readPlayerInput();
+  updateMouse();
+  replayTick();
+
+  simulateFight();
+}
+
+void updateFightMusic(void) {
+  switch (world->currentBoss) {
+  case BOSS_MARINE: {
+    ResumeMusicStream(bossMarineMusic);
+
+    if (!IsMusicStreamPlaying(bossMarineMusic)) {
+      PlayMusicStream(bossMarineMusic);
+    }
+
+    UpdateMusicStream(bossMarineMusic);
+  } break;
+  case BOSS_BALL: {
+    ResumeMusicStream(bossBallMusic);
+
+    if (!IsMusicStreamPlaying(bossBallMusic)) {
+      PlayMusicStream(bossBallMusic);
+    }
+
+    UpdateMusicStream(bossBallMusic);
+  } break;
+  }
+}
+
+void updateAndRenderBossFight(void) {
+  if (IsKeyPressed(KEY_ESCAPE)) {
+    PlaySound(beep);
+    isGamePaused = !isGamePaused;
+  }
+
+  if (isGamePaused) {
+    PauseMusicStream(bossMarineMusic);
+    PauseMusicStream(bossBallMusic);
+    updateAndRenderPauseScreen();
+    return;
+  }
+
+  updateFightMusic();
+
+  simulateTicks(updateBossFight, GAME_BOSS);
+
+  if (world->gameState != GAME_BOSS) {
+    return;
+  }
+
+  renderPhase1();
+  renderFinal();
+}
+
+void renderGameTitle(void) {
+  float mul = camera.zoom * 2;
+
+  Font f = GetFontDefault();
+  char *text = "STRIBUN";
+  float fontSize = 50 * mul;
+  float spacing = 4 * mul;
+  Vector2 size = MeasureTextEx(f, text, fontSize, spacing);
+
+  Vector2 pos = (Vector2) {
+    .x = (float)GetScreenWidth() / 2,
+    .y = (float)GetScreenHeight() / 6,
+  };
+
+  DrawTextPro(f,
+              text,
+              Vector2Add(pos, (Vector2) {spacing, spacing}),
+              Vector2Scale(size, 0.5f),
+              0,
+              fontSize,
+              spacing,
+              BLACK);
+
+  DrawTextPro(f,
+              text,
+              pos,
+              Vector2Scale(size, 0.5f),
+              0,
+              fontSize,
+              spacing,
+              WHITE);
+}
+
+void renderPhase0(void) {
+  preRenderBackground(true);
+  updateWorldView();
+
+  if (directRendering) {
+    return;
+  }
+
+  BeginTextureMode(target); {
+    ClearBackground(BLACK);
+
+    targetDrawnSize = worldTargetSize();
+    rlViewport(0, 0, (int)targetDrawnSize.x, (int)targetDrawnSize.y);
+
+    renderBackground();
+  } EndTextureMode();
+}
+
+static float floatingShipRotation = 0;
+static float floatingShipRotationDelta = 360.0f / 30.0f;
+
+void updateFloatingShip(void) {
+  float halfWidth = (float)GetScreenWidth() / 2;
+
+  float scale = 1;
+  if (screenMouseLocation.x > halfWidth) {
+    scale = (screenMouseLocation.x - halfWidth) / halfWidth;
+  } else {
+    scale = (halfWidth - screenMouseLocation.x) / halfWidth;
+    scale *= -1;
+  }
+
+  floatingShipRotation += floatingShipRotationDelta * scale;
+}
+
+void renderFloatingShip(void) {
+  float y = (float)GetScreenHeight() / 2;
+  float x = (float)GetScreenWidth() / 4;
+
+  float scale = camera.zoom * 30;
+
+  float width = playerRect.width * scale;
+  float height = playerRect.height * scale;
+
+  DrawTexturePro(sprites,
+                 playerRect,
+                 (Rectangle) {x, y, width, height},
+                 (Vector2) {width / 2, height / 2},
+                 floatingShipRotation,
+                 WHITE);
+}
+
+void renderGameVersion(void) {
+  char *text = GAME_VERSION;
+
+  float mul = camera.zoom * 2;
+
+  Font f = GetFontDefault();
+  float fontSize = 10 * mul;
+  float spacing = 1 * mul;
+  /* Vector2 size = MeasureTextEx(f, text, fontSize, spacing); */
+
+  Vector2 pos = (Vector2) {
+    .x = (float)10,
+    .y = (float)10,
+  };
+
+  DrawTextPro(f,
+              text,
+              Vector2Add(pos, (Vector2) {spacing, spacing}),
+              Vector2Zero(),
+              0,
+              fontSize,
+              spacing,
+              BLACK);
+
+  DrawTextPro(f,
+              text,
+              pos,
+              Vector2Zero(),
+              0,
+              fontSize,
+              spacing,
+              WHITE);
+
+}
+
+void renderMusicAuthor(void) {
+  char* text = "Music: Drozerix - Stardust Jam";
+
+  float mul = camera.zoom * 2;
+
+  Font f = GetFontDefault();
+  float fontSize = 10 * mul;
+  float spacing = 1 * mul;
+  Vector2 size = MeasureTextEx(f, text, fontSize, spacing);
+
+  Vector2 pos = (Vector2) {
+    .x = (float)10,
+    .y = (float)GetScreenHeight() - size.y - 10,
+  };
+
+  float alpha = sin(GetTime()) * cos(GetTime()) + 0.5f;
+
+  DrawTextPro(f,
+              text,
+              Vector2Add(pos, (Vector2) {spacing, spacing}),
+              Vector2Zero(),
+              0,
+              fontSize,
+              spacing,
+              ColorAlpha(BLACK, alpha));
+
+  DrawTextPro(f,
+              text,
+              pos,
+              Vector2Zero(),
+              0,
+              fontSize,
+              spacing,
+              ColorAlpha(WHITE, alpha));
+}
+
+typedef enum {
+  BUTTON_ACTION_START,
+  BUTTON_ACTION_TOGGLE_CONTROLS,
+#ifdef PLATFORM_DESKTOP
+  BUTTON_ACTION_QUIT,
+#endif
+  BUTTON_ACTION_COUNT,
+} ButtonAction;
+
+typedef struct {
+  ButtonAction action;
+  Rectangle rect;
+} Button;
+
+static Button mainMenuButtons[BUTTON_ACTION_COUNT] = {0};
+static Vector2 mousePressLocation = {0};
+static Vector2 prevMouseLocation = {0};
+
+void updateButtons(void) {
+  float x = (float)GetScreenWidth() - (float)GetScreenWidth() / 4;
+  float width = (float)GetScreenWidth() / 4.5;
+  float height = (float)GetScreenHeight() / 8;
+  float y = (float)GetScreenHeight() / 3 + (height);
+
+#ifdef PLATFORM_WEB
+  y += height;
+#endif
+
+  for (int i = 0; i < BUTTON_ACTION_COUNT; i++) {
+    mainMenuButtons[i].action = i;
+    mainMenuButtons[i].rect = (Rectangle) {
+      x, y, width, height,
+    };
+
+    if (!CheckCollisionPointRec(prevMouseLocation, mainMenuButtons[i].rect) &&
+        CheckCollisionPointRec(screenMouseLocation, mainMenuButtons[i].rect)) {
+      PlaySound(buttonFocusEffect);
+    }
+
+    if (IsMouseButtonReleased(MOUSE_BUTTON_LEFT) &&
+        CheckCollisionPointRec(mousePressLocation, mainMenuButtons[i].rect) &&
+        CheckCollisionPointRec(screenMouseLocation, mainMenuButtons[i].rect)) {
+      switch (i) {
+      case BUTTON_ACTION_START: {
+        PlaySound(beep);
+        world->gameState = GAME_TUTORIAL;
+      } return;
+      case BUTTON_ACTION_TOGGLE_CONTROLS: {
+        PlaySound(beep);
+        esdf = !esdf;
+      } break;
+#ifdef PLATFORM_DESKTOP
+      case BUTTON_ACTION_QUIT: exit(0);
+#endif
+      default: break;
+      }
+    }
+
+    y += height * 1.5;
+  }
+
+  if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+    mousePressLocation = screenMouseLocation;
+  }
+
+  prevMouseLocation = screenMouseLocation;
+}
+
+void renderButtons(void) {
+  float mul = camera.zoom * 2;
+  Font f = GetFontDefault();
+  float fontSize = 25 * mul;
+  float spacing = 2 * mul;
+
+  for (int i = 0; i < BUTTON_ACTION_COUNT; i++) {
+    if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) &&
+        CheckCollisionPointRec(mousePressLocation, mainMenuButtons[i].rect) &&
+        CheckCollisionPointRec(screenMouseLocation, mainMenuButtons[i].rect)) {
+      DrawRectangleRec(mainMenuButtons[i].rect,
+                       LIGHTGRAY);
+    } else {
+      DrawRectangleRec(mainMenuButtons[i].rect,
+                       WHITE);
+    }
+
+    if (CheckCollisionPointRec(screenMouseLocation, mainMenuButtons[i].rect)) {
+      DrawRectangleLinesEx(mainMenuButtons[i].rect,
+                           2 * mul,
+                           LIGHTGRAY);
+    }
+
+    char* text = "";
+
+    switch (mainMenuButtons[i].action) {
+    case BUTTON_ACTION_START: text = "START"; break;
+    case BUTTON_ACTION_TOGGLE_CONTROLS: text = esdf ? "ESDF" : "WASD"; break;
+#ifdef PLATFORM_DESKTOP
+    case BUTTON_ACTION_QUIT: text = "QUIT"; break;
+#endif
+    default: continue;
+    };
+
+    Vector2 size = MeasureTextEx(f, text, fontSize, spacing);
+
+    Vector2 pos = (Vector2) {
+      .x = (float)mainMenuButtons[i].rect.x + mainMenuButtons[i].rect.width / 2,
+      .y = (float)mainMenuButtons[i].rect.y + mainMenuButtons[i].rect.height / 2,
+    };
+
+    DrawTextPro(f,
+                text,
+                pos,
+                Vector2Scale(size, 0.5f),
+                0,
+                fontSize,
+                spacing,
+                BLACK);
+  }
+}
+
+void renderMainMenu(void) {
+  renderPhase0();
+
+  BeginDrawing(); {
+    ClearBackground(BLACK);
+
+    presentWorld(renderBackground);
+
+    renderFloatingShip();
+    renderGameTitle();
+    renderMusicAuthor();
+    renderGameVersion();
+    renderButtons();
+    renderMouseCursor();
+  } EndDrawing();
+}
+
+void updateMainMenuMusic(void) {
+  bool pauseMusic = false;
+
+#ifdef PLATFORM_DESKTOP
+
+  if (!IsWindowFocused() || IsWindowHidden()) {
+    pauseMusic = true;
+  }
+
+#endif
+
+  if (!IsCursorHidden()) {
+    pauseMusic = true;
+  }
+
+  if (pauseMusic) {
+    PauseMusicStream(mainMenuMusic);
+  } else {
+    ResumeMusicStream(mainMenuMusic);
+
+    if (!IsMusicStreamPlaying(mainMenuMusic)) {
+      PlayMusicStream(mainMenuMusic);
+    }
+  }
+
+  UpdateMusicStream(mainMenuMusic);
+}
+
+void updateAndRenderMainMenu(void) {
+  updateCamera();
+  updateMouse();
+  updateFloatingShip();
+  updateMainMenuMusic();
+  updateButtons();
+
+  renderMainMenu();
+}
+
+static float arenaLerp = 0;
+static Vector2 arenaLerpLocation = {0};
+
+static float bossInfoTimer = 0;
+
+static float introductionSkipTimer = 0;
+
+Vector2 introductionPlayerDestination(void) {
+  return (Vector2) {
+    .x = (float)LEVEL_WIDTH / 2,
+    .y = LEVEL_HEIGHT - ((float)LEVEL_HEIGHT / 6),
+  };
+}
+
+void startBossFight(void) {
+  world->gameState = GAME_BOSS;
+
+  switch (world->currentBoss) {
+  case BOSS_MARINE: {
+    world->bossMarine.attackTimer = 0.5f;
+    world->bossMarine.currentAttack = BOSS_MARINE_NOT_SHOOTING;
+  } break;
+  case BOSS_BALL: {
+  } break;
+  }
+}
+
+void updateAndRenderIntroduction(void) {
+  switch (world->currentBoss) {
+  case BOSS_MARINE: {
+    UpdateMusicStream(bossMarineMusic);
+  } break;
+  case BOSS_BALL: {
+    UpdateMusicStream(bossBallMusic);
+  } break;
+  }
+
+  introductionSkipTimer -= simulationFrameTime();
+
+  Vector2 playerDestination = introductionPlayerDestination();
+
+  if ((IsMouseButtonPressed(MOUSE_BUTTON_LEFT) || autopilot) && introductionSkipTimer <= 0.0f) {
+    arenaLerp = 1.0f;
+    isGamePaused = false;
+
+    world->player.position = playerDestination;
+    startBossFight();
+    startReplay();
+  }
+
+  switch (introductionStage) {
+  case BOSS_INTRODUCTION_BEGINNING: {
+    cameraIntroductionTarget = (Vector2) {
+      .x = (float)LEVEL_WIDTH / 2,
+      .y = LEVEL_HEIGHT - (((float)LEVEL_HEIGHT / 6) / 2),
+    };
+
+    world->player.position = dampVector2(world->player.position,
+                                         playerDestination,
+                                         0.05f);
+
+    if (Vector2Distance(world->player.position, playerDestination) < 10.0f) {
+      introductionStage = BOSS_INTRODUCTION_FOCUS;
+      arenaLerpLocation = world->player.position;
+      arenaLerp = 0;
+
+      PlaySound(borderActivation);
+      switch (world->currentBoss) {
+      case BOSS_MARINE: PlayMusicStream(bossMarineMusic); break;
+      case BOSS_BALL: PlayMusicStream(bossBallMusic); break;
+      }
+    }
+  } break;
+  case BOSS_INTRODUCTION_FOCUS: {
+    Vector2 bossPos = Vector2Zero();
+
+    switch (world->currentBoss) {
+    case BOSS_MARINE: bossPos = world->bossMarine.position; break;
+    case BOSS_BALL: bossPos = world->bossBall.position; break;
+    }
+
+    cameraIntroductionTarget = dampVector2(cameraIntroductionTarget,
+                                           bossPos,
+                                           0.1f);
+
+    arenaLerp = Clamp(arenaLerp + simulationFrameTime(), 0.0f, 1.0f);
+
+    if (Vector2Distance(cameraIntroductionTarget, bossPos) < 10.0f &&
+        arenaLerp == 1.0f) {
+      introductionStage = BOSS_INTRODUCTION_INFO;
+      bossInfoTimer = 2.0f;
+
+      bossInfoHeadPosition = (Vector2) {
+          .x = -(GetScreenWidth() / 3),
+          .y = (GetScreenHeight() / 2),
+      };
+      infoXBase = -roundf(GetScreenWidth() / 3);
+
+      switch (world->currentBoss) {
+      case BOSS_MARINE: PlaySound(bossMarineShotgunSound); break;
+      case BOSS_BALL: PlaySound(bossMarineShotgunSound); break;
+      }
+    }
+  } break;
+  case BOSS_INTRODUCTION_INFO: {
+    bossInfoTimer -= simulationFrameTime();
+
+    bossInfoHeadPosition =
+      dampVector2(bossInfoHeadPosition,
+                  (Vector2) {
+                    .x = (GetScreenWidth() / 3),
+                    .y = (GetScreenHeight() / 2),
+                  },
+                  0.1f);
+
+    infoXBase = damp(infoXBase, 0, 0.1f);
+
+    if (bossInfoTimer <= 0.0f) {
+      isGamePaused = false;
+      startBossFight();
+      startReplay();
+    }
+  } break;
+  }
+
+  arenaTopLeft = Vector2Lerp(arenaLerpLocation, Vector2Zero(),
+                             arenaLerp);
+  arenaBottomRight = Vector2Lerp(arenaLerpLocation, level,
+                                 arenaLerp);
+
+  updateCamera();
+
+  renderPhase1();
+  renderFinal();
+}
+
+void updateAndRenderTutorial(void) {
+  if (GetKeyPressed() != KEY_NULL ||
+      IsMouseButtonPressed(MOUSE_BUTTON_LEFT) ||
+      IsMouseButtonPressed(MOUSE_BUTTON_RIGHT) ||
+      seenTutorial ||
+      autopilot) {
+    PlaySound(beep);
+
+    seenTutorial = true;
+    introductionSkipTimer = 0.1f;
+    world->gameState = GAME_BOSS_INTRODUCTION;
+    introductionStage = BOSS_INTRODUCTION_BEGINNING;
+    world->lookingDirection = Vector2Zero();
     return;
   }
 
-  float distance = Vector2Distance(bossBall.targetPosition, bossBall.position);
+  updateMouse();
 
-  if (distance <= ((float)BOSS_BALL_MOVE_SPEED / 2.0f)) {
-    bool toMoveOrNotToMove = (bool)GetRandomValue(0, 1);
+  float mul = camera.zoom * 2;
+  Font f = GetFontDefault();
+  float fontSize = 25 * mul;
+  float spacing = 2 * mul;
 
-    if (toMoveOrNotToMove) {
-      bossBall.targetPosition.x = (float)GetRandomValue(BOSS_BALL_HITBOX_RADIUS, LEVEL_WIDTH - BOSS_BALL_HITBOX_RADIUS);
-      bossBall.targetPosition.y = (float)GetRandomValue(BOSS_BALL_HITBOX_RADIUS, LEVEL_HEIGHT - BOSS_BALL_HITBOX_RADIUS);
+  char *text[] = {
+    "W/A/S/D = MOVEMENT",
+    "LEFT MOUSE BUTTON = SHOOT",
+    "RIGHT MOUSE BUTTON = DASH",
+  };
 
-      bossBall.startingPosition = bossBall.position;
+  if (esdf) {
+    text[0] = "E/S/D/F = MOVEMENT";
+  }
 
-      Vector2 dir = Vector2Normalize(Vector2Subtract(bossBall.targetPosition, bossBall.startingPosition));
+  Vector2 pos = (Vector2) {
+    .x = (float)GetScreenWidth() / 2.0f,
+    .y = (float)GetScreenHeight() / 3.0f,
+  };
 
-      bossBall.standingStilTimer = 0;
-      bossBall.angle = 1;
-      bossBall.rotationAxis = (Vector3) {roundf(dir.y), 0, -roundf(dir.x)};
-    } else {
-      bossBall.standingStilTimer = (float)GetRandomValue(1, 10) / 10.0f;
-      bossBall.rotationAxis = Vector3Zero();
-      bossBall.angle = 0;
-      bossBall.targetPosition = bossBall.position;
-      bossBall.startingPosition = bossBall.position;
-    }
+  updateCamera();
+  BeginDrawing(); {
+    ClearBackground(BLACK);
 
-    if (GetRandomValue(1, 10) == 1) {
-      bossBall.weaponAngleTargetOffset = GetRandomValue(0, 360);
+    for (size_t i = 0; i < sizeof(text) / sizeof(text[0]); i++) {
+      Vector2 size = MeasureTextEx(f, text[i], fontSize, spacing);
 
-      for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
-        bossBall.weapons[i].attackTimer = 0;
-        bossBall.weapons[i].chargeLevel = 0;
-        bossBall.weapons[i].laserLength = 0;
-      }
+      DrawTextPro(f, text[i], pos, Vector2Scale(size, 0.5f), 0, fontSize, spacing, WHITE);
+      pos.y += size.y;
     }
-  } else {
-    Vector2 dir = Vector2Normalize(Vector2Subtract(bossBall.targetPosition, bossBall.startingPosition));
-    Vector2 delta = Vector2Scale(dir, BOSS_BALL_MOVE_SPEED);
-
-    bossBall.position = Vector2Add(bossBall.position, delta);
-
-    bossBall.position = Vector2Clamp(bossBall.position,
-                                     (Vector2) {
-                                       BOSS_BALL_HITBOX_RADIUS,
-                                       BOSS_BALL_HITBOX_RADIUS,
-                                     },
-                                     (Vector2) {
-                                       LEVEL_WIDTH - BOSS_BALL_HITBOX_RADIUS,
-                                       LEVEL_HEIGHT - BOSS_BALL_HITBOX_RADIUS,
-                                     });
 
-    float fullDistance = Vector2Distance(bossBall.targetPosition, bossBall.startingPosition);
-    float progress = Vector2Distance(bossBall.position, bossBall.startingPosition);
+    char *text1 = "PRESS ANY KEY IF UNDERSTOOD";
+    Vector2 size = MeasureTextEx(f, text1, fontSize, spacing);
+    pos.y += size.y;
 
-    float angle = (progress / fullDistance) * 360;
+    DrawTextPro(f, text1, pos, Vector2Scale(size, 0.5f), 0, fontSize, spacing, WHITE);
 
-    if (isnormal(angle)) {
-      bossBall.angle = angle;
-    }
-  }
+    renderMouseCursor();
+  } EndDrawing();
 }
 
-void bossBallShootProjectile(float speedMultiplier, float fireCooldown, Sound *sound, float lifetime, Color inside, Color outside, int i, float angle, Vector2 origin) {
-  if (bossBall.weapons[i].fireCooldown > 0.0f) {
-    return;
-  }
 
-  Projectile *new_projectile = push_projectile();
+void playerGiveOneRandomPerk(void) {
+  Perk allPerks = 0;
+#define X(v, m, n, rx, ry, rw, rh) allPerks |= v;
+  X_PERKS
+#undef X
 
-  if (new_projectile == NULL) {
+  if (world->playerPerks == allPerks) {
     return;
   }
 
-  *new_projectile = (Projectile) {
-    .type = PROJECTILE_REGULAR,
-    .isHurtfulForBoss = false,
-    .isHurtfulForPlayer = true,
-    .damage = 1,
-    .origin = Vector2Add(origin, bossBall.weapons[i].position),
-    .radius = 10,
-    .delta = Vector2Rotate((Vector2){0, -(25.0f * speedMultiplier)},
-                           angle * DEG2RAD),
-    .angle = 0,
-    .inside = inside,
-    .outside = outside,
-    .lifetime = lifetime,
-    .canBounce = false,
+#define X(v, m, n, rx, ry, rw, rh) v,
+  static Perk perks[] = {
+    X_PERKS
   };
+#undef X
 
-  bossBall.weapons[i].fireCooldown = fireCooldown;
+  int perks_len = sizeof(perks) / sizeof(perks[0]);
 
-  if (sound) {
-    PlaySound(*sound);
+  Perk newPerk = 0;
+  do {
+    int i = randomValue(0, perks_len - 1);
+    newPerk = perks[i];
+  } while (world->playerPerks & newPerk);
+
+  world->playerPerks |= newPerk;
+
+  if (world->firstNewPerk > 0) {
+    world->secondNewPerk = newPerk;
+  } else {
+    world->firstNewPerk = newPerk;
   }
 }
 
-void bossBallAttack(void) {
-  for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
-    Color red = {243, 83, 54, 255};
+void playerGiveTwoRandomPerks(void) {
+  world->firstNewPerk = 0;
+  world->secondNewPerk = 0;
 
-    bossBall.weapons[i].attackCooldown -= GetFrameTime();
+  playerGiveOneRandomPerk();
+  playerGiveOneRandomPerk();
+}
 
-    if (bossBall.weapons[i].attackCooldown > 0.0f) {
-      continue;
-    }
+void updateDeadMarine(void) {
+  if (Vector2Distance(camera.target, world->bossMarine.position) > 5) {
+    return;
+  }
 
-    if (bossBall.weapons[i].isDisconnected) {
-      bossBall.weapons[i].seesPlayer = true;
-    }
+  const Vector2 headshotWeaponOffset = {
+    .x = -45 * SPRITES_SCALE,
+    .y = -19 * SPRITES_SCALE,
+  };
 
-    bossBall.weapons[i].isDeactivated = false;
+  world->bossMarine.weaponOffset = dampVector2(world->bossMarine.weaponOffset,
+                                               headshotWeaponOffset,
+                                               0.1f);
 
-    bossBall.weapons[i].attackTimer -= GetFrameTime();
+  world->bossMarine.weaponAngle = damp(world->bossMarine.weaponAngle, 0, 0.1f);
 
-    if (bossBall.weapons[i].seesPlayer &&
-        bossBall.weapons[i].attackTimer <= 0.0f &&
-        bossBall.weapons[i].attackCooldown <= 0.0f) {
-      bossBall.weapons[i].attackTimer = 1;
-    }
+  if (Vector2Distance(world->bossMarine.weaponOffset, headshotWeaponOffset) < 0.5 &&
+      fabsf(world->bossMarine.weaponAngle) < 0.1f) {
+    PlaySound(bossMarineShotgunSound);
+    ResumeMusicStream(bossMarineMusic);
+    world->gameState = GAME_STATS;
 
-    if (bossBall.weapons[i].attackTimer > 0.0f) {
-      bossBall.weapons[i].fireCooldown -= GetFrameTime();
+    world->firstNewPerk = 0;
+    world->secondNewPerk = 0;
+    playerGiveTwoRandomPerks();
+  }
+}
 
-      float angle = 0;
-      if (bossBall.weapons[i].isDisconnected) {
-        angle = bossBall.weapons[i].angle;
-      } else {
-        angle = bossBall.weapons[i].angle + bossBall.weapons[i].angleOffset + bossBall.weaponAngleOffset;
-      }
+void updateDeadBall(void) {
+  if (world->deadBallTimer > 0.0f) {
+    return;
+  }
 
-      switch (bossBall.weapons[i].type) {
-      case BOSS_BALL_WEAPON_TURRET: {
-        if (bossBall.weapons[i].fireCooldown <= 0.0f) {
-          bossBallShootProjectile(0.5f, 0, NULL, 10, red, RED, i, angle, bossBall.weapons[i].bulletOrigin);
-          bossBallShootProjectile(0.5f, 0.07f, NULL, 10, red, RED, i, angle, bossBall.weapons[i].bulletOrigin2);
-          PlaySound(bossBallTurretSound);
-        }
-      } break;
-      case BOSS_BALL_WEAPON_LASER: {
-        if (bossBall.weapons[i].chargeLevel == 0.0f) {
-          PlaySound(bossBallLaserChargingSound);
-        }
+  PlaySound(bossBallDeath);
+  ResumeMusicStream(bossBallMusic);
+  world->gameState = GAME_STATS;
 
-        UpdateMusicStream(bossBall.weapons[i].soundEffect);
+  world->firstNewPerk = 0;
+  world->secondNewPerk = 0;
+  playerGiveTwoRandomPerks();
+}
 
-        if (bossBall.weapons[i].chargeLevel < 1.0f) {
-          bossBall.weapons[i].chargeLevel += GetFrameTime();
-        } else {
-          if (!IsMusicStreamPlaying(bossBall.weapons[i].soundEffect)) {
-            PlayMusicStream(bossBall.weapons[i].soundEffect);
-          }
+void updateDeadBoss(void) {
+  switch (world->currentBoss) {
+  case BOSS_MARINE: {
+    updateDeadMarine();
+  } break;
+  case BOSS_BALL: {
+    world->deadBallTimer -= simulationFrameTime();
+    updateDeadBall();
+  } break;
+  }
+}
 
-          bossBall.weapons[i].laserLength = Lerp(bossBall.weapons[i].laserLength, LASER_WIDTH, 0.1f);
-        }
-      } break;
-      case BOSS_BALL_WEAPON_ROCKET_LAUNCHER: {
-        if (bossBall.weapons[i].fireCooldown > 0.0f) {
-          break;
-        }
 
-        Projectile *new_projectile = push_projectile();
+void updateDeadPlayer(void) {
+  if (world->deadPlayerTime <= 0.0f) {
+    ResumeMusicStream(bossMarineMusic);
+    world->gameState = GAME_STATS;
+  }
+}
 
-        if (new_projectile == NULL) {
-          break;
-        }
+void updateBossDead(void) {
+  blackBackgroundAlpha = damp(blackBackgroundAlpha,
+                              1.0f,
+                              0.2f);
+  blackBackgroundAlpha = Clamp(blackBackgroundAlpha,
+                               0, 1);
 
-        *new_projectile = (Projectile) {
-          .type = PROJECTILE_SQUARED,
-          .isHurtfulForBoss = false,
-          .isHurtfulForPlayer = true,
-          .damage = 1,
-          .origin = Vector2Add(bossBall.weapons[i].bulletOrigin, bossBall.weapons[i].position),
-          .size = (Vector2) {30, 50},
-          .delta = Vector2Rotate((Vector2){0, -10}, angle * DEG2RAD),
-          .angle = angle,
-          .inside = BLACK,
-          .outside = red,
-          .lifetime = 5,
-          .canBounce = false,
-          .homesOntoPlayer = true,
-        };
+  /* updateMouse(); */
+  updateCamera();
+  updateProjectiles();
+  updateDeadBoss();
+}
 
-        bossBall.weapons[i].fireCooldown = 1.0f;
+void updateAndRenderBossDead(void) {
+  simulateTicks(updateBossDead, GAME_BOSS_DEAD);
 
-        PlaySound(bossBallRocketSound);
-      } break;
-      case BOSS_BALL_WEAPON_COUNT: break;
-      case BOSS_BALL_WEAPON_NONE: break;
-      }
-    } else {
-      StopMusicStream(bossBall.weapons[i].soundEffect);
+  renderPhase1();
+  renderFinal();
+}
 
-      bossBall.weapons[i].laserLength = 0;
-      bossBall.weapons[i].chargeLevel = 0;
+void updatePlayerDead(void) {
+  blackBackgroundAlpha = damp(blackBackgroundAlpha,
+                              1.0f,
+                              0.2f);
+  blackBackgroundAlpha = Clamp(blackBackgroundAlpha,
+                               0, 1);
 
-      bossBall.weapons[i].attackCooldown = bossBall.weapons[i].isDisconnected ? 2.5f : 0.5f;
-    }
-  }
+  world->deadPlayerTime -= simulationFrameTime();
+
+  /* updateMouse(); */
+  updateCamera();
+  updateProjectiles();
+  updateDeadPlayer();
 }
 
-void bossBallWeaponCalculateBulletOrigin(int i, float angle) {
-  Vector2 laserBulletOrigin = Vector2Scale((Vector2){0, -20}, SPRITES_SCALE);
-  Vector2 rocketLauncherBulletOrigin = Vector2Scale((Vector2){0, -30}, SPRITES_SCALE);
+void updateAndRenderPlayerDead(void) {
+  simulateTicks(updatePlayerDead, GAME_PLAYER_DEAD);
 
-  Vector2 turretBulletOrigin1 = Vector2Scale((Vector2){-13, -23}, SPRITES_SCALE);
-  Vector2 turretBulletOrigin2 = Vector2Scale((Vector2){13, -23}, SPRITES_SCALE);
+  renderPhase1();
+  renderFinal();
+}
 
-  float rads = angle * DEG2RAD;
+Rectangle perkRect(Perk perk) {
+#define X(v, m, n, rx, ry, rw, rh) case v: return (Rectangle) {rx, ry, rw, rh};
 
-  switch (bossBall.weapons[i].type) {
-  case BOSS_BALL_WEAPON_LASER: {
-    bossBall.weapons[i].bulletOrigin = Vector2Rotate(laserBulletOrigin, rads);
-  } break;
-  case BOSS_BALL_WEAPON_ROCKET_LAUNCHER: {
-    bossBall.weapons[i].bulletOrigin = Vector2Rotate(rocketLauncherBulletOrigin, rads);
-  } break;
-  case BOSS_BALL_WEAPON_TURRET: {
-    bossBall.weapons[i].bulletOrigin = Vector2Rotate(turretBulletOrigin1, rads);
-    bossBall.weapons[i].bulletOrigin2 = Vector2Rotate(turretBulletOrigin2, rads);
-  } break;
-  case BOSS_BALL_WEAPON_COUNT: break;
-  case BOSS_BALL_WEAPON_NONE: break;
-  }
-}
+  switch (perk) {
+    X_PERKS
+  };
 
-#define BOSS_BALL_WEAPON_DISTANCE ((float)BOSS_BALL_HITBOX_RADIUS * 1.5f)
+#undef X
 
-void bossBallUpdateConnectedWeapon(int i) {
-  Vector2 up = {0, -BOSS_BALL_WEAPON_DISTANCE};
+  assert(false);
+}
 
-  float angle =
-    bossBall.weapons[i].angle +
-    bossBall.weaponAngleOffset;
+char *perkName(Perk perk) {
+#define X(v, m, n, rx, ry, rw, rh) case v: return n;
 
-  if (angle >= 360.0) {
-    angle -= 360.0f;
-  }
+  switch (perk) {
+    X_PERKS
+  };
 
-  bossBall.weapons[i].position = Vector2Rotate(up, angle * DEG2RAD);
-  bossBall.weapons[i].position = Vector2Add(bossBall.position, bossBall.weapons[i].position);
+#undef X
 
-  float a = angleBetweenPoints(bossBall.weapons[i].position, player.position);
-  float offset = a - angle;
+  assert(false);
+}
 
-  bossBall.weapons[i].seesPlayer = true;
+static bool pressedKeys[420] = {0};
 
-#define BOSS_BALL_MAX_WEAPON_ANGLE_OFFSET 60.0f
-  if (fabsf(offset) > BOSS_BALL_MAX_WEAPON_ANGLE_OFFSET) {
-    offset = 0;
-    bossBall.weapons[i].seesPlayer = false;
-  }
+void updateAndRenderStats(void) {
+  KeyboardKey key = KEY_NULL;
 
-  float t = 0.1f;
+  if ((key = GetKeyPressed()) != KEY_NULL) {
+    pressedKeys[key] = true;
+  }
 
-  if (bossBall.weapons[i].type == BOSS_BALL_WEAPON_LASER &&
-      bossBall.weapons[i].chargeLevel >= 1.0f) {
-    t = 0.03;
+  bool anyKeyReleased = false;
+  for (int i = 0; i < sizeof(pressedKeys) / sizeof(pressedKeys[0]); i++) {
+    if (pressedKeys[i] && IsKeyReleased(i)) {
+      anyKeyReleased = true;
+      memset(pressedKeys, 0, sizeof(pressedKeys));
+      break;
+    }
   }
 
-  bossBall.weapons[i].angleOffset = Lerp(bossBall.weapons[i].angleOffset, offset, t);
+  if (anyKeyReleased ||
+      IsMouseButtonReleased(MOUSE_BUTTON_LEFT) ||
+      IsMouseButtonReleased(MOUSE_BUTTON_RIGHT) ||
+      autopilot) {
+    PlaySound(beep);
 
-  bossBallWeaponCalculateBulletOrigin(i, bossBall.weapons[i].angle + bossBall.weaponAngleOffset + bossBall.weapons[i].angleOffset);
-}
+    if (autopilot && world->player.health > 0) {
+      autopilotReport.bossesDefeated += 1;
+    }
 
-void disconnectedWeaponsCollision(int i) {
-  for (int j = 0; j < BOSS_BALL_WEAPONS; j++) {
-    if (j == i ||
-        !bossBall.weapons[j].isDisconnected) {
-      continue;
+    if (world->player.health == 0) {
+      world->gameState = GAME_MAIN_MENU;
+      resetGame();
+      return;
     }
 
-    float distance = Vector2Distance(bossBall.weapons[i].position,
-                                     bossBall.weapons[j].position);
-    float radiusSum =
-      bossBallWeaponHitboxRadiuses[bossBall.weapons[i].type] +
-      bossBallWeaponHitboxRadiuses[bossBall.weapons[j].type];
+    switch (world->currentBoss) {
+    case BOSS_MARINE: {
+      introductionSkipTimer = 0.1f;
 
-    if (distance < radiusSum) {
-      float angle =
-        angleBetweenPoints(bossBall.weapons[i].position,
-                           bossBall.weapons[j].position) *
-        DEG2RAD;
+      world->gameState = GAME_BOSS_INTRODUCTION;
+      world->currentBoss = BOSS_BALL;
 
-        float offsetDistance = distance - radiusSum;
-        Vector2 offset = Vector2Rotate((Vector2) {0, offsetDistance}, angle);
+      introductionStage = BOSS_INTRODUCTION_BEGINNING;
 
-        bossBall.weapons[j].position = Vector2Add(bossBall.weapons[j].position, offset);
-        return;
+      initPlayer();
+      world->playerStats.bossTime = 0.0f;
+    } break;
+    case BOSS_BALL: {
+      world->gameState = GAME_MAIN_MENU;
+      resetGame();
+    } break;
     }
+
+    return;
   }
-}
 
-#define WEAPON_MOVE_SPEED 2
-#define WEAPON_MIN_PLAYER_DISTANCE 150
-#define WEAPON_MAX_PLAYER_DISTANCE 600
-void weaponFollowPlayer(int i) {
-  float weaponPlayerAngle = angleBetweenPoints(player.position, bossBall.weapons[i].position);
-  float weaponPlayerDistance = Vector2Distance(player.position, bossBall.weapons[i].position);
+  UpdateMusicStream(bossMarineMusic);
+  updateMouse();
 
-  Vector2 delta = Vector2Rotate((Vector2) {0, -WEAPON_MOVE_SPEED},
-                                weaponPlayerAngle * DEG2RAD);
+  float mul = camera.zoom * 2;
+  Font f = GetFontDefault();
+  float fontSize = 25 * mul;
+  float spacing = 2 * mul;
 
-  if (weaponPlayerDistance < WEAPON_MIN_PLAYER_DISTANCE) {
-    bossBall.weapons[i].position = Vector2Add(bossBall.weapons[i].position,
-                                              Vector2Scale(delta, -1));
-  } else if (weaponPlayerDistance > WEAPON_MAX_PLAYER_DISTANCE) {
-    bossBall.weapons[i].position = Vector2Add(bossBall.weapons[i].position,
-                                              delta);
-  } else if (bossBall.weapons[i].isWalking) {
-    float angle = bossBall.weapons[i].walkingDirection * WEAPON_MOVE_SPEED;
-    Vector2 diff = Vector2Subtract(bossBall.weapons[i].position, player.position);
-    diff = Vector2Rotate(diff, angle * DEG2RAD);
-    bossBall.weapons[i].position = Vector2Lerp(bossBall.weapons[i].position,
-                                               Vector2Add(diff, player.position),
-                                               0.1f);
-  }
-}
+  BeginDrawing(); {
+    ClearBackground(BLACK);
 
-void bossBallUpdateDisconnectedWeapon(int i) {
-  disconnectedWeaponsCollision(i);
+    const char *boss_time_stat = frameFormat("BOSS TIME: %.2f", world->playerStats.bossTime);
+    Vector2 pos = {
+      .x = ((float)GetScreenWidth() / 2.0f),
+      .y = ((float)GetScreenHeight() / 5.0f),
+    };
+    Vector2 size = MeasureTextEx(f, boss_time_stat, fontSize, spacing);
 
-  if (bossBall.weapons[i].isDeactivated) {
-    bossBall.weapons[i].deactivationDark = Lerp(bossBall.weapons[i].deactivationDark, 0.5f, 0.1f);
-    return;
-  }
+    pos.y -= size.y;
 
-  bossBall.weapons[i].deactivationDark = Lerp(bossBall.weapons[i].deactivationDark, 1.0f, 0.1f);
+    DrawTextPro(f, boss_time_stat, pos, Vector2Scale(size, 0.5f), 0, fontSize, spacing, WHITE);
+    pos.y += size.y;
 
-  if (bossBall.weapons[i].standingWalkingTimer <= 0.0f) {
-    bossBall.weapons[i].isWalking = GetRandomValue(0, 1);
-    bossBall.weapons[i].walkingDirection = GetRandomValue(-1, 1);
-    bossBall.weapons[i].standingWalkingTimer = GetRandomValue(1, 5);
-  } else {
-    bossBall.weapons[i].standingWalkingTimer -= GetFrameTime();
-  }
+    const char *time_stat = frameFormat("OVERALL TIME: %.2f", world->playerStats.time);
 
-  weaponFollowPlayer(i);
+    size = MeasureTextEx(f, time_stat, fontSize, spacing);
 
-  float angle = angleBetweenPoints(bossBall.weapons[i].position, player.position);
+    DrawTextPro(f, time_stat, pos, Vector2Scale(size, 0.5f), 0, fontSize, spacing, WHITE);
+    pos.y += size.y;
 
-  float t = 0.1f;
+    const char *kills_stat = frameFormat("KILLS: %d", world->playerStats.kills);
+    size = MeasureTextEx(f, kills_stat, fontSize, spacing);
 
-  if (bossBall.weapons[i].type == BOSS_BALL_WEAPON_LASER &&
-      bossBall.weapons[i].chargeLevel >= 1.0f) {
-    t = 0.03;
-  }
+    DrawTextPro(f, kills_stat, pos, Vector2Scale(size, 0.5f), 0, fontSize, spacing, WHITE);
 
-  bossBall.weapons[i].angle = Lerp(bossBall.weapons[i].angle, angle, t);
+    if (world->currentBoss == BOSS_MARINE && world->player.health > 0) {
+      float x1 = (float)GetScreenWidth() / 4.0f;
+      float x2 = (float)GetScreenWidth() - x1;
 
-  bossBallWeaponCalculateBulletOrigin(i, bossBall.weapons[i].angle);
+      float perkMul = mul * 3;
+      DrawTexturePro(sprites,
+                     perkRect(world->firstNewPerk),
+                     (Rectangle) {
+                       .x = x1,
+                       .y = (float)GetScreenHeight() / 2.0f,
+                       .width = perkRect(world->firstNewPerk).width * perkMul,
+                       .height = perkRect(world->firstNewPerk).height * perkMul,
+                     },
+                     (Vector2) {
+                       .x = perkRect(world->firstNewPerk).width * perkMul * 0.5f,
+                       .y = perkRect(world->firstNewPerk).height * perkMul * 0.5f,
+                     },
+                     0,
+                     WHITE);
 
-  float r = bossBallWeaponHitboxRadiuses[bossBall.weapons[i].type];
-  Vector2 min = {r, r};
-  Vector2 max = {LEVEL_WIDTH - r, LEVEL_HEIGHT - r};
+      DrawTexturePro(sprites,
+                     perkRect(world->secondNewPerk),
+                     (Rectangle) {
+                       .x = x2,
+                       .y = (float)GetScreenHeight() / 2.0f,
+                       .width = perkRect(world->firstNewPerk).width * perkMul,
+                       .height = perkRect(world->firstNewPerk).height * perkMul,
+                     },
+                     (Vector2) {
+                       .x = perkRect(world->firstNewPerk).width * perkMul * 0.5f,
+                       .y = perkRect(world->firstNewPerk).height * perkMul * 0.5f,
+                     },
+                     0,
+                     WHITE);
 
-  bossBall.weapons[i].position = Vector2Clamp(bossBall.weapons[i].position, min, max);
-}
+      char *perk1 = perkName(world->firstNewPerk);
+      char *perk2 = perkName(world->secondNewPerk);
 
-void bossBallUpdateWeapons(void) {
-  for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
-    if (bossBall.weapons[i].isDisconnected) {
-      bossBallUpdateDisconnectedWeapon(i);
-    } else {
-      bossBallUpdateConnectedWeapon(i);
-    }
-  }
-}
+      Vector2 pos1 = {x1, (float)GetScreenHeight() - ((float)GetScreenHeight() / 3.0f)};
+      Vector2 pos2 = {x2, (float)GetScreenHeight() - ((float)GetScreenHeight() / 3.0f)};
 
-int compareWeaponsBasedOnDistanceToPlayer(const void *a, const void *b) {
-  const int i = *(const int*)a;
-  const int j = *(const int*)b;
+      Vector2 size1 = MeasureTextEx(f, perk1, fontSize, spacing);
+      Vector2 size2 = MeasureTextEx(f, perk2, fontSize, spacing);
 
-  const float d1 = Vector2Distance(bossBall.weapons[i].position,
-                                   player.position);
-  const float d2 = Vector2Distance(bossBall.weapons[j].position,
-                                   player.position);
+      DrawTextPro(f, perk1, pos1, Vector2Scale(size1, 0.5f), 0, fontSize, spacing, WHITE);
+      DrawTextPro(f, perk2, pos2, Vector2Scale(size2, 0.5f), 0, fontSize, spacing, WHITE);
+    }
 
-  if (d1 < d2) {
-    return -1;
-  }
+    const char *cont = "PRESS ANY KEY TO CONTINUE";
+    pos.y = (float)GetScreenHeight() - ((float)GetScreenHeight() / 6.0f);
 
-  if (d1 > d2) {
-    return 1;
-  }
+    size = MeasureTextEx(f, cont, fontSize, spacing);
+    DrawTextPro(f, cont, pos, Vector2Scale(size, 0.5f), 0, fontSize, spacing, WHITE);
 
-  return 0;
+    renderMouseCursor();
+  } EndDrawing();
 }
 
-void tryDisconnectingWeapon(void) {
-  int weaponIndexes[BOSS_BALL_WEAPONS] = {0};
-  for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
-    weaponIndexes[i] = i;
-  }
+/* NOTE: rollback netplay, every peer predicts the other one's input and replays the ticks it got wrong */
+#define NETPLAY_PLAYERS 2
+#define NETPLAY_ROLLBACK_MAX 8
+/* NOTE: one more than the rollback window, the tick that is about to be simulated needs a snapshot too */
+#define NETPLAY_SNAPSHOTS (NETPLAY_ROLLBACK_MAX + 1)
+/* NOTE: a power of two, input history outlives the rollback window so that late peers can catch up */
+#define NETPLAY_HISTORY 64
+#define NETPLAY_PACKET_INPUTS 32
+#define NETPLAY_WIRE_MAX 256
+#define NETPLAY_MAGIC 0x42525453u
+#define NETPLAY_SEED 1
 
-  qsort(weaponIndexes,
-        BOSS_BALL_WEAPONS, sizeof(weaponIndexes[0]),
-        compareWeaponsBasedOnDistanceToPlayer);
+/* what goes over the wire, the aim is snapped to whole pixels so that both peers replay the same numbers */
+typedef struct {
+  uint8_t movement;
+  uint8_t buttons;
+  int16_t aimX;
+  int16_t aimY;
+} NetInput;
 
-  for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
-    int j = weaponIndexes[i];
+#define NET_INPUT_FIRE 0b01
+#define NET_INPUT_DASH 0b10
 
-    if (bossBall.weapons[j].isDisconnected) {
-      continue;
-    }
+typedef struct {
+  uint32_t magic;
+  /* the tick of `inputs[0]` */
+  int32_t first;
+  /* the newest tick the sender has the receiver's input for */
+  int32_t ack;
+  int32_t checksumFrame;
+  uint32_t checksum;
+  uint8_t len;
+  NetInput inputs[NETPLAY_PACKET_INPUTS];
+} NetPacket;
 
-    bossBall.weapons[j].isDisconnected = true;
-    break;
-  }
-}
+typedef struct {
+  NetPacket packet;
+  int64_t deliverAt;
+} NetDelayedPacket;
 
-void disconnectAWeaponIfThePlayerIsTooCloseForTooLong(void) {
-  if (Vector2Distance(player.position, bossBall.position) <= (BOSS_BALL_WEAPON_DISTANCE * 1.5f)) {
-    bossBall.playerInsideDeadZoneTimer += GetFrameTime();
-  } else {
-    bossBall.playerInsideDeadZoneTimer = Lerp(bossBall.playerInsideDeadZoneTimer, 0, 0.1f);
-  }
+typedef struct {
+  NetDelayedPacket items[NETPLAY_WIRE_MAX];
+  int len;
+} NetWire;
 
-  #define PLAYER_DEAD_ZONE_TIMER_LIMIT 1.5f
-  if (bossBall.playerInsideDeadZoneTimer >= PLAYER_DEAD_ZONE_TIMER_LIMIT) {
-    bossBall.playerInsideDeadZoneTimer = 0.0f;
+typedef enum {
+  NET_TRANSPORT_LOOPBACK,
+  NET_TRANSPORT_UDP,
+} NetTransportType;
 
-    tryDisconnectingWeapon();
-  }
-}
+typedef struct {
+  NetTransportType type;
 
-void bossBallCheckDisconnectedWeaponCollisions(void) {
-  for (int w = 0; w < BOSS_BALL_WEAPONS; w++) {
-    if (!bossBall.weapons[w].isDisconnected) {
-      continue;
-    }
+  int latency;
+  int loss;
+  uint32_t lossState;
 
-    for (int i = 0; i < asteroidsLen; i++) {
-      for (int j = 0; j < asteroids[i].sprite->boundingCirclesLen; j++) {
-        Vector2 pos =
-          Vector2Add(asteroids[i].processedBoundingCircles[j].position,
-                     asteroids[i].position);
+  int64_t now;
+  NetWire outgoing;
 
-        float distance = Vector2Distance(pos, bossBall.weapons[w].position);
-        float radiusSum =
-          (asteroids[i].processedBoundingCircles[j].radius +
-           bossBallWeaponHitboxRadiuses[bossBall.weapons[w].type]);
+  NetWire *inbox;
+  NetWire *peerInbox;
 
-        if (distance < radiusSum) {
-          float angle = angleBetweenPoints(bossBall.weapons[w].position, pos);
+#if defined(NETPLAY_UDP)
+  int socket;
+  struct sockaddr_in remote;
+#endif
 
-          float offsetDistance = distance - radiusSum;
-          Vector2 offset = Vector2Rotate((Vector2) {0, offsetDistance}, angle * DEG2RAD);
+  int sent;
+  int dropped;
+} NetTransport;
 
-          asteroids[i].position = Vector2Add(asteroids[i].position, offset);
-          asteroids[i].delta = Vector2Add(asteroids[i].delta, Vector2Scale(offset, 0.1f));
+typedef struct {
+  World *world;
+  NetTransport transport;
 
-          if (asteroids[i].launchedByPlayer) {
-            asteroids[i].launchedByPlayer = false;
-            bossBallDeactivateWeapon(w);
+  int local;
 
-          }
+  int frame;
+  int remoteFrame;
+  int remoteAck;
+  /* the oldest tick that was simulated with a wrong guess, -1 when every guess held up */
+  int rollbackFrom;
 
-          goto player;
-        }
-      }
-    }
-  player:;
+  PlayerInput inputs[NETPLAY_PLAYERS][NETPLAY_HISTORY];
 
+  /* the world right before each of the last ticks */
+  World *snapshots;
 
-    float distance = Vector2Distance(player.position, bossBall.weapons[w].position);
-    float radiusSum =
-      (PLAYER_HITBOX_RADIUS +
-       bossBallWeaponHitboxRadiuses[bossBall.weapons[w].type]);
+  /* of the world after every tick both inputs are known for */
+  uint32_t checksums[NETPLAY_HISTORY];
+  int checksumFrame;
+  bool desynced;
 
-    if (distance < radiusSum) {
-      float angle = angleBetweenPoints(bossBall.weapons[w].position, player.position);
+  int rollbacks;
+  int resimulatedTicks;
+  int longestRollback;
+  double worstRollbackTime;
+  int stalls;
+} NetplaySession;
 
-      float offsetDistance = distance - radiusSum;
-      Vector2 offset = Vector2Rotate((Vector2) {0, offsetDistance}, angle * DEG2RAD);
+typedef struct {
+  bool active;
+  NetplaySession session;
 
-      player.position = Vector2Add(player.position, offset);
+  NetplaySession *peer;
+  NetWire loopbackWires[NETPLAY_PLAYERS];
+} Netplay;
 
-      if (playerPerks & PERK_OMINOUS_AURA) {
-        bossBallDeactivateWeapon(w);
-      }
-    }
+static Netplay netplay = {0};
+
+void netWirePush(NetWire *wire, const NetPacket *packet, int64_t deliverAt) {
+  if (wire->len == NETPLAY_WIRE_MAX) {
+    return;
   }
+
+  wire->items[wire->len++] = (NetDelayedPacket) {
+    .packet = *packet,
+    .deliverAt = deliverAt,
+  };
 }
 
-void disconnectWeaponBasedOhHealth(void) {
-  float health = (float)bossBall.health / (float)BOSS_BALL_MAX_HEALTH;
-  int supposedAmountOfConnectedWeapons = floorf(((float)BOSS_BALL_WEAPONS + 1) * health);
+bool openNetTransport(NetTransport *transport, NetTransportType type, int port, int remotePort, int latency, int loss) {
+  *transport = (NetTransport) {
+    .type = type,
+    .latency = (int)roundf(latency * REFERENCE_FRAME_RATE / 1000.0f),
+    .loss = Clamp(loss, 0, 100),
+    .lossState = 0x9E3779B9u ^ (uint32_t)port,
+  };
 
-  int amountOfConnectedWeapons = 0;
-  for (int i = 0; i < BOSS_BALL_WEAPONS; i++) {
-    if (!bossBall.weapons[i].isDisconnected) {
-      amountOfConnectedWeapons += 1;
-    }
+  if (type == NET_TRANSPORT_LOOPBACK) {
+    return true;
   }
 
-  if (amountOfConnectedWeapons > supposedAmountOfConnectedWeapons) {
-    tryDisconnectingWeapon();
+#if defined(NETPLAY_UDP)
+  transport->socket = socket(AF_INET, SOCK_DGRAM, 0);
+
+  if (transport->socket < 0) {
+    return false;
   }
-}
 
-void updateBossBall(void) {
-  if (bossBall.health <= 0) {
-    PauseMusicStream(bossBallMusic);
-    playerStats.kills += 1;
-    gameState = GAME_BOSS_DEAD;
+  struct sockaddr_in local = {
+    .sin_family = AF_INET,
+    .sin_port = htons(port),
+    .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+  };
 
-    for (int i = 0; i < PROJECTILES_MAX; i++) {
-      if (projectiles[i].type != PROJECTILE_NONE) {
-        projectiles[i].willBeDestroyed = true;
-        projectiles[i].destructionTimer = 0.02f;
-      }
-    }
-    return;
+  if (bind(transport->socket, (struct sockaddr *)&local, sizeof(local)) < 0) {
+    close(transport->socket);
+    return false;
   }
 
-  bossBall.weaponAngleOffset = Lerp(bossBall.weaponAngleOffset,
-                                    bossBall.weaponAngleTargetOffset,
-                                    0.1f);
+  fcntl(transport->socket, F_SETFL, fcntl(transport->socket, F_GETFL, 0) | O_NONBLOCK);
 
-  disconnectWeaponBasedOhHealth();
-  disconnectAWeaponIfThePlayerIsTooCloseForTooLong();
+  transport->remote = (struct sockaddr_in) {
+    .sin_family = AF_INET,
+    .sin_port = htons(remotePort),
+    .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+  };
 
-  bossBallUpdateWeapons();
+  return true;
+#else
+  return false;
+#endif
+}
 
-  bossBallRoll();
-  bossBallCheckCollisions(true);
-  bossBallCheckDisconnectedWeaponCollisions();
+void closeNetTransport(NetTransport *transport) {
+#if defined(NETPLAY_UDP)
+  if (transport->type == NET_TRANSPORT_UDP) {
+    close(transport->socket);
+  }
+#endif
 
-  bossBallAttack();
+  (void)transport;
 }
 
-void updateParticles(void) {
-  const float ft = GetFrameTime();
+void netTransportSend(NetTransport *transport, const NetPacket *packet) {
+  transport->sent += 1;
 
-  for (int i = 0; i < PARTICLES_MAX; i++) {
-    if (particles[i].lifetime <= 0.0f) {
-      continue;
-    }
+  /* NOTE: xorshift32, the world's generator must not know about the network */
+  uint32_t x = transport->lossState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  transport->lossState = x;
 
-    particles[i].lifetime -= ft;
-    particles[i].position = Vector2Add(particles[i].position, particles[i].delta);
+  if ((int)(x % 100) < transport->loss) {
+    transport->dropped += 1;
+    return;
   }
+
+  netWirePush(&transport->outgoing, packet, transport->now + transport->latency);
 }
 
-void updateAndRenderBossFight(void) {
-  if (IsKeyPressed(KEY_ESCAPE)) {
-    PlaySound(beep);
-    isGamePaused = !isGamePaused;
-  }
+void netTransportFlush(NetTransport *transport) {
+  transport->now += 1;
 
-  if (isGamePaused) {
-    PauseMusicStream(bossMarineMusic);
-    PauseMusicStream(bossBallMusic);
-    updateAndRenderPauseScreen();
-    return;
-  }
+  int kept = 0;
 
-  if (player.health == 0) {
-    gameState = GAME_PLAYER_DEAD;
+  for (int i = 0; i < transport->outgoing.len; i++) {
+    NetDelayedPacket *delayed = &transport->outgoing.items[i];
 
-    PauseMusicStream(bossMarineMusic);
-    PauseMusicStream(bossBallMusic);
-    PlaySound(playerDeathSound);
-    return;
-  }
+    if (delayed->deliverAt > transport->now) {
+      transport->outgoing.items[kept++] = *delayed;
+      continue;
+    }
 
-  updateCamera();
+    switch (transport->type) {
+    case NET_TRANSPORT_LOOPBACK: {
+      netWirePush(transport->peerInbox, &delayed->packet, 0);
+    } break;
+    case NET_TRANSPORT_UDP: {
+#if defined(NETPLAY_UDP)
+      sendto(transport->socket, &delayed->packet, sizeof(delayed->packet), 0,
+             (struct sockaddr *)&transport->remote, sizeof(transport->remote));
+#endif
+    } break;
+    }
+  }
 
-  switch (currentBoss) {
-  case BOSS_MARINE: {
-    ResumeMusicStream(bossMarineMusic);
+  transport->outgoing.len = kept;
+}
 
-    if (!IsMusicStreamPlaying(bossMarineMusic)) {
-      PlayMusicStream(bossMarineMusic);
+bool netTransportReceive(NetTransport *transport, NetPacket *packet) {
+  switch (transport->type) {
+  case NET_TRANSPORT_LOOPBACK: {
+    if (transport->inbox->len == 0) {
+      return false;
     }
 
-    UpdateMusicStream(bossMarineMusic);
-  } break;
-  case BOSS_BALL: {
-    ResumeMusicStream(bossBallMusic);
+    *packet = transport->inbox->items[0].packet;
 
-    if (!IsMusicStreamPlaying(bossBallMusic)) {
-      PlayMusicStream(bossBallMusic);
-    }
+    transport->inbox->len -= 1;
+    memmove(&transport->inbox->items[0], &transport->inbox->items[1],
+            transport->inbox->len * sizeof(transport->inbox->items[0]));
 
-    UpdateMusicStream(bossBallMusic);
+    return true;
+  }
+  case NET_TRANSPORT_UDP: {
+#if defined(NETPLAY_UDP)
+    return recvfrom(transport->socket, packet, sizeof(*packet), 0, NULL, NULL) == (ssize_t)sizeof(*packet);
+#endif
   } break;
   }
 
-  updateProjectiles();
-  updateParticles();
-  updateThrusterTrails();
-  updatePlayerDashTrails();
-  updateAsteroids();
-  updateBackgroundAsteroid();
+  return false;
+}
 
-  updateMouse();
-  updatePlayerPosition();
-  updatePlayerCooldowns();
+NetInput encodeInput(PlayerInput input) {
+  return (NetInput) {
+    .movement = (uint8_t)input.movement,
+    .buttons = (input.fire ? NET_INPUT_FIRE : 0) | (input.dash ? NET_INPUT_DASH : 0),
+    .aimX = (int16_t)Clamp(roundf(input.aim.x), INT16_MIN, INT16_MAX),
+    .aimY = (int16_t)Clamp(roundf(input.aim.y), INT16_MIN, INT16_MAX),
+  };
+}
 
-  switch (currentBoss) {
-  case BOSS_MARINE: updateBossMarine(); break;
-  case BOSS_BALL: updateBossBall(); break;
-  }
+PlayerInput decodeInput(NetInput input) {
+  return (PlayerInput) {
+    .movement = input.movement,
+    .aim = (Vector2) {input.aimX, input.aimY},
+    .fire = (input.buttons & NET_INPUT_FIRE) != 0,
+    .dash = (input.buttons & NET_INPUT_DASH) != 0,
+  };
+}
 
-  tryDashing();
-  tryFiringAShot();
+bool sameInput(PlayerInput a, PlayerInput b) {
+  return a.movement == b.movement &&
+    a.aim.x == b.aim.x &&
+    a.aim.y == b.aim.y &&
+    a.fire == b.fire &&
+    a.dash == b.dash;
+}
 
-  renderPhase1();
-  renderFinal();
+PlayerInput *netplayInput(NetplaySession *session, int player, int frame) {
+  return &session->inputs[player][frame & (NETPLAY_HISTORY - 1)];
 }
 
-void renderGameTitle(void) {
-  float mul = camera.zoom * 2;
+/* NOTE: the other peer most likely keeps doing what it did last, except for dashing, which is a single press */
+void netplayPredict(NetplaySession *session, int frame) {
+  int remote = 1 - session->local;
 
-  Font f = GetFontDefault();
-  char *text = "STRIBUN";
-  float fontSize = 50 * mul;
-  float spacing = 4 * mul;
-  Vector2 size = MeasureTextEx(f, text, fontSize, spacing);
+  if (frame <= session->remoteFrame) {
+    return;
+  }
 
-  Vector2 pos = (Vector2) {
-    .x = (float)GetScreenWidth() / 2,
-    .y = (float)GetScreenHeight() / 6,
-  };
+  PlayerInput guess = {0};
 
-  DrawTextPro(f,
-              text,
-              Vector2Add(pos, (Vector2) {spacing, spacing}),
-              Vector2Scale(size, 0.5f),
-              0,
-              fontSize,
-              spacing,
-              BLACK);
+  if (session->remoteFrame >= 0) {
+    guess = *netplayInput(session, remote, session->remoteFrame);
+    guess.dash = false;
+  }
 
-  DrawTextPro(f,
-              text,
-              pos,
-              Vector2Scale(size, 0.5f),
-              0,
-              fontSize,
-              spacing,
-              WHITE);
+  *netplayInput(session, remote, frame) = guess;
 }
 
-void renderPhase0(void) {
-  preRenderBackground(true);
-
-  BeginTextureMode(target); {
-    renderBackground();
-  } EndTextureMode();
+void netplaySave(NetplaySession *session, int frame) {
+  memcpy(&session->snapshots[frame % NETPLAY_SNAPSHOTS], world, sizeof(World));
 }
 
-static float floatingShipRotation = 0;
-static float floatingShipRotationDelta = 360.0f / 30.0f;
+void netplayLoad(NetplaySession *session, int frame) {
+  bool silent = world->silent;
+  memcpy(world, &session->snapshots[frame % NETPLAY_SNAPSHOTS], sizeof(World));
+  world->silent = silent;
+}
 
-void updateFloatingShip(void) {
-  float halfWidth = (float)GetScreenWidth() / 2;
+uint32_t hashBytes(uint32_t hash, const void *data, size_t size) {
+  const uint8_t *bytes = data;
 
-  float scale = 1;
-  if (screenMouseLocation.x > halfWidth) {
-    scale = (screenMouseLocation.x - halfWidth) / halfWidth;
-  } else {
-    scale = (halfWidth - screenMouseLocation.x) / halfWidth;
-    scale *= -1;
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
   }
 
-  floatingShipRotation += floatingShipRotationDelta * scale;
+  return hash;
 }
 
-void renderFloatingShip(void) {
-  float y = (float)GetScreenHeight() / 2;
-  float x = (float)GetScreenWidth() / 4;
+/* NOTE: only fields that every tick touches, structs as a whole would hash their padding too */
+uint32_t worldChecksum(const World *w) {
+  uint32_t hash = 2166136261u;
 
-  float scale = camera.zoom * 30;
+#define HASH(v) hash = hashBytes(hash, &(v), sizeof(v))
+  HASH(w->randomState);
+  HASH(w->player.position);
+  HASH(w->player.health);
+  HASH(w->wingman.position);
+  HASH(w->wingman.health);
+  HASH(w->bossMarine.position);
+  HASH(w->bossMarine.health);
+  HASH(w->bossBall.position);
+  HASH(w->bossBall.health);
 
-  float width = playerRect.width * scale;
-  float height = playerRect.height * scale;
+  for (int i = 0; i < w->asteroidsLen; i++) {
+    HASH(w->asteroids[i].position);
+  }
 
-  DrawTexturePro(sprites,
-                 playerRect,
-                 (Rectangle) {x, y, width, height},
-                 (Vector2) {width / 2, height / 2},
-                 floatingShipRotation,
-                 WHITE);
-}
+  for (int i = 0; i < w->projectiles.pool.len; i++) {
+    HASH(w->projectiles.items[i].origin);
+  }
+#undef HASH
 
-void renderGameVersion(void) {
-  char *text = GAME_VERSION;
+  return hash;
+}
 
-  float mul = camera.zoom * 2;
+void netplaySimulateTick(NetplaySession *session, int frame) {
+  world->playerInput = *netplayInput(session, 0, frame);
+  world->wingmanInput = *netplayInput(session, 1, frame);
 
-  Font f = GetFontDefault();
-  float fontSize = 10 * mul;
-  float spacing = 1 * mul;
-  /* Vector2 size = MeasureTextEx(f, text, fontSize, spacing); */
+  world->simulationClock.tick = 1.0f / REFERENCE_FRAME_RATE;
+  world->simulationClock.time += world->simulationClock.tick;
 
-  Vector2 pos = (Vector2) {
-    .x = (float)10,
-    .y = (float)10,
-  };
+  simulateFight();
 
-  DrawTextPro(f,
-              text,
-              Vector2Add(pos, (Vector2) {spacing, spacing}),
-              Vector2Zero(),
-              0,
-              fontSize,
-              spacing,
-              BLACK);
+  if (world->gameState == GAME_BOSS &&
+      (world->player.health <= 0 || world->wingman.health <= 0)) {
+    world->gameState = GAME_PLAYER_DEAD;
+  }
+}
 
-  DrawTextPro(f,
-              text,
-              pos,
-              Vector2Zero(),
-              0,
-              fontSize,
-              spacing,
-              WHITE);
+void netplayReceive(NetplaySession *session) {
+  int remote = 1 - session->local;
+  NetPacket packet = {0};
 
-}
+  while (netTransportReceive(&session->transport, &packet)) {
+    if (packet.magic != NETPLAY_MAGIC || packet.len > NETPLAY_PACKET_INPUTS) {
+      continue;
+    }
 
-void renderMusicAuthor(void) {
-  char* text = "Music: Drozerix - Stardust Jam";
+    session->remoteAck = MAX(session->remoteAck, packet.ack);
 
-  float mul = camera.zoom * 2;
+    for (int k = 0; k < packet.len; k++) {
+      int frame = packet.first + k;
 
-  Font f = GetFontDefault();
-  float fontSize = 10 * mul;
-  float spacing = 1 * mul;
-  Vector2 size = MeasureTextEx(f, text, fontSize, spacing);
+      /* NOTE: resent inputs we already have, or ones past a gap that a later packet will fill */
+      if (frame != session->remoteFrame + 1) {
+        continue;
+      }
 
-  Vector2 pos = (Vector2) {
-    .x = (float)10,
-    .y = (float)GetScreenHeight() - size.y - 10,
-  };
+      PlayerInput input = decodeInput(packet.inputs[k]);
+      PlayerInput *slot = netplayInput(session, remote, frame);
 
-  float alpha = sin(GetTime()) * cos(GetTime()) + 0.5f;
+      if (frame < session->frame && !sameInput(*slot, input) &&
+          (session->rollbackFrom < 0 || frame < session->rollbackFrom)) {
+        session->rollbackFrom = frame;
+      }
 
-  DrawTextPro(f,
-              text,
-              Vector2Add(pos, (Vector2) {spacing, spacing}),
-              Vector2Zero(),
-              0,
-              fontSize,
-              spacing,
-              ColorAlpha(BLACK, alpha));
+      *slot = input;
+      session->remoteFrame = frame;
+    }
 
-  DrawTextPro(f,
-              text,
-              pos,
-              Vector2Zero(),
-              0,
-              fontSize,
-              spacing,
-              ColorAlpha(WHITE, alpha));
+    if (packet.checksumFrame >= 0 &&
+        packet.checksumFrame <= session->checksumFrame &&
+        packet.checksumFrame > session->checksumFrame - NETPLAY_HISTORY &&
+        session->checksums[packet.checksumFrame & (NETPLAY_HISTORY - 1)] != packet.checksum &&
+        !session->desynced) {
+      session->desynced = true;
+      LOG("NETPLAY: peer %d desynced at tick %d\n", session->local, packet.checksumFrame);
+    }
+  }
 }
 
-typedef enum {
-  BUTTON_ACTION_START,
-  BUTTON_ACTION_TOGGLE_CONTROLS,
-#ifdef PLATFORM_DESKTOP
-  BUTTON_ACTION_QUIT,
-#endif
-  BUTTON_ACTION_COUNT,
-} ButtonAction;
+/* NOTE: puts the world back to before the first wrong guess and replays up to the present with what is known now */
+void netplayRollback(NetplaySession *session) {
+  if (session->rollbackFrom < 0) {
+    return;
+  }
 
-typedef struct {
-  ButtonAction action;
-  Rectangle rect;
-} Button;
+  double start = GetTime();
+  bool silent = world->silent;
 
-static Button mainMenuButtons[BUTTON_ACTION_COUNT] = {0};
-static Vector2 mousePressLocation = {0};
-static Vector2 prevMouseLocation = {0};
+  netplayLoad(session, session->rollbackFrom);
+  world->silent = true;
 
-void updateButtons(void) {
-  float x = (float)GetScreenWidth() - (float)GetScreenWidth() / 4;
-  float width = (float)GetScreenWidth() / 4.5;
-  float height = (float)GetScreenHeight() / 8;
-  float y = (float)GetScreenHeight() / 3 + (height);
+  for (int frame = session->rollbackFrom; frame < session->frame; frame++) {
+    netplayPredict(session, frame);
+    netplaySave(session, frame);
+    netplaySimulateTick(session, frame);
+  }
 
-#ifdef PLATFORM_WEB
-  y += height;
-#endif
+  world->silent = silent;
 
-  for (int i = 0; i < BUTTON_ACTION_COUNT; i++) {
-    mainMenuButtons[i].action = i;
-    mainMenuButtons[i].rect = (Rectangle) {
-      x, y, width, height,
-    };
+  int ticks = session->frame - session->rollbackFrom;
 
-    if (!CheckCollisionPointRec(prevMouseLocation, mainMenuButtons[i].rect) &&
-        CheckCollisionPointRec(screenMouseLocation, mainMenuButtons[i].rect)) {
-      PlaySound(buttonFocusEffect);
-    }
+  session->rollbacks += 1;
+  session->resimulatedTicks += ticks;
+  session->longestRollback = MAX(session->longestRollback, ticks);
+  session->worstRollbackTime = MAX(session->worstRollbackTime, GetTime() - start);
+  session->rollbackFrom = -1;
+}
 
-    if (IsMouseButtonReleased(MOUSE_BUTTON_LEFT) &&
-        CheckCollisionPointRec(mousePressLocation, mainMenuButtons[i].rect) &&
-        CheckCollisionPointRec(screenMouseLocation, mainMenuButtons[i].rect)) {
-      switch (i) {
-      case BUTTON_ACTION_START: {
-        PlaySound(beep);
-        gameState = GAME_TUTORIAL;
-      } return;
-      case BUTTON_ACTION_TOGGLE_CONTROLS: {
-        PlaySound(beep);
-        esdf = !esdf;
-      } break;
-#ifdef PLATFORM_DESKTOP
-      case BUTTON_ACTION_QUIT: exit(0);
-#endif
-      default: break;
-      }
-    }
+void netplayConfirm(NetplaySession *session) {
+  int last = MIN(session->remoteFrame, session->frame - 1);
 
-    y += height * 1.5;
+  for (int frame = session->checksumFrame + 1; frame <= last; frame++) {
+    const World *after = frame + 1 == session->frame ? world : &session->snapshots[(frame + 1) % NETPLAY_SNAPSHOTS];
+    session->checksums[frame & (NETPLAY_HISTORY - 1)] = worldChecksum(after);
+    session->checksumFrame = frame;
   }
+}
 
-  if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-    mousePressLocation = screenMouseLocation;
+void netplaySend(NetplaySession *session) {
+  int first = MAX(session->remoteAck + 1, session->frame - NETPLAY_PACKET_INPUTS);
+
+  NetPacket packet = {
+    .magic = NETPLAY_MAGIC,
+    .first = first,
+    .ack = session->remoteFrame,
+    .checksumFrame = session->checksumFrame,
+    .checksum = session->checksumFrame >= 0 ? session->checksums[session->checksumFrame & (NETPLAY_HISTORY - 1)] : 0,
+    .len = MAX(session->frame - first, 0),
+  };
+
+  for (int k = 0; k < packet.len; k++) {
+    packet.inputs[k] = encodeInput(*netplayInput(session, session->local, first + k));
   }
 
-  prevMouseLocation = screenMouseLocation;
+  netTransportSend(&session->transport, &packet);
 }
 
-void renderButtons(void) {
-  float mul = camera.zoom * 2;
-  Font f = GetFontDefault();
-  float fontSize = 25 * mul;
-  float spacing = 2 * mul;
+void netplayAdvance(NetplaySession *session, PlayerInput input) {
+  World *previous = world;
+  world = session->world;
 
-  for (int i = 0; i < BUTTON_ACTION_COUNT; i++) {
-    if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) &&
-        CheckCollisionPointRec(mousePressLocation, mainMenuButtons[i].rect) &&
-        CheckCollisionPointRec(screenMouseLocation, mainMenuButtons[i].rect)) {
-      DrawRectangleRec(mainMenuButtons[i].rect,
-                       LIGHTGRAY);
+  netplayReceive(session);
+  netplayRollback(session);
+  netplayConfirm(session);
+
+  if (world->gameState == GAME_BOSS) {
+    if (session->frame - session->remoteFrame <= NETPLAY_ROLLBACK_MAX) {
+      /* NOTE: the local input goes through the wire format too, so that both peers replay the same one */
+      *netplayInput(session, session->local, session->frame) = decodeInput(encodeInput(input));
+      netplayPredict(session, session->frame);
+      netplaySave(session, session->frame);
+      netplaySimulateTick(session, session->frame);
+
+      session->frame += 1;
+      netplayConfirm(session);
     } else {
-      DrawRectangleRec(mainMenuButtons[i].rect,
-                       WHITE);
+      session->stalls += 1;
     }
+  }
 
-    if (CheckCollisionPointRec(screenMouseLocation, mainMenuButtons[i].rect)) {
-      DrawRectangleLinesEx(mainMenuButtons[i].rect,
-                           2 * mul,
-                           LIGHTGRAY);
-    }
+  netplaySend(session);
+  netTransportFlush(&session->transport);
 
-    char* text = "";
+  world = previous;
+}
 
-    switch (mainMenuButtons[i].action) {
-    case BUTTON_ACTION_START: text = "START"; break;
-    case BUTTON_ACTION_TOGGLE_CONTROLS: text = esdf ? "ESDF" : "WASD"; break;
-#ifdef PLATFORM_DESKTOP
-    case BUTTON_ACTION_QUIT: text = "QUIT"; break;
-#endif
-    default: continue;
-    };
+/* NOTE: the fight is only over once no late input can take its last tick back */
+bool netplayFinished(const NetplaySession *session) {
+  return session->world->gameState != GAME_BOSS &&
+    session->remoteFrame >= session->frame - 1;
+}
 
-    Vector2 size = MeasureTextEx(f, text, fontSize, spacing);
+void setupNetplayFight(void) {
+  seedRandom(NETPLAY_SEED);
 
-    Vector2 pos = (Vector2) {
-      .x = (float)mainMenuButtons[i].rect.x + mainMenuButtons[i].rect.width / 2,
-      .y = (float)mainMenuButtons[i].rect.y + mainMenuButtons[i].rect.height / 2,
-    };
+  world->playerPerks = 0;
+  memset(&world->playerStats, 0, sizeof(world->playerStats));
 
-    DrawTextPro(f,
-                text,
-                pos,
-                Vector2Scale(size, 0.5f),
-                0,
-                fontSize,
-                spacing,
-                BLACK);
-  }
-}
+  world->coop = true;
+  world->simulationClock = (SimulationClock) {
+    .tick = 1.0f / REFERENCE_FRAME_RATE,
+    .time = 0,
+    .scale = 1,
+  };
 
-void renderMainMenu(void) {
-  renderPhase0();
+  initAsteroids();
+  initPlayer();
+  initBossMarine();
+  initBossBall();
+  initProjectiles();
 
-  BeginDrawing(); {
-    ClearBackground(BLACK);
+  Vector2 destination = introductionPlayerDestination();
+
+  world->player.position = Vector2Add(destination, (Vector2) {-100, 0});
+  world->wingman = world->player;
+  world->wingman.position = Vector2Add(destination, (Vector2) {100, 0});
+
+  startBossFight();
+}
 
-    float width = (float)target.texture.width;
-    float height = (float)target.texture.height;
+bool openNetplaySession(NetplaySession *session, World *w, int local) {
+  *session = (NetplaySession) {
+    .world = w,
+    .local = local,
+    .remoteFrame = -1,
+    .remoteAck = -1,
+    .rollbackFrom = -1,
+    .checksumFrame = -1,
+    .snapshots = malloc(NETPLAY_SNAPSHOTS * sizeof(World)),
+  };
 
-    BeginMode2D(camera); {
-      DrawTexturePro(target.texture,
-                     (Rectangle) {0, 0, width, -height},
-                     (Rectangle) {0, 0, width, height},
-                     Vector2Zero(),
-                     0.0f,
-                     WHITE);
-    }; EndMode2D();
+  if (session->snapshots == NULL) {
+    return false;
+  }
 
-    renderFloatingShip();
-    renderGameTitle();
-    renderMusicAuthor();
-    renderGameVersion();
-    renderButtons();
-    renderMouseCursor();
-  } EndDrawing();
+  World *previous = world;
+  world = w;
+  setupNetplayFight();
+  world = previous;
+
+  return true;
 }
 
-void updateMainMenuMusic(void) {
-  bool pauseMusic = false;
+void closeNetplaySession(NetplaySession *session) {
+  LOG("NETPLAY: peer %d, %d ticks, %d rollbacks (%d ticks resimulated, at most %d at once, worst %.2fms), "
+      "%d stalls, %d/%d packets dropped, %s\n",
+      session->local,
+      session->frame,
+      session->rollbacks,
+      session->resimulatedTicks,
+      session->longestRollback,
+      session->worstRollbackTime * 1000.0,
+      session->stalls,
+      session->transport.dropped,
+      session->transport.sent,
+      session->desynced ? "DESYNCED" : "in sync");
 
-#ifdef PLATFORM_DESKTOP
+  closeNetTransport(&session->transport);
+  free(session->snapshots);
+  session->snapshots = NULL;
+}
 
-  if (!IsWindowFocused() || IsWindowHidden()) {
-    pauseMusic = true;
-  }
+bool startNetplay(NetTransportType type, int local, int port, int remotePort, int latency, int loss) {
+  NetplaySession *session = &netplay.session;
 
-#endif
+  if (!openNetplaySession(session, &gameWorld, local)) {
+    return false;
+  }
 
-  if (!IsCursorHidden()) {
-    pauseMusic = true;
+  if (!openNetTransport(&session->transport, type, port, remotePort, latency, loss)) {
+    fprintf(stderr, "NETPLAY: can't listen on port %d\n", port);
+    closeNetplaySession(session);
+    return false;
   }
 
-  if (pauseMusic) {
-    PauseMusicStream(mainMenuMusic);
-  } else {
-    ResumeMusicStream(mainMenuMusic);
+  if (type == NET_TRANSPORT_LOOPBACK) {
+    NetplaySession *peer = malloc(sizeof(NetplaySession));
+    World *peerWorld = calloc(1, sizeof(World));
 
-    if (!IsMusicStreamPlaying(mainMenuMusic)) {
-      PlayMusicStream(mainMenuMusic);
+    peerWorld->headless = true;
+    peerWorld->silent = true;
+
+    if (peer == NULL || peerWorld == NULL || !openNetplaySession(peer, peerWorld, 1 - local)) {
+      closeNetplaySession(session);
+      free(peer);
+      free(peerWorld);
+      return false;
     }
+
+    openNetTransport(&peer->transport, type, remotePort, port, latency, loss);
+
+    memset(netplay.loopbackWires, 0, sizeof(netplay.loopbackWires));
+    session->transport.inbox = &netplay.loopbackWires[local];
+    session->transport.peerInbox = &netplay.loopbackWires[1 - local];
+    peer->transport.inbox = &netplay.loopbackWires[1 - local];
+    peer->transport.peerInbox = &netplay.loopbackWires[local];
+
+    netplay.peer = peer;
   }
 
-  UpdateMusicStream(mainMenuMusic);
-}
+  localShip = local;
+  netplay.active = true;
 
-void updateAndRenderMainMenu(void) {
-  updateCamera();
-  updateMouse();
-  updateFloatingShip();
-  updateMainMenuMusic();
-  updateButtons();
+  LOG("NETPLAY: flying ship %d, %d ticks of latency, %d%% loss\n",
+      local, session->transport.latency, session->transport.loss);
 
-  renderMainMenu();
+  return true;
 }
 
-static float arenaLerp = 0;
-static Vector2 arenaLerpLocation = {0};
+void stopNetplay(void) {
+  closeNetplaySession(&netplay.session);
 
-static float bossInfoTimer = 0;
+  if (netplay.peer) {
+    World *peerWorld = netplay.peer->world;
 
-static float introductionSkipTimer = 0;
+    closeNetplaySession(netplay.peer);
+    free(peerWorld);
+    free(netplay.peer);
+    netplay.peer = NULL;
+  }
 
-void updateAndRenderIntroduction(void) {
-  switch (currentBoss) {
-  case BOSS_MARINE: {
-    UpdateMusicStream(bossMarineMusic);
-  } break;
-  case BOSS_BALL: {
-    UpdateMusicStream(bossBallMusic);
-  } break;
+  world->coop = false;
+  localShip = 0;
+  netplay.active = false;
+}
+
+PlayerInput shipAutopilotInput(int ship) {
+  if (ship == 0) {
+    return autopilotInput();
   }
 
-  introductionSkipTimer -= GetFrameTime();
+  swapShips();
+  PlayerInput input = autopilotInput();
+  swapShips();
 
-  Vector2 playerDestination = {
-    .x = (float)LEVEL_WIDTH / 2,
-    .y = LEVEL_HEIGHT - ((float)LEVEL_HEIGHT / 6),
-  };
+  return input;
+}
 
-  if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && introductionSkipTimer <= 0.0f) {
-    arenaLerp = 1.0f;
-    gameState = GAME_BOSS;
-    isGamePaused = false;
+void updateAndRenderNetplay(void) {
+  updateFightMusic();
 
-    player.position = playerDestination;
+  updateCamera();
+  updateThrusterTrails();
+  updateBackgroundAsteroid();
+  updateMouse();
 
-    switch (currentBoss) {
-    case BOSS_MARINE: {
-      bossMarine.attackTimer = 0.5f;
-      bossMarine.currentAttack = BOSS_MARINE_NOT_SHOOTING;
-    } break;
-    case BOSS_BALL: {
-    } break;
-    }
-  }
+  PlayerInput input = autopilot ? shipAutopilotInput(localShip) : readPlayerInput();
 
-  switch (introductionStage) {
-  case BOSS_INTRODUCTION_BEGINNING: {
-    cameraIntroductionTarget = (Vector2) {
-      .x = (float)LEVEL_WIDTH / 2,
-      .y = LEVEL_HEIGHT - (((float)LEVEL_HEIGHT / 6) / 2),
-    };
+  if (netplay.peer) {
+    World *previous = world;
+    world = netplay.peer->world;
+    PlayerInput peerInput = shipAutopilotInput(netplay.peer->local);
+    world = previous;
 
-    player.position = Vector2Lerp(player.position,
-                                  playerDestination,
-                                  0.05f);
+    netplayAdvance(netplay.peer, peerInput);
+  }
 
-    if (Vector2Distance(player.position, playerDestination) < 10.0f) {
-      introductionStage = BOSS_INTRODUCTION_FOCUS;
-      arenaLerpLocation = player.position;
-      arenaLerp = 0;
+  netplayAdvance(&netplay.session, input);
 
-      PlaySound(borderActivation);
-      switch (currentBoss) {
-      case BOSS_MARINE: PlayMusicStream(bossMarineMusic); break;
-      case BOSS_BALL: PlayMusicStream(bossBallMusic); break;
-      }
-    }
-  } break;
-  case BOSS_INTRODUCTION_FOCUS: {
-    Vector2 bossPos = Vector2Zero();
+  renderPhase1();
+  renderFinal();
 
-    switch (currentBoss) {
-    case BOSS_MARINE: bossPos = bossMarine.position; break;
-    case BOSS_BALL: bossPos = bossBall.position; break;
+  if (netplayFinished(&netplay.session)) {
+    if (world->gameState == GAME_PLAYER_DEAD) {
+      PauseMusicStream(bossMarineMusic);
+      PauseMusicStream(bossBallMusic);
     }
 
-    cameraIntroductionTarget = Vector2Lerp(cameraIntroductionTarget,
-                                           bossPos,
-                                           0.1f);
+    stopNetplay();
+  }
+}
 
-    arenaLerp = Clamp(arenaLerp + GetFrameTime(), 0.0f, 1.0f);
+static bool canvasSizeChanged = false;
 
-    if (Vector2Distance(cameraIntroductionTarget, bossPos) < 10.0f &&
-        arenaLerp == 1.0f) {
-      introductionStage = BOSS_INTRODUCTION_INFO;
-      bossInfoTimer = 2.0f;
+/* NOTE: logs whenever the high-water mark grows by a step, and when the number of allocations that didn't fit changes */
+#define FRAME_ARENA_REPORT_STEP (16 * 1024)
 
-      bossInfoHeadPosition = (Vector2) {
-          .x = -(GetScreenWidth() / 3),
-          .y = (GetScreenHeight() / 2),
-      };
-      infoXBase = -roundf(GetScreenWidth() / 3);
+void reportFrameArena(void) {
+  static size_t reported = 0;
+  static int reportedOverflows = 0;
+  size_t highWater = atomic_load(&frameArenaHighWater);
 
-      switch (currentBoss) {
-      case BOSS_MARINE: PlaySound(bossMarineShotgunSound); break;
-      case BOSS_BALL: PlaySound(bossMarineShotgunSound); break;
-      }
+  if (highWater >= reported + FRAME_ARENA_REPORT_STEP) {
+    LOG("FRAME ARENA: high-water mark %zu of %d bytes\n", highWater, FRAME_ARENA_SIZE);
+    reported = highWater;
+  }
+
+  if (frameArena.overflows != reportedOverflows) {
+    if (frameArena.overflows > 0) {
+      LOG("FRAME ARENA: %d allocations didn't fit last frame\n", frameArena.overflows);
     }
-  } break;
-  case BOSS_INTRODUCTION_INFO: {
-    bossInfoTimer -= GetFrameTime();
 
-    bossInfoHeadPosition =
-      Vector2Lerp(bossInfoHeadPosition,
-                  (Vector2) {
-                    .x = (GetScreenWidth() / 3),
-                    .y = (GetScreenHeight() / 2),
-                  },
-                  0.1f);
+    reportedOverflows = frameArena.overflows;
+  }
+}
 
-    infoXBase = Lerp(infoXBase, 0, 0.1f);
+void UpdateDrawFrame(void) {
+#if defined(_DEBUG)
+  reportFrameArena();
+  reportCulling();
+  reportDrawQueue();
+#endif
+  resetFrameArena();
+  updateDynamicResolution(GetFrameTime());
 
-    if (bossInfoTimer <= 0.0f) {
-      gameState = GAME_BOSS;
-      isGamePaused = false;
+  if (canvasSizeChanged) {
+#ifdef PLATFORM_WEB
+    double w = 0;
+    double h = 0;
 
-      switch (currentBoss) {
-      case BOSS_MARINE: {
-        bossMarine.attackTimer = 0.5f;
-        bossMarine.currentAttack = BOSS_MARINE_NOT_SHOOTING;
-      } break;
-      case BOSS_BALL: {
-      } break;
-      }
-    }
-  } break;
+    emscripten_get_element_css_size("#canvas", &w, &h);
+    SetWindowSize(w, h);
+    canvasSizeChanged = false;
+#endif
   }
 
-  arenaTopLeft = Vector2Lerp(arenaLerpLocation, Vector2Zero(),
-                             arenaLerp);
-  arenaBottomRight = Vector2Lerp(arenaLerpLocation, level,
-                                 arenaLerp);
-
-  updateCamera();
-
-  renderPhase1();
-  renderFinal();
-}
+  if (IsWindowResized()) {
+    adjustBossBallTargetScreen();
+  }
 
-void updateAndRenderTutorial(void) {
-  if (GetKeyPressed() != KEY_NULL ||
-      IsMouseButtonPressed(MOUSE_BUTTON_LEFT) ||
-      IsMouseButtonPressed(MOUSE_BUTTON_RIGHT) ||
-      seenTutorial) {
-    PlaySound(beep);
+#if defined(_DEBUG)
+  if (IsKeyPressed(KEY_F3)) {
+    /* NOTE: 1x -> 10x -> 100x -> 1000x -> 1x */
+    setTimeScale(world->simulationClock.scale >= TIME_SCALE_MAX ? 1 : world->simulationClock.scale * 10);
+  }
+#endif
 
-    seenTutorial = true;
-    introductionSkipTimer = 0.1f;
-    gameState = GAME_BOSS_INTRODUCTION;
-    introductionStage = BOSS_INTRODUCTION_BEGINNING;
-    lookingDirection = Vector2Zero();
+  /* NOTE: netplay keeps its own fixed tick, it can't be sped up or paused without the other peer */
+  if (netplay.active) {
+    updateAndRenderNetplay();
     return;
   }
 
-  updateMouse();
-
-  float mul = camera.zoom * 2;
-  Font f = GetFontDefault();
-  float fontSize = 25 * mul;
-  float spacing = 2 * mul;
+  advanceSimulationClock();
 
-  char *text[] = {
-    "W/A/S/D = MOVEMENT",
-    "LEFT MOUSE BUTTON = SHOOT",
-    "RIGHT MOUSE BUTTON = DASH",
-  };
+  if (autopilot) {
+    updateAutopilot();
+  }
 
-  if (esdf) {
-    text[0] = "E/S/D/F = MOVEMENT";
+  switch (world->gameState) {
+  case GAME_MAIN_MENU:
+    updateAndRenderMainMenu();
+    break;
+  case GAME_TUTORIAL: {
+    updateAndRenderTutorial();
+  } break;
+  case GAME_BOSS_INTRODUCTION:
+    updateAndRenderIntroduction();
+    break;
+  case GAME_BOSS:
+    updateAndRenderBossFight();
+    break;
+  case GAME_BOSS_DEAD: {
+    updateAndRenderBossDead();
+  } break;
+  case GAME_PLAYER_DEAD:
+    updateAndRenderPlayerDead();
+    break;
+  case GAME_STATS:
+    updateAndRenderStats();
+    break;
   }
+}
 
-  Vector2 pos = (Vector2) {
-    .x = (float)GetScreenWidth() / 2.0f,
-    .y = (float)GetScreenHeight() / 3.0f,
-  };
+#ifdef PLATFORM_WEB
+EM_BOOL canvasSizeChangedCallback(int type, const EmscriptenUiEvent *event, void *user_data) {
+  (void) type;
+  (void) event;
+  (void) user_data;
 
-  updateCamera();
-  BeginDrawing(); {
-    ClearBackground(BLACK);
+  canvasSizeChanged = true;
+  return 0;
+}
+#endif
 
-    for (size_t i = 0; i < sizeof(text) / sizeof(text[0]); i++) {
-      Vector2 size = MeasureTextEx(f, text[i], fontSize, spacing);
+#if !defined(PLATFORM_WEB)
 
-      DrawTextPro(f, text[i], pos, Vector2Scale(size, 0.5f), 0, fontSize, spacing, WHITE);
-      pos.y += size.y;
-    }
+#define CONTACT_BENCHMARK_PAIRS 4096
+#define CONTACT_BENCHMARK_ROUNDS 2000
 
-    char *text1 = "PRESS ANY KEY IF UNDERSTOOD";
-    Vector2 size = MeasureTextEx(f, text1, fontSize, spacing);
-    pos.y += size.y;
+/* NOTE: the push-out every collision routine used before circleContact */
+bool circleContactWithAngles(Vector2 a, float ra, Vector2 b, float rb, Vector2 *push) {
+  float distance = Vector2Distance(a, b);
+  float radiusSum = ra + rb;
 
-    DrawTextPro(f, text1, pos, Vector2Scale(size, 0.5f), 0, fontSize, spacing, WHITE);
+  if (distance >= radiusSum) {
+    return false;
+  }
 
-    renderMouseCursor();
-  } EndDrawing();
+  float angle = angleBetweenPoints(a, b) * DEG2RAD;
+  *push = Vector2Rotate((Vector2) {0, distance - radiusSum}, angle);
+  return true;
 }
 
-static Perk firstNewPerk;
-static Perk secondNewPerk;
+void benchmarkCircleContacts(void) {
+  static Vector2 positions[CONTACT_BENCHMARK_PAIRS][2];
+  static float radiuses[CONTACT_BENCHMARK_PAIRS][2];
 
-void playerGiveOneRandomPerk(void) {
-  Perk allPerks = 0;
-#define X(v, m, n, rx, ry, rw, rh) allPerks |= v;
-  X_PERKS
-#undef X
+  srand(69);
+  for (int i = 0; i < CONTACT_BENCHMARK_PAIRS; i++) {
+    for (int k = 0; k < 2; k++) {
+      positions[i][k] = (Vector2) {(float)(rand() % 64), (float)(rand() % 64)};
+      radiuses[i][k] = (float)(4 + (rand() % 24));
+    }
+  }
 
-  if (playerPerks == allPerks) {
-    return;
+  float maxError = 0;
+  for (int i = 0; i < CONTACT_BENCHMARK_PAIRS; i++) {
+    Vector2 oldPush = {0};
+    Vector2 newPush = {0};
+    bool oldHit = circleContactWithAngles(positions[i][0], radiuses[i][0], positions[i][1], radiuses[i][1], &oldPush);
+    bool newHit = circleContact(positions[i][0], radiuses[i][0], positions[i][1], radiuses[i][1], &newPush);
+
+    if (oldHit && newHit && !Vector2Equals(positions[i][0], positions[i][1])) {
+      maxError = MAX(maxError, Vector2Distance(oldPush, newPush));
+    }
   }
 
-#define X(v, m, n, rx, ry, rw, rh) v,
-  static Perk perks[] = {
-    X_PERKS
-  };
-#undef X
+  volatile float sink = 0;
+  double seconds[2] = {0};
 
-  int perks_len = sizeof(perks) / sizeof(perks[0]);
+  for (int method = 0; method < 2; method++) {
+    clock_t start = clock();
 
-  Perk newPerk = 0;
-  do {
-    int i = GetRandomValue(0, perks_len - 1);
-    newPerk = perks[i];
-  } while (playerPerks & newPerk);
+    for (int round = 0; round < CONTACT_BENCHMARK_ROUNDS; round++) {
+      for (int i = 0; i < CONTACT_BENCHMARK_PAIRS; i++) {
+        Vector2 push = {0};
+        bool hit = method == 0
+          ? circleContactWithAngles(positions[i][0], radiuses[i][0], positions[i][1], radiuses[i][1], &push)
+          : circleContact(positions[i][0], radiuses[i][0], positions[i][1], radiuses[i][1], &push);
 
-  playerPerks |= newPerk;
+        if (hit) {
+          sink += push.x + push.y;
+        }
+      }
+    }
 
-  if (firstNewPerk > 0) {
-    secondNewPerk = newPerk;
-  } else {
-    firstNewPerk = newPerk;
+    seconds[method] = (double)(clock() - start) / CLOCKS_PER_SEC;
   }
+
+  double contacts = (double)CONTACT_BENCHMARK_PAIRS * CONTACT_BENCHMARK_ROUNDS;
+  printf("circle contacts: %.0f per method\n", contacts);
+  printf("  angles:     %.2f ns/contact\n", (seconds[0] * 1e9) / contacts);
+  printf("  normalized: %.2f ns/contact\n", (seconds[1] * 1e9) / contacts);
+  printf("  max push difference: %f\n", maxError);
+  (void)sink;
 }
 
-void playerGiveTwoRandomPerks(void) {
-  firstNewPerk = 0;
-  secondNewPerk = 0;
+#define BATCH_FIGHT_TIME_LIMIT (10.0f * 60.0f)
+#define BATCH_FIGHTS_PER_JOB 16
 
-  playerGiveOneRandomPerk();
-  playerGiveOneRandomPerk();
-}
+typedef struct {
+  uint64_t seed;
+  BossType boss;
+  Perk perks;
 
-void updateDeadMarine(void) {
-  if (Vector2Distance(camera.target, bossMarine.position) > 5) {
-    return;
-  }
+  bool won;
+  float duration;
+  int damageDealt;
+  int healthLeft;
+} BatchFight;
 
-  const Vector2 headshotWeaponOffset = {
-    .x = -45 * SPRITES_SCALE,
-    .y = -19 * SPRITES_SCALE,
+typedef struct {
+  BatchFight *fights;
+  int perks;
+} Batch;
+
+void simulateBatchFight(BatchFight *fight, int perks) {
+  memset(world, 0, sizeof(*world));
+  world->headless = true;
+  world->silent = true;
+  world->simulationClock = (SimulationClock) {
+    .tick = 1.0f / REFERENCE_FRAME_RATE,
+    .time = 0,
+    .scale = 1,
   };
 
-  bossMarine.weaponOffset = Vector2Lerp(bossMarine.weaponOffset,
-                                        headshotWeaponOffset,
-                                        0.1f);
+  seedRandom(fight->seed);
 
-  bossMarine.weaponAngle = Lerp(bossMarine.weaponAngle, 0, 0.1f);
+  for (int p = 0; p < perks; p++) {
+    playerGiveOneRandomPerk();
+  }
 
-  if (Vector2Distance(bossMarine.weaponOffset, headshotWeaponOffset) < 0.5 &&
-      fabsf(bossMarine.weaponAngle) < 0.1f) {
-    PlaySound(bossMarineShotgunSound);
-    ResumeMusicStream(bossMarineMusic);
-    gameState = GAME_STATS;
+  world->currentBoss = fight->boss;
 
-    firstNewPerk = 0;
-    secondNewPerk = 0;
-    playerGiveTwoRandomPerks();
-  }
-}
+  initAsteroids();
+  initPlayer();
+  initBossMarine();
+  initBossBall();
+  initProjectiles();
 
-void updateDeadBall(void) {
-  if (deadBallTimer > 0.0f) {
-    return;
-  }
+  world->player.position = introductionPlayerDestination();
+  startBossFight();
 
-  PlaySound(bossBallDeath);
-  ResumeMusicStream(bossBallMusic);
-  gameState = GAME_STATS;
+  while (world->gameState == GAME_BOSS &&
+         world->player.health > 0 &&
+         world->simulationClock.time < BATCH_FIGHT_TIME_LIMIT) {
+    world->simulationClock.time += world->simulationClock.tick;
 
-  firstNewPerk = 0;
-  secondNewPerk = 0;
-  playerGiveTwoRandomPerks();
-}
+    world->playerInput = autopilotInput();
+    world->mouseCursor = world->playerInput.aim;
+    world->lookingDirection = Vector2Normalize(Vector2Subtract(world->mouseCursor, world->player.position));
 
-void updateDeadBoss(void) {
-  switch (currentBoss) {
+    simulateFight();
+  }
+
+  int bossHealth = 0;
+  int bossMaxHealth = 0;
+
+  switch (fight->boss) {
   case BOSS_MARINE: {
-    updateDeadMarine();
+    bossHealth = world->bossMarine.health;
+    bossMaxHealth = BOSS_MARINE_MAX_HEALTH;
   } break;
   case BOSS_BALL: {
-    deadBallTimer -= GetFrameTime();
-    updateDeadBall();
+    bossHealth = world->bossBall.health;
+    bossMaxHealth = BOSS_BALL_MAX_HEALTH;
   } break;
   }
-}
 
-static float deadPlayerTime = 2.0f;
-
-void updateDeadPlayer(void) {
-  if (deadPlayerTime <= 0.0f) {
-    ResumeMusicStream(bossMarineMusic);
-    gameState = GAME_STATS;
-  }
+  fight->perks = world->playerPerks;
+  fight->won = world->gameState == GAME_BOSS_DEAD;
+  fight->duration = (float)world->simulationClock.time;
+  fight->damageDealt = bossMaxHealth - MAX(bossHealth, 0);
+  fight->healthLeft = MAX(world->player.health, 0);
 }
 
-void updateAndRenderBossDead(void) {
-  blackBackgroundAlpha = Lerp(blackBackgroundAlpha,
-                              1.0f,
-                              0.2f);
-  blackBackgroundAlpha = Clamp(blackBackgroundAlpha,
-                               0, 1);
+void simulateBatchFightsJob(int first, int last, void *data) {
+  Batch *batch = data;
 
-  /* updateMouse(); */
-  updateCamera();
-  updateProjectiles();
-  updateDeadBoss();
+  World *own = malloc(sizeof(World));
+  world = own;
 
-  renderPhase1();
-  renderFinal();
+  for (int i = first; i < last; i++) {
+    simulateBatchFight(&batch->fights[i], batch->perks);
+  }
+
+  free(own);
 }
 
-void updateAndRenderPlayerDead(void) {
-  blackBackgroundAlpha = Lerp(blackBackgroundAlpha,
-                              1.0f,
-                              0.2f);
-  blackBackgroundAlpha = Clamp(blackBackgroundAlpha,
-                               0, 1);
+int runBatch(int count, uint64_t seed, int perks, const char *path) {
+  if (count <= 0) {
+    fprintf(stderr, "BATCH: nothing to simulate\n");
+    return 1;
+  }
 
-  deadPlayerTime -= GetFrameTime();
+  FILE *csv = fopen(path, "w");
 
-  /* updateMouse(); */
-  updateCamera();
-  updateProjectiles();
-  updateDeadPlayer();
+  if (csv == NULL) {
+    fprintf(stderr, "BATCH: can't open %s\n", path);
+    return 1;
+  }
 
-  renderPhase1();
-  renderFinal();
-}
+  Batch batch = {
+    .fights = calloc(count, sizeof(BatchFight)),
+    .perks = perks,
+  };
 
-Rectangle perkRect(Perk perk) {
-#define X(v, m, n, rx, ry, rw, rh) case v: return (Rectangle) {rx, ry, rw, rh};
+  for (int i = 0; i < count; i++) {
+    batch.fights[i].seed = seed + i;
+    batch.fights[i].boss = (i % 2) == 0 ? BOSS_MARINE : BOSS_BALL;
+  }
 
-  switch (perk) {
-    X_PERKS
-  };
+  initJobs();
 
-#undef X
+  clock_t start = clock();
+  int done = 0;
 
-  assert(false);
-}
+  /* NOTE: at most `JOBS_MAX` jobs fit into one run */
+  while (done < count) {
+    resetJobs();
 
-char *perkName(Perk perk) {
-#define X(v, m, n, rx, ry, rw, rh) case v: return n;
+    while (done < count && jobSystem.len < JOBS_MAX) {
+      int last = MIN(done + BATCH_FIGHTS_PER_JOB, count);
+      addJob(simulateBatchFightsJob, done, last, &batch);
+      done = last;
+    }
 
-  switch (perk) {
-    X_PERKS
-  };
+    runJobs();
+  }
 
-#undef X
+  closeJobs();
 
-  assert(false);
-}
+  fprintf(csv, "fight,seed,boss,perks,won,duration,damage_dealt,health_left\n");
 
-static bool pressedKeys[420] = {0};
+  int wins[2] = {0};
+  int fights[2] = {0};
+  double durations[2] = {0};
 
-void updateAndRenderStats(void) {
-  KeyboardKey key = KEY_NULL;
+  for (int i = 0; i < count; i++) {
+    BatchFight *f = &batch.fights[i];
 
-  if ((key = GetKeyPressed()) != KEY_NULL) {
-    pressedKeys[key] = true;
-  }
+    fprintf(csv, "%d,%llu,%s,%d,%d,%.2f,%d,%d\n",
+            i,
+            (unsigned long long)f->seed,
+            f->boss == BOSS_MARINE ? "marine" : "ball",
+            (int)f->perks,
+            f->won,
+            f->duration,
+            f->damageDealt,
+            f->healthLeft);
 
-  bool anyKeyReleased = false;
-  for (int i = 0; i < sizeof(pressedKeys) / sizeof(pressedKeys[0]); i++) {
-    if (pressedKeys[i] && IsKeyReleased(i)) {
-      anyKeyReleased = true;
-      memset(pressedKeys, 0, sizeof(pressedKeys));
-      break;
-    }
+    fights[f->boss] += 1;
+    wins[f->boss] += f->won;
+    durations[f->boss] += f->duration;
   }
 
-  if (anyKeyReleased ||
-      IsMouseButtonReleased(MOUSE_BUTTON_LEFT) ||
-      IsMouseButtonReleased(MOUSE_BUTTON_RIGHT)) {
-    PlaySound(beep);
-
-    if (player.health == 0) {
-      gameState = GAME_MAIN_MENU;
-      resetGame();
-      return;
-    }
+  fclose(csv);
 
-    switch (currentBoss) {
-    case BOSS_MARINE: {
-      introductionSkipTimer = 0.1f;
+  printf("BATCH: %d fights in %.2fs of CPU time\n", count, (double)(clock() - start) / CLOCKS_PER_SEC);
+  printf("  marine: %d/%d won, %.1fs per fight\n", wins[BOSS_MARINE], fights[BOSS_MARINE],
+         durations[BOSS_MARINE] / MAX(fights[BOSS_MARINE], 1));
+  printf("  ball:   %d/%d won, %.1fs per fight\n", wins[BOSS_BALL], fights[BOSS_BALL],
+         durations[BOSS_BALL] / MAX(fights[BOSS_BALL], 1));
 
-      gameState = GAME_BOSS_INTRODUCTION;
-      currentBoss = BOSS_BALL;
+  printf("  frame arena high-water mark: %zu of %d bytes\n", atomic_load(&frameArenaHighWater), FRAME_ARENA_SIZE);
 
-      introductionStage = BOSS_INTRODUCTION_BEGINNING;
+  free(batch.fights);
+  return 0;
+}
 
-      initPlayer();
-      playerStats.bossTime = 0.0f;
-    } break;
-    case BOSS_BALL: {
-      gameState = GAME_MAIN_MENU;
-      resetGame();
-    } break;
-    }
+#endif
 
-    return;
+bool numberArgument(int argc, char **argv, int *i, int *value) {
+  if (*i + 1 >= argc) {
+    return false;
   }
 
-  UpdateMusicStream(bossMarineMusic);
-  updateMouse();
+  char *end = NULL;
+  long number = strtol(argv[*i + 1], &end, 10);
 
-  float mul = camera.zoom * 2;
-  Font f = GetFontDefault();
-  float fontSize = 25 * mul;
-  float spacing = 2 * mul;
+  if (end == argv[*i + 1] || *end != '\0') {
+    return false;
+  }
 
-  BeginDrawing(); {
-    ClearBackground(BLACK);
+  *value = (int)number;
+  *i += 1;
+  return true;
+}
 
-    const char *boss_time_stat = TextFormat("BOSS TIME: %.2f", playerStats.bossTime);
-    Vector2 pos = {
-      .x = ((float)GetScreenWidth() / 2.0f),
-      .y = ((float)GetScreenHeight() / 5.0f),
-    };
-    Vector2 size = MeasureTextEx(f, boss_time_stat, fontSize, spacing);
+int main(int argc, char **argv) {
+  world = &gameWorld;
+  seedRandom((uint64_t)time(NULL));
 
-    pos.y -= size.y;
+  bool netplayRequested = false;
+  NetTransportType netplayType = NET_TRANSPORT_LOOPBACK;
+  int netplayShip = 0;
+  int netplayPort = 0;
+  int netplayRemotePort = 1;
+  int netplayLatency = 0;
+  int netplayLoss = 0;
 
-    DrawTextPro(f, boss_time_stat, pos, Vector2Scale(size, 0.5f), 0, fontSize, spacing, WHITE);
-    pos.y += size.y;
+#if !defined(PLATFORM_WEB)
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--benchmark-contacts") == 0) {
+      benchmarkCircleContacts();
+      return 0;
+    }
 
-    const char *time_stat = TextFormat("OVERALL TIME: %.2f", playerStats.time);
+    if (strcmp(argv[i], "--autopilot") == 0) {
+      autopilot = true;
+    }
 
-    size = MeasureTextEx(f, time_stat, fontSize, spacing);
+    if (strcmp(argv[i], "--direct-render") == 0) {
+      directRendering = true;
+    }
 
-    DrawTextPro(f, time_stat, pos, Vector2Scale(size, 0.5f), 0, fontSize, spacing, WHITE);
-    pos.y += size.y;
+    if (strcmp(argv[i], "--dynamic-resolution") == 0) {
+      dynamicResolution.enabled = true;
+    }
 
-    const char *kills_stat = TextFormat("KILLS: %d", playerStats.kills);
-    size = MeasureTextEx(f, kills_stat, fontSize, spacing);
+    /* NOTE: draws the boss ball from frames rendered at startup instead of in 3D every frame */
+    if (strcmp(argv[i], "--ball-impostor") == 0) {
+      bossBallImpostor = true;
+    }
 
-    DrawTextPro(f, kills_stat, pos, Vector2Scale(size, 0.5f), 0, fontSize, spacing, WHITE);
+    /* NOTE: --capacity <projectiles|particles|dash-trails> <count>, before --batch to apply to it */
+    if (strcmp(argv[i], "--capacity") == 0 && i + 1 < argc) {
+      const char *kind = argv[++i];
+      int capacity = 0;
 
-    if (currentBoss == BOSS_MARINE && player.health > 0) {
-      float x1 = (float)GetScreenWidth() / 4.0f;
-      float x2 = (float)GetScreenWidth() - x1;
+      if (numberArgument(argc, argv, &i, &capacity)) {
+        setEntityCapacity(kind, capacity);
+      } else {
+        LOG("CAPACITY: --capacity %s needs a count\n", kind);
+      }
 
-      float perkMul = mul * 3;
-      DrawTexturePro(sprites,
-                     perkRect(firstNewPerk),
-                     (Rectangle) {
-                       .x = x1,
-                       .y = (float)GetScreenHeight() / 2.0f,
-                       .width = perkRect(firstNewPerk).width * perkMul,
-                       .height = perkRect(firstNewPerk).height * perkMul,
-                     },
-                     (Vector2) {
-                       .x = perkRect(firstNewPerk).width * perkMul * 0.5f,
-                       .y = perkRect(firstNewPerk).height * perkMul * 0.5f,
-                     },
-                     0,
-                     WHITE);
+      continue;
+    }
 
-      DrawTexturePro(sprites,
-                     perkRect(secondNewPerk),
-                     (Rectangle) {
-                       .x = x2,
-                       .y = (float)GetScreenHeight() / 2.0f,
-                       .width = perkRect(firstNewPerk).width * perkMul,
-                       .height = perkRect(firstNewPerk).height * perkMul,
-                     },
-                     (Vector2) {
-                       .x = perkRect(firstNewPerk).width * perkMul * 0.5f,
-                       .y = perkRect(firstNewPerk).height * perkMul * 0.5f,
-                     },
-                     0,
-                     WHITE);
+    /* NOTE: --batch <fights> <out.csv> [seed] [perks] */
+    if (strcmp(argv[i], "--batch") == 0) {
+      int count = 0;
 
-      char *perk1 = perkName(firstNewPerk);
-      char *perk2 = perkName(secondNewPerk);
+      if (!numberArgument(argc, argv, &i, &count) || count < 1 || i + 1 >= argc) {
+        LOG("BATCH: --batch needs <fights, at least 1> <out.csv>\n");
+        return 1;
+      }
 
-      Vector2 pos1 = {x1, (float)GetScreenHeight() - ((float)GetScreenHeight() / 3.0f)};
-      Vector2 pos2 = {x2, (float)GetScreenHeight() - ((float)GetScreenHeight() / 3.0f)};
+      const char *path = argv[++i];
+      int seed = 1;
+      int perks = 2;
 
-      Vector2 size1 = MeasureTextEx(f, perk1, fontSize, spacing);
-      Vector2 size2 = MeasureTextEx(f, perk2, fontSize, spacing);
+      if (numberArgument(argc, argv, &i, &seed)) {
+        numberArgument(argc, argv, &i, &perks);
+      }
 
-      DrawTextPro(f, perk1, pos1, Vector2Scale(size1, 0.5f), 0, fontSize, spacing, WHITE);
-      DrawTextPro(f, perk2, pos2, Vector2Scale(size2, 0.5f), 0, fontSize, spacing, WHITE);
+      return runBatch(count, (uint64_t)seed, perks, path);
     }
 
-    const char *cont = "PRESS ANY KEY TO CONTINUE";
-    pos.y = (float)GetScreenHeight() - ((float)GetScreenHeight() / 6.0f);
+    if (strcmp(argv[i], "--time-scale") == 0) {
+      int scale = 1;
 
-    size = MeasureTextEx(f, cont, fontSize, spacing);
-    DrawTextPro(f, cont, pos, Vector2Scale(size, 0.5f), 0, fontSize, spacing, WHITE);
+      if (numberArgument(argc, argv, &i, &scale)) {
+        setTimeScale(scale);
+      } else {
+        LOG("TIME SCALE: --time-scale needs a number\n");
+      }
 
-    renderMouseCursor();
-  } EndDrawing();
-}
+      continue;
+    }
 
-static bool canvasSizeChanged = false;
+    /* NOTE: --netplay loopback [latency ms] [loss %] */
+    if (strcmp(argv[i], "--netplay") == 0 && i + 1 < argc && strcmp(argv[i + 1], "loopback") == 0) {
+      i += 1;
+      netplayType = NET_TRANSPORT_LOOPBACK;
+      netplayLatency = 0;
+      netplayLoss = 0;
 
-void UpdateDrawFrame(void) {
-  if (canvasSizeChanged) {
-#ifdef PLATFORM_WEB
-    double w = 0;
-    double h = 0;
+      if (numberArgument(argc, argv, &i, &netplayLatency)) {
+        numberArgument(argc, argv, &i, &netplayLoss);
+      }
 
-    emscripten_get_element_css_size("#canvas", &w, &h);
-    SetWindowSize(w, h);
-    canvasSizeChanged = false;
-#endif
-  }
+      netplayRequested = true;
+      continue;
+    }
 
-  if (IsWindowResized()) {
-    adjustBossBallTargetScreen();
-  }
+    /* NOTE: --netplay udp <ship 0|1> <port> <remote port> [latency ms] [loss %] */
+    if (strcmp(argv[i], "--netplay") == 0 && i + 1 < argc && strcmp(argv[i + 1], "udp") == 0) {
+      i += 1;
+      netplayType = NET_TRANSPORT_UDP;
+      netplayLatency = 0;
+      netplayLoss = 0;
+
+      if (!numberArgument(argc, argv, &i, &netplayShip) ||
+          !numberArgument(argc, argv, &i, &netplayPort) ||
+          !numberArgument(argc, argv, &i, &netplayRemotePort)) {
+        LOG("NETPLAY: --netplay udp needs <ship 0|1> <port> <remote port>\n");
+        continue;
+      }
 
-  switch (gameState) {
-  case GAME_MAIN_MENU:
-    updateAndRenderMainMenu();
-    break;
-  case GAME_TUTORIAL: {
-    updateAndRenderTutorial();
-  } break;
-  case GAME_BOSS_INTRODUCTION:
-    updateAndRenderIntroduction();
-    break;
-  case GAME_BOSS:
-    updateAndRenderBossFight();
-    playerStats.time += GetFrameTime();
-    playerStats.bossTime += GetFrameTime();
-    break;
-  case GAME_BOSS_DEAD: {
-    updateAndRenderBossDead();
-  } break;
-  case GAME_PLAYER_DEAD:
-    updateAndRenderPlayerDead();
-    break;
-  case GAME_STATS:
-    updateAndRenderStats();
-    break;
-  }
-}
+      netplayShip = netplayShip != 0;
 
-#ifdef PLATFORM_WEB
-EM_BOOL canvasSizeChangedCallback(int type, const EmscriptenUiEvent *event, void *user_data) {
-  (void) type;
-  (void) event;
-  (void) user_data;
+      if (numberArgument(argc, argv, &i, &netplayLatency)) {
+        numberArgument(argc, argv, &i, &netplayLoss);
+      }
 
-  canvasSizeChanged = true;
-  return 0;
-}
+      netplayRequested = true;
+      continue;
+    }
+  }
 #endif
 
-int main(void) {
   initRaylib();
+  initJobs();
   initMouse();
   initPlayer();
   initCamera();
@@ -5577,19 +9720,25 @@ int main(void) {
   initBackgroundAsteroid();
   initMusic();
 
-  memset(&playerStats, 0, sizeof(playerStats));
-  playerPerks = 0;
+  memset(&world->playerStats, 0, sizeof(world->playerStats));
+  world->playerPerks = 0;
 
-  memset(particles, 0, sizeof(particles));
+  memset(&world->particles, 0, sizeof(world->particles));
 
   initBossBallResources();
 
   initBossMarine();
   initBossBall();
 
-  currentBoss = BOSS_MARINE;
+  world->currentBoss = BOSS_MARINE;
   seenTutorial = false;
 
+  if (netplayRequested &&
+      !startNetplay(netplayType, netplayShip, netplayPort, netplayRemotePort, netplayLatency, netplayLoss)) {
+    CloseWindow();
+    return 1;
+  }
+
 #if defined(PLATFORM_WEB)
   emscripten_set_resize_callback(EMSCRIPTEN_EVENT_TARGET_WINDOW, 0, 0, canvasSizeChangedCallback);
   emscripten_set_main_loop(UpdateDrawFrame, 60, 1);
@@ -5601,6 +9750,8 @@ int main(void) {
   }
 #endif
 
+  closeJobs();
+
   UnloadRenderTexture(target);
   CloseWindow();
 